@@ -0,0 +1,17 @@
+# Headless command-line runner (no Qt)
+include(../common.pri)
+include(../core/pumpcore.pri)
+
+TEMPLATE = app
+CONFIG  += console
+CONFIG  -= qt app_bundle
+TARGET   = pumpcli
+
+# Source files
+SOURCES += \
+    main.cpp \
+    ../src/PumpTester.cpp
+
+# Header files
+HEADERS += \
+    ../include/PumpTester.h
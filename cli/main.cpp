@@ -0,0 +1,324 @@
+/*
+pumpcli
+    - Purpose: Headless entry point for the simulation core; starts without loading Qt.
+    - Usage:
+        pumpcli [--minutes N] [--profile-store FILE] [--trace FILE] [--quiet]
+        pumpcli --scenario PATH [--scenario PATH ...] [--jobs N] [--summary FILE.csv]
+        pumpcli --sweep FILE.scn --vary icr=5:20:7 [--vary cf=1:4:4 ...] [--lhs N] [--seeds N]
+                [--jobs N] [--summary FILE.csv]
+        pumpcli --selftest
+    - Design Notes:
+        + Runs the simulator in CLI time mode for N simulated minutes (default one day) with the
+          active profile from the store, or a built-in default profile when there is none.
+        + --quiet discards per-tick logging and prints only the end-of-run summary.
+        + --scenario runs scenario files (a directory means every *.scn file in it) on N threads
+          (default: all cores) with logging discarded, then prints or writes a CSV summary.
+        + --sweep varies profile settings (icr, cf, target, basal scale) for one scenario over a
+          grid (min:max:steps per axis) or, with --lhs N, a Latin hypercube of N points, running
+          every point with the same --seeds CGM seeds (default 16).
+        + --selftest runs the PumpTester backend harness; the exit status is non-zero if any
+          check fails.
+*/
+
+#include "PumpSimulator.h"
+#include "PumpTester.h"
+#include "ProfileManager.h"
+#include "ProfileStore.h"
+#include "Profile.h"
+#include "BasalSegment.h"
+#include "BolusCalculator.h"
+#include "InsulinDeliveryManager.h"
+#include "Battery.h"
+#include "Cartridge.h"
+#include "CGMSensorInterface.h"
+#include "ControlIQController.h"
+#include "AlertManager.h"
+#include "TraceRecorder.h"
+#include "Scenario.h"
+#include "ScenarioRunner.h"
+#include "ParameterSweep.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+// Value following a "--flag" argument, or nullptr if absent
+const char* argValue(int argc, char* argv[], const char* flag) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], flag) == 0)
+            return argv[i + 1];
+    }
+    return nullptr;
+}
+
+bool hasFlag(int argc, char* argv[], const char* flag) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], flag) == 0)
+            return true;
+    }
+    return false;
+}
+
+// Swallows everything written to it; keeps std::cout in a good state while discarding output
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return traits_type::not_eof(c); }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+std::vector<std::string> argValues(int argc, char* argv[], const char* flag) {
+    std::vector<std::string> values;
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], flag) == 0)
+            values.push_back(argv[++i]);
+    }
+    return values;
+}
+
+// Loads every --scenario path (files, or directories of *.scn files in name order)
+bool loadScenarios(const std::vector<std::string>& paths, std::vector<Scenario>& scenarios) {
+    std::vector<std::string> files;
+    for (const std::string& path : paths) {
+        std::error_code ec;
+        if (std::filesystem::is_directory(path, ec)) {
+            std::vector<std::string> found;
+            for (const auto& entry : std::filesystem::directory_iterator(path, ec)) {
+                if (entry.path().extension() == ".scn")
+                    found.push_back(entry.path().string());
+            }
+            std::sort(found.begin(), found.end());
+            files.insert(files.end(), found.begin(), found.end());
+        } else {
+            files.push_back(path);
+        }
+    }
+
+    for (const std::string& file : files) {
+        Scenario scenario;
+        std::string error;
+        if (!Scenario::loadFile(file, scenario, &error)) {
+            std::cerr << "[pumpcli] " << error << "\n";
+            return false;
+        }
+        scenarios.push_back(scenario);
+    }
+    return true;
+}
+
+int runScenarios(int argc, char* argv[]) {
+    std::vector<Scenario> scenarios;
+    if (!loadScenarios(argValues(argc, argv, "--scenario"), scenarios))
+        return 1;
+
+    const char* jobsArg = argValue(argc, argv, "--jobs");
+    const char* summaryArg = argValue(argc, argv, "--summary");
+    int jobs = jobsArg ? std::atoi(jobsArg) : static_cast<int>(std::thread::hardware_concurrency());
+
+    NullBuffer discard;
+    std::streambuf* coutBuffer = std::cout.rdbuf(&discard);
+    auto started = std::chrono::steady_clock::now();
+    std::vector<ScenarioResult> results = ScenarioRunner::runAll(scenarios, jobs);
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    std::cout.rdbuf(coutBuffer);
+
+    if (summaryArg) {
+        std::ofstream csv(summaryArg);
+        if (!csv) {
+            std::cerr << "[pumpcli] Cannot write " << summaryArg << "\n";
+            return 1;
+        }
+        ScenarioRunner::writeSummaryCsv(csv, results);
+    } else {
+        ScenarioRunner::writeSummaryCsv(std::cout, results);
+    }
+
+    std::cerr << "[pumpcli] Ran " << results.size() << " scenario(s) in " << elapsed << " ms ("
+              << (elapsed > 0.0 ? results.size() * 1000.0 / elapsed : 0.0) << " per second).\n";
+    return 0;
+}
+
+int runSweep(int argc, char* argv[]) {
+    SweepConfig config;
+    std::string error;
+    if (!Scenario::loadFile(argValue(argc, argv, "--sweep"), config.base, &error)) {
+        std::cerr << "[pumpcli] " << error << "\n";
+        return 1;
+    }
+    for (const std::string& spec : argValues(argc, argv, "--vary")) {
+        SweepAxis axis;
+        if (!SweepAxis::parse(spec, axis)) {
+            std::cerr << "[pumpcli] Bad --vary '" << spec << "' (expected icr|cf|target|basal=min:max[:steps], 0 < min <= max, steps 1-1000)\n";
+            return 1;
+        }
+        config.axes.push_back(axis);
+    }
+
+    const char* lhsArg = argValue(argc, argv, "--lhs");
+    const char* seedsArg = argValue(argc, argv, "--seeds");
+    const char* jobsArg = argValue(argc, argv, "--jobs");
+    const char* summaryArg = argValue(argc, argv, "--summary");
+    if (lhsArg) {
+        config.latinHypercube = true;
+        config.samples = std::atoi(lhsArg);
+    }
+    if (seedsArg)
+        config.seedsPerPoint = std::atoi(seedsArg);
+    config.jobs = jobsArg ? std::atoi(jobsArg) : static_cast<int>(std::thread::hardware_concurrency());
+
+    NullBuffer discard;
+    std::streambuf* coutBuffer = std::cout.rdbuf(&discard);
+    auto started = std::chrono::steady_clock::now();
+    std::vector<SweepPointResult> results = ParameterSweep::run(config);
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    std::cout.rdbuf(coutBuffer);
+
+    if (summaryArg) {
+        std::ofstream csv(summaryArg);
+        if (!csv) {
+            std::cerr << "[pumpcli] Cannot write " << summaryArg << "\n";
+            return 1;
+        }
+        ParameterSweep::writeCsv(csv, results);
+    } else {
+        ParameterSweep::writeCsv(std::cout, results);
+    }
+
+    std::cerr << "[pumpcli] Swept " << results.size() << " point(s) x " << std::max(1, config.seedsPerPoint)
+              << " seed(s) in " << elapsed << " ms.\n";
+    return 0;
+}
+
+Profile* makeDefaultProfile() {
+    Profile* profile = new Profile();
+    profile->setName("Default");
+    profile->setInsulinToCarbRatio(10.0);    // 1U per 10g carbs
+    profile->setCorrectionFactor(2.0);       // 1U drops BG by 2 mmol/L
+    profile->setTargetBG(6.0);
+    profile->addBasalSegment(new BasalSegment(0.0, 24.0, 0.8));
+    return profile;
+}
+}
+
+int main(int argc, char* argv[]) {
+    if (hasFlag(argc, argv, "--selftest")) {
+        PumpTester tester;
+        return tester.runAllTests() ? 0 : 1;
+    }
+
+    if (argValue(argc, argv, "--scenario"))
+        return runScenarios(argc, argv);
+    if (argValue(argc, argv, "--sweep"))
+        return runSweep(argc, argv);
+
+    const char* minutesArg = argValue(argc, argv, "--minutes");
+    const char* storeArg = argValue(argc, argv, "--profile-store");
+    const char* traceArg = argValue(argc, argv, "--trace");
+    const bool quiet = hasFlag(argc, argv, "--quiet");
+    const int minutes = minutesArg ? std::atoi(minutesArg) : 24 * 60;
+
+    // Create components
+    PumpSimulator* pumpSimulator = new PumpSimulator();
+    ProfileManager* profileManager = new ProfileManager();
+    BolusCalculator* bolusCalc = new BolusCalculator();
+    InsulinDeliveryManager* deliveryMgr = new InsulinDeliveryManager();
+    Battery* battery = new Battery();
+    Cartridge* cartridge = new Cartridge();
+    CGMSensorInterface* cgm = new CGMSensorInterface();
+    ControlIQController* controlIQ = new ControlIQController();
+    AlertManager* alerts = new AlertManager();
+    ProfileStore* profileStore = nullptr;
+
+    if (storeArg) {
+        profileStore = new ProfileStore();
+        if (profileStore->open(storeArg))
+            profileManager->setProfileStore(profileStore);
+    }
+    if (!profileManager->getActiveProfile()) {
+        profileManager->createProfile(makeDefaultProfile());
+        profileManager->setActiveProfile("Default");
+    }
+
+    // Wire components
+    deliveryMgr->setBattery(battery);
+    deliveryMgr->setCartridge(cartridge);
+    controlIQ->setCGMSensor(cgm);
+    controlIQ->setInsulinDeliveryManager(deliveryMgr);
+
+    pumpSimulator->setProfileManager(profileManager);
+    pumpSimulator->setBolusCalculator(bolusCalc);
+    pumpSimulator->setInsulinDeliveryManager(deliveryMgr);
+    pumpSimulator->setBattery(battery);
+    pumpSimulator->setCartridge(cartridge);
+    pumpSimulator->setCGMSensorInterface(cgm);
+    pumpSimulator->setControlIQController(controlIQ);
+    pumpSimulator->setAlertManager(alerts);
+    pumpSimulator->setCLIMode(true);
+
+    TraceRecorder* traceRecorder = nullptr;
+    if (traceArg) {
+        traceRecorder = new TraceRecorder();
+        traceRecorder->setThreadName("Simulation");
+        traceRecorder->setEnabled(true);
+        pumpSimulator->setTraceRecorder(traceRecorder);
+    }
+
+    // Run
+    NullBuffer discard;
+    std::streambuf* coutBuffer = std::cout.rdbuf();
+    if (quiet)
+        std::cout.rdbuf(&discard);   // Discard per-tick logging
+
+    auto started = std::chrono::steady_clock::now();
+    pumpSimulator->startSimulation();
+    double basalRate = profileManager->getActiveProfile()->getBasalRateForTime(0);
+    if (basalRate > 0.0)
+        deliveryMgr->startBasalDelivery(basalRate);
+    for (int i = 0; i < minutes; ++i)
+        pumpSimulator->updateSimulationState();
+    pumpSimulator->stopSimulation();
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+
+    std::cout.rdbuf(coutBuffer);
+
+    // Summary
+    std::cout << "[pumpcli] Simulated " << minutes << " min in " << elapsed << " ms\n"
+              << "  Final BG:   " << pumpSimulator->getCurrentBG() << " mmol/L\n"
+              << "  Trend:      " << cgm->getTrend().getSlope() << " mmol/L/min ("
+              << CGMTrend::arrowName(cgm->getTrend().getArrow()) << ")\n"
+              << "  IOB:        " << pumpSimulator->getIOB() << " U\n"
+              << "  ControlIQ:  " << pumpSimulator->getControllerRunCount() << " runs (CGM every "
+              << cgm->getCadenceMinutes() << " min)\n"
+              << "  Battery:    " << battery->getLevel() << "%\n"
+              << "  Cartridge:  " << cartridge->getCurrentVolume() << " U\n"
+              << "  Alerts:     " << alerts->getRaisedCount() << " announced, " << alerts->getSuppressedCount()
+              << " suppressed, " << alerts->getHistory().getTotalRecorded() << " history entries\n";
+
+    if (traceRecorder) {
+        traceRecorder->setEnabled(false);
+        traceRecorder->writeChromeTrace(traceArg);
+        pumpSimulator->setTraceRecorder(nullptr);
+        delete traceRecorder;
+    }
+
+    pumpSimulator->setAlertManager(nullptr);   // Detach from the scheduler before it goes
+    delete pumpSimulator;
+    delete profileManager;
+    delete profileStore;
+    delete bolusCalc;
+    delete deliveryMgr;
+    delete battery;
+    delete cartridge;
+    delete cgm;
+    delete controlIQ;
+    delete alerts;
+
+    return 0;
+}
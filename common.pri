@@ -0,0 +1,7 @@
+# Settings shared by every subproject
+CONFIG += c++17 thread
+
+INCLUDEPATH += $$PWD/include
+
+# Per-subsystem tick latency histograms: qmake CONFIG+=tick_profiling
+CONFIG(tick_profiling): DEFINES += PUMP_ENABLE_TICK_PROFILING
@@ -0,0 +1,85 @@
+# Simulation core: everything except the Qt GUI, built without Qt
+include(../common.pri)
+
+TEMPLATE = lib
+CONFIG  += staticlib
+CONFIG  -= qt
+TARGET   = pumpcore
+
+# Source files
+SOURCES += \
+    ../src/PumpSimulator.cpp \
+    ../src/SimulationWorker.cpp \
+    ../src/TickProfiler.cpp \
+    ../src/TraceRecorder.cpp \
+    ../src/DataLogger.cpp \
+    ../src/DoseLedger.cpp \
+    ../src/FaultInjector.cpp \
+    ../src/GlycemicMetrics.cpp \
+    ../src/Alarm.cpp \
+    ../src/ControlIQController.cpp \
+    ../src/AlertManager.cpp \
+    ../src/AlertRuleTable.cpp \
+    ../src/AlertHistory.cpp \
+    ../src/SimScheduler.cpp \
+    ../src/BasalSegment.cpp \
+    ../src/BGHistory.cpp \
+    ../src/Profile.cpp \
+    ../src/ProfileSnapshot.cpp \
+    ../src/ProfileManager.cpp \
+    ../src/ProfileStore.cpp \
+    ../src/ParameterSweep.cpp \
+    ../src/Scenario.cpp \
+    ../src/ScenarioRunner.cpp \
+    ../src/CGMSensorInterface.cpp \
+    ../src/CGMTrend.cpp \
+    ../src/ProfileCRUDController.cpp \
+    ../src/BolusCalculator.cpp \
+    ../src/InsulinDeliveryManager.cpp \
+    ../src/BolusManager.cpp \
+    ../src/BolusRequest.cpp \
+    ../src/Cartridge.cpp \
+    ../src/Battery.cpp
+
+# Header files
+HEADERS += \
+    ../include/Alarm.h \
+    ../include/AlertManager.h \
+    ../include/AlertRuleTable.h \
+    ../include/AlertSettings.h \
+    ../include/AlertHistory.h \
+    ../include/SimScheduler.h \
+    ../include/DataLogger.h \
+    ../include/DoseLedger.h \
+    ../include/FaultInjector.h \
+    ../include/GlycemicMetrics.h \
+    ../include/PumpSimulator.h \
+    ../include/SimulationSnapshot.h \
+    ../include/SimulationWorker.h \
+    ../include/SpscRing.h \
+    ../include/FixedRing.h \
+    ../include/TickProfiler.h \
+    ../include/TraceRecorder.h \
+    ../include/TripleBuffer.h \
+    ../include/BasalSegment.h \
+    ../include/BGHistory.h \
+    ../include/Profile.h \
+    ../include/ProfileSnapshot.h \
+    ../include/ControlIQController.h \
+    ../include/ProfileManager.h \
+    ../include/ProfileStore.h \
+    ../include/ParameterSweep.h \
+    ../include/Scenario.h \
+    ../include/ScenarioRunner.h \
+    ../include/ProfileCRUDController.h \
+    ../include/BolusCalculator.h \
+    ../include/InsulinDeliveryManager.h \
+    ../include/InsulinUnits.h \
+    ../include/CGMSensorInterface.h \
+    ../include/CGMTrend.h \
+    ../include/BolusManager.h \
+    ../include/BolusRequest.h \
+    ../include/EventBus.h \
+    ../include/PumpEvents.h \
+    ../include/Cartridge.h \
+    ../include/Battery.h
@@ -0,0 +1,3 @@
+# Link against the simulation core library (include from gui/cli project files)
+LIBS += -L$$OUT_PWD/../core -lpumpcore
+PRE_TARGETDEPS += $$OUT_PWD/../core/libpumpcore.a
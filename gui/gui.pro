@@ -0,0 +1,19 @@
+# Qt widgets front end
+include(../common.pri)
+include(../core/pumpcore.pri)
+
+QT      += core gui widgets charts
+TEMPLATE = app
+TARGET   = InsulinSimulator
+
+# Source files
+SOURCES += \
+    ../src/main.cpp \
+    ../src/MergedMainWindow.cpp
+
+# Header files
+HEADERS += \
+    ../include/MergedMainWindow.h
+
+# Include paths
+INCLUDEPATH += ../ui
@@ -0,0 +1,59 @@
+/*
+AlertHistory
+    - Purpose: Bounded record of what happened to alarms (raised, escalated, acknowledged, ...).
+    - Spec Refs:
+        + View Pump Info & History – Alert history for review.
+        + Handle Pump Malfunction – Shows when an alarm was raised and how it was dealt with.
+    - Design Notes:
+        + Records live in a FixedRing held inline; the oldest record is overwritten when full, so a
+          long run with a flapping alarm uses constant memory.
+        + Records hold fixed-size copies of the alarm id, severity and message rather than
+          pointers, so they stay valid after the alarm itself is reused or deleted.
+        + Re-raises suppressed by a deduplication window are not recorded; AlertManager counts them.
+    - Class Overview:
+        + record(minute, action, id, severity, message) – Appends one entry.
+        + size() / at(i) / latest() – Retained entries, oldest first.
+        + getTotalRecorded() – Entries ever appended, including overwritten ones.
+        + actionName(action) – Display name.
+*/
+
+#ifndef ALERTHISTORY_H
+#define ALERTHISTORY_H
+
+#include "FixedRing.h"
+#include <cstddef>
+#include <cstdint>
+
+enum class AlertAction : std::uint8_t { Raised, Escalated, Reminded, Snoozed, Acknowledged, Resolved };
+
+struct AlertRecord {
+    int minute = 0;                 // Simulated minute
+    AlertAction action = AlertAction::Raised;
+    char alarmId[24] = {};
+    char severity[12] = {};
+    char message[96] = {};
+};
+
+class AlertHistory {
+public:
+    static const std::size_t kCapacity = 256;   // Power of two
+
+    AlertHistory();
+
+    void record(int minute, AlertAction action, const char* alarmId, const char* severity, const char* message);
+    void clear() { records.clear(); }
+
+    std::size_t size() const { return records.size(); }
+    bool empty() const { return records.empty(); }
+    std::uint64_t getTotalRecorded() const { return records.getTotalWritten(); }
+
+    const AlertRecord& at(std::size_t index) const { return records.at(index); }   // 0 = oldest retained entry
+    const AlertRecord& latest() const { return records.latest(); }                 // Requires !empty()
+
+    static const char* actionName(AlertAction action);
+
+private:
+    FixedRing<AlertRecord, kCapacity> records;
+};
+
+#endif // ALERTHISTORY_H
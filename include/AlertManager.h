@@ -3,34 +3,116 @@ AlertManager
     - Purpose: Monitors hardware states and raises alerts using Alarm objects.
     - Spec Refs:
         + Handle Pump Malfunction – Triggers and manages alerts for low battery, cartridge issues, etc.
-        + View Pump Info & History – Supplies active alarm info for review or display.
+        + View Pump Info & History – Supplies active alarm info and a bounded alert history.
     - Design Notes:
-        + Avoids duplicate alarms.
-        + Can be extended with custom thresholds (via Profile).
+        + Avoids duplicate alarms: one Alarm per alarm id, reused each time that id is raised again,
+          found through an id index rather than a search. Memory stays flat however often an alarm
+          flaps.
+        + Threshold alerts come from an AlertRuleTable compiled from the active ProfileSnapshot's
+          AlertSettings (recompiled when a new snapshot arrives). Rules raise on crossing and
+          clear with hysteresis; a cleared rule resolves its alarm so it can be raised again.
+          The last value of each signal is kept, so a recompile re-evaluates it at once: a new
+          threshold takes effect without waiting for the next change, and an alarm whose rule
+          now clears (or was turned off) is resolved.
+        + Each alarm has an AlertPolicy. A re-raise inside the deduplication window reactivates the
+          alarm silently (counted in getSuppressedCount()) instead of being announced again. An
+          alarm left unacknowledged for the escalation delay goes up one severity level and is
+          announced again. snoozeAlarm() holds off escalation and re-announces when it runs out.
+        + Timed behaviour (escalation, snooze, CGM silence, dedup windows) runs on the simulator's
+          SimScheduler, attached with setScheduler(); without one those features are off.
+          The destructor cancels this manager's timers, so the scheduler must still be alive then:
+          destroy the manager before its PumpSimulator, or detach it first with setScheduler(nullptr).
+        + Every announcement, escalation, snooze, acknowledgement and resolution is appended to an
+          AlertHistory ring; suppressed re-raises are not.
         + Prepares for future GUI integration and DataLogger connectivity.
+        + Does not show UI itself (it runs on the simulation thread); the GUI watches
+          getRaisedCount(), displays the last raised message and can snooze that alarm by id.
+        + subscribeTo(bus) makes it react to battery, cartridge, BG, occlusion and CGM signal
+          events, so each rule is evaluated only when its input changes. The rate of change is
+          the sensor's CGMTrend slope carried by the reading; CGM silence is a scheduler deadline
+          set when the signal is lost. The check*() methods evaluate the same rules on demand.
+        + subscribeTo() returns false, and leaves no partial subscription, if any channel is full.
     - Class Overview:
-        + checkBattery() – Checks battery and raises "BAT_LOW" if < 20%.
-        + checkCartridge() – Checks cartridge volume and raises "CARTRIDGE_EMPTY" if < 1.0U.
-        + raiseAlarm() – Adds new active alarm if not already present.
+        + checkBattery() – Checks battery against the BAT_LOW rule.
+        + checkCartridge() – Checks cartridge volume against the CARTRIDGE_EMPTY rule.
+        + checkOcclusion() – Raises "OCCLUSION" once the delivery manager has detected a blocked line.
+        + checkCGM() – Raises "CGM_SIGNAL_LOSS" while no sensor reading is available.
+        + onEvent(...) / subscribeTo(bus) – Event-driven versions of the checks above.
+        + onTimer(tag) – Scheduler callback.
+        + raiseAlarm() – Activates the alarm unless it is already active.
         + clearAlarm() – Acknowledges alarm by ID.
+        + snoozeAlarm() – Defers escalation of an active alarm and reminds when the snooze ends.
+        + findAlarm() / getHistory() – Lookup by ID and the alert history.
         + update() – Outputs current alarm statuses.
 */
 
 #ifndef ALERTMANAGER_H
 #define ALERTMANAGER_H
 
+#include "AlertHistory.h"
+#include "AlertRuleTable.h"
+#include "SimScheduler.h"
+#include <array>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 class Alarm;
-class Profile;
+class ProfileSnapshot;
 class Battery;
 class Cartridge;
+class InsulinDeliveryManager;
+class CGMSensorInterface;
+class PumpEventBus;
+struct BatteryLevelEvent;
+struct CartridgeVolumeEvent;
+struct OcclusionEvent;
+struct CGMSignalEvent;
+struct BGReadingEvent;
 
 class AlertManager {
 private:
-    std::vector<Alarm*> activeAlarms;
-    Profile* profile;
+    struct AlarmEntry {
+        Alarm* alarm;                               // Latest occurrence (owned)
+        AlertPolicy policy;
+        int lastAnnounced;                          // Minute of the last announced raise
+        SimScheduler::TimerId escalationTimer;
+        SimScheduler::TimerId snoozeTimer;
+    };
+
+    // Timer tags: kSilenceTimerTag, or entry index * kAlarmTimerKinds + AlarmTimer
+    enum AlarmTimer { EscalationTimer, SnoozeTimer, kAlarmTimerKinds };
+    static constexpr int kSilenceTimerTag = -1;
+
+    std::vector<AlarmEntry> alarms;                             // One per alarm id, never removed
+    std::unordered_map<std::string, std::size_t> alarmIndex;    // Alarm id -> position in alarms
+    AlertHistory history;
+    std::shared_ptr<const ProfileSnapshot> profile;
+    unsigned long long raisedCount;
+    unsigned long long suppressedCount;
+    std::string lastRaisedMessage;
+    std::string lastRaisedId;
+
+    AlertRuleTable rules;
+    std::array<double, static_cast<std::size_t>(AlertSignal::Count)> lastValue;   // NaN until first seen
+    SimScheduler* scheduler;
+    int signalLostSince;            // Minute the CGM signal was lost, -1 while available
+    SimScheduler::TimerId silenceTimer;
+
+    int now() const;
+    AlarmEntry* findEntry(const std::string& alarmId);
+    void evaluate(AlertSignal signal, double value);
+    void raiseAlarm(Alarm* alarm, const AlertPolicy& policy);
+    void resolveAlarm(const std::string& alarmId);
+    void announce(AlarmEntry& entry, AlertAction action);
+    void scheduleEscalation(std::size_t index);
+    void cancelTimers(AlarmEntry& entry);
+    void scheduleSilenceDeadline();
+    void escalate(std::size_t index);
+    void endSnooze(std::size_t index);
+    void raiseOcclusion();
+    void raiseSignalLoss();
 
 public:
     AlertManager();
@@ -38,12 +120,35 @@ public:
 
     void checkBattery(Battery* batt);
     void checkCartridge(Cartridge* cart);
-    void raiseAlarm(Alarm* alarm);
+    void checkOcclusion(InsulinDeliveryManager* delivery);
+    void checkCGM(CGMSensorInterface* cgm);
+
+    bool subscribeTo(PumpEventBus& bus);
+    void onEvent(const BatteryLevelEvent& event);
+    void onEvent(const CartridgeVolumeEvent& event);
+    void onEvent(const OcclusionEvent& event);
+    void onEvent(const CGMSignalEvent& event);
+    void onEvent(const BGReadingEvent& event);
+    void onTimer(int tag);
+
+    void raiseAlarm(Alarm* alarm);                  // Takes ownership; no dedup or escalation
     void clearAlarm(const std::string &alarmId);
+    bool snoozeAlarm(const std::string& alarmId, int minutes);
     void update(); // Output or refresh active alarms
 
-    Profile* getProfile() const;
-    void setProfile(Profile* p);
+    const Alarm* findAlarm(const std::string& alarmId) const;
+    const AlertHistory& getHistory() const;
+    int getActiveAlarmCount() const;
+    unsigned long long getRaisedCount() const;      // Increases each time an alarm is announced
+    unsigned long long getSuppressedCount() const;  // Re-raises inside a deduplication window
+    std::string getLastRaisedMessage() const;
+    std::string getLastRaisedId() const;
+
+    SimScheduler* getScheduler() const;
+    void setScheduler(SimScheduler* s);
+
+    std::shared_ptr<const ProfileSnapshot> getProfileSnapshot() const;
+    void setProfileSnapshot(std::shared_ptr<const ProfileSnapshot> snapshot);
 };
 
 #endif // ALERTMANAGER_H
@@ -0,0 +1,104 @@
+/*
+AlertRuleTable
+    - Purpose: Threshold-crossing alert rules compiled from a profile's AlertSettings.
+    - Spec Refs:
+        + Handle Pump Malfunction – Battery, cartridge and CGM alerts.
+        + Control IQ Auto Adjustments – Glucose level and rate-of-change alerts.
+    - Design Notes:
+        + compile() turns the settings into a flat, fixed-size table of rules grouped by input
+          signal, with a start index per signal. evaluate(signal, value) walks only that signal's
+          rules, so it costs nothing for signals that did not change and adding rules adds no
+          per-tick work.
+        + Each rule has a raise threshold and a clear threshold (hysteresis). A rule raises once
+          when the value crosses the raise threshold and clears when it crosses back past the
+          clear threshold; in between it stays as it is, so a noisy value near the threshold
+          does not toggle the alert.
+        + Messages are printf formats taking the current value.
+        + Each rule carries its AlertPolicy (deduplication window, escalation delay), which
+          AlertManager applies once the alarm is raised.
+        + Recompiling keeps the state of rules that exist in both tables (matched by id), so an
+          alert that is up stays up until its value crosses the new clear threshold. The owner
+          re-evaluates the last known values afterwards and resolves alarms whose rule is gone.
+    - Class Overview:
+        + compile(settings) – Rebuilds the table; surviving rules keep their state, new ones start cleared.
+        + evaluate(signal, value, onChange) – Calls onChange(rule, raised, value) on each transition.
+        + nextThreshold(signal, raiseAt) – Lowest raise threshold still ahead, for deadline-style
+          signals that only grow (CGM silence).
+        + isActive(id) / getRuleCount() / getRule(index) – Introspection.
+*/
+
+#ifndef ALERTRULETABLE_H
+#define ALERTRULETABLE_H
+
+#include "AlertSettings.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+enum class AlertSignal : std::uint8_t {
+    BatteryLevel,       // %
+    CartridgeVolume,    // Units
+    BG,                 // mmol/L
+    BGRate,             // mmol/L per minute (negative = falling)
+    CGMSilence,         // Minutes since the last reading
+    Count
+};
+
+// How AlertManager treats an alarm after it is raised; 0 turns either behaviour off
+struct AlertPolicy {
+    int dedupMinutes = 0;       // A re-raise this soon after the last announcement is not announced
+    int escalateMinutes = 0;    // Unacknowledged this long: raise the severity one level
+};
+
+struct AlertRule {
+    const char* id;
+    const char* severity;
+    const char* format;         // printf format for the message, given the value
+    AlertSignal signal;
+    bool below;                 // Raise at or below raiseAt (else at or above)
+    double raiseAt;
+    double clearAt;             // Past raiseAt by the hysteresis
+    bool active;
+    AlertPolicy policy;
+};
+
+class AlertRuleTable {
+public:
+    static constexpr std::size_t kMaxRules = 16;
+
+    AlertRuleTable();
+
+    void compile(const AlertSettings& settings);
+
+    template <typename OnChange>
+    void evaluate(AlertSignal signal, double value, OnChange&& onChange) {
+        std::size_t s = static_cast<std::size_t>(signal);
+        for (std::size_t i = signalStart[s]; i < signalStart[s + 1]; ++i) {
+            AlertRule& rule = rules[i];
+            bool beyondRaise = rule.below ? value <= rule.raiseAt : value >= rule.raiseAt;
+            bool beyondClear = rule.below ? value > rule.clearAt : value < rule.clearAt;
+            if (!rule.active && beyondRaise) {
+                rule.active = true;
+                onChange(rule, true, value);
+            } else if (rule.active && beyondClear) {
+                rule.active = false;
+                onChange(rule, false, value);
+            }
+        }
+    }
+
+    bool nextThreshold(AlertSignal signal, double& raiseAt) const;
+    bool isActive(const char* id) const;
+    std::size_t getRuleCount() const { return count; }
+    const AlertRule& getRule(std::size_t index) const { return rules[index]; }
+
+private:
+    void add(AlertSignal signal, const char* id, const char* severity, const char* format,
+             bool below, double raiseAt, double hysteresis, AlertPolicy policy);
+
+    std::array<AlertRule, kMaxRules> rules;
+    std::size_t count;
+    std::array<std::size_t, static_cast<std::size_t>(AlertSignal::Count) + 1> signalStart;
+};
+
+#endif // ALERTRULETABLE_H
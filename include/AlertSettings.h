@@ -0,0 +1,34 @@
+/*
+AlertSettings
+    - Purpose: Per-profile alert thresholds (battery, cartridge, glucose level, rate of change, CGM silence).
+    - Spec Refs:
+        + Manage Personal Profiles (CRUD) – Alert thresholds are part of the personal profile.
+        + Handle Pump Malfunction – Battery, cartridge and sensor alerts.
+    - Design Notes:
+        + Plain data stored by value in Profile and ProfileSnapshot and persisted by ProfileStore.
+        + Battery and cartridge alerts are always on. A glucose, rate or silence threshold of 0
+          turns that alert off.
+        + AlertRuleTable compiles these into its evaluation table; hysteresis is fixed per signal.
+*/
+
+#ifndef ALERTSETTINGS_H
+#define ALERTSETTINGS_H
+
+struct AlertSettings {
+    double batteryLowPct = 20.0;         // Alert at or below this level (%)
+    double cartridgeLowUnits = 20.0;     // Alert at or below this volume (U)
+    double bgLow = 3.9;                  // mmol/L; alert at or below
+    double bgHigh = 13.9;                // mmol/L; alert at or above
+    double bgFallRate = 0.17;            // mmol/L per minute; alert when falling at least this fast
+    double bgRiseRate = 0.17;            // mmol/L per minute; alert when rising at least this fast
+    double cgmStaleMinutes = 20.0;       // Alert after this long without a CGM reading
+
+    bool isValid() const {
+        return batteryLowPct >= 0.0 && batteryLowPct <= 100.0
+            && cartridgeLowUnits >= 0.0
+            && bgLow >= 0.0 && bgHigh >= 0.0 && (bgLow == 0.0 || bgHigh == 0.0 || bgLow < bgHigh)
+            && bgFallRate >= 0.0 && bgRiseRate >= 0.0 && cgmStaleMinutes >= 0.0;
+    }
+};
+
+#endif // ALERTSETTINGS_H
@@ -0,0 +1,70 @@
+/*
+BGHistory
+    - Purpose: Bounded, multi-resolution store of BG readings for graphing arbitrarily long sessions.
+    - Spec Refs:
+        + View Pump Info & History – BG graph over the visible window and zoomed-out history.
+    - Design Notes:
+        + Level 0 is a ring buffer of raw readings (full resolution for the visible window).
+        + Each higher level is a ring of min/max pairs, one pair per `decimation` groups of the
+          level below, so hypo/hyper excursions survive decimation. Memory is fixed at
+          levelCount * levelCapacity points regardless of session length.
+        + query() picks the finest level that still covers the requested range, stitches in the
+          newer (not yet aggregated) points from finer levels and, if the result is still larger
+          than maxPoints, reduces it with LTTB (largest-triangle-three-buckets).
+        + With the defaults (2048 points, 4 levels, x8) history reaches back roughly one year of
+          1-minute ticks; older data falls off the coarsest ring.
+    - Class Overview:
+        + append(minute, bg) – O(1) amortized insert of a reading (minutes must be increasing).
+        + query(from, to, maxPoints, out) – Points to draw for [from, to], at most maxPoints.
+        + firstMinute() / lastMinute() – Extent of retained history.
+*/
+
+#ifndef BGHISTORY_H
+#define BGHISTORY_H
+
+#include <cstddef>
+#include <vector>
+
+struct BGPoint {
+    double minute;
+    double bg;
+};
+
+class BGHistory {
+private:
+    struct Level {
+        std::vector<BGPoint> ring;
+        std::size_t head = 0;       // Next write slot
+        std::size_t count = 0;      // Valid points in ring
+
+        // Group currently being aggregated from the level below
+        BGPoint pendingMin = { 0.0, 0.0 };
+        BGPoint pendingMax = { 0.0, 0.0 };
+        int pendingGroups = 0;
+
+        void push(const BGPoint& p);
+        const BGPoint& at(std::size_t i) const;   // 0 = oldest
+        std::size_t lowerBound(double minute) const;
+    };
+
+    std::vector<Level> levels;
+    std::size_t levelCapacity;
+    int decimation;
+
+    void feed(std::size_t levelIndex, const BGPoint& groupMin, const BGPoint& groupMax);
+
+public:
+    explicit BGHistory(std::size_t levelCapacity = 2048, int levelCount = 4, int decimation = 8);
+
+    void append(double minute, double bg);
+    void query(double fromMinute, double toMinute, std::size_t maxPoints, std::vector<BGPoint>& out) const;
+    void clear();
+
+    bool empty() const;
+    double firstMinute() const;
+    double lastMinute() const;
+
+    static void downsampleLTTB(const std::vector<BGPoint>& in, std::size_t threshold, std::vector<BGPoint>& out);
+};
+
+#endif // BGHISTORY_H
@@ -6,19 +6,56 @@ Battery
         + Handle Pump Malfunction – Triggers warnings/errors if battery < threshold.
         + View Pump Info & History – Can be shown in GUI (icon or log entry).
     - Design Notes:
-        + Simple integer level (0 to 100%).
-        + Expandable with charge/discharge logic in future.
+        + Charge is an integer in microamp-hours; the level (0 to 100%) is derived from it.
+        + Discharge follows activity: a baseline idle draw, each motor stroke, each CGM radio
+          reading and every minute the screen is on. accountActivity() takes the running stroke
+          and reading totals and charges only the difference since the last call, so the cost per
+          tick is a few integer operations however long the run is.
+        + With the default costs a typical day (about 20 U delivered, a CGM reading every 5
+          minutes at the default cadence, little screen time) uses roughly 11% of a full charge.
+        + A temporary sag (FaultInjector) lowers the reported level without draining the charge.
+        + With an event bus attached, a BatteryLevelEvent is published whenever the reported
+          level changes (discharge, setLevel or sag), so nobody has to poll getLevel().
     - Class Overview:
         + getLevel() – Returns battery level (0–100).
-        + setLevel(lvl) – Manually set battery level.
+        + setLevel(lvl) – Manually set battery level (e.g. charging).
+        + accountActivity(minutes, strokes, readings) – Incremental discharge from activity totals.
+        + wakeScreen(minutes) – Keeps the screen on (and drawing power) for a while.
+        + drain(pct) / consume(uAh) – Direct discharge.
+        + setSag(pct) – Temporary drop applied to the reported level.
+        + setEventBus(bus) / publishState() – Level change notifications.
 */
 
 #ifndef BATTERY_H
 #define BATTERY_H
 
+#include <cstdint>
+
+class PumpEventBus;
+
 class Battery {
+public:
+    // Energy model, in microamp-hours
+    static constexpr std::int64_t kCapacity = 300000;          // 300 mAh
+    static constexpr std::int64_t kIdleCostPerMinute = 15;     // ~0.9 mA baseline
+    static constexpr std::int64_t kStrokeCost = 20;            // Per 0.05 U motor stroke
+    static constexpr std::int64_t kReadingCost = 10;           // Per CGM radio reading
+    static constexpr std::int64_t kScreenCostPerMinute = 300;  // ~18 mA backlight
+    static constexpr double kScreenTimeoutMinutes = 0.5;
+
 private:
-    int level;  // Battery charge level (percentage)
+    std::int64_t charge;              // Remaining charge (uAh)
+    int sag;                          // Temporary voltage sag (percentage points)
+
+    std::uint64_t lastStrokeCount;    // Activity totals already charged for
+    std::uint64_t lastReadingCount;
+    double idleRemainder;             // Fractional minutes carried between calls
+    double screenOnRemaining;         // Minutes of screen time left
+
+    PumpEventBus* eventBus;
+    int publishedLevel;               // Last level published on the bus
+
+    void publishLevelIfChanged();
 
 public:
     Battery();
@@ -26,9 +63,17 @@ public:
 
     int getLevel() const;
     void setLevel(int lvl);
+    std::int64_t getCharge() const;
+
+    void accountActivity(double minutes, std::uint64_t strokeCount, std::uint64_t readingCount);
+    void wakeScreen(double minutes = kScreenTimeoutMinutes);
 
     void drain(int amount);
+    void consume(std::int64_t microAmpHours);
+    void setSag(int pct);
 
+    void setEventBus(PumpEventBus* bus);
+    void publishState();
 };
 
 #endif // BATTERY_H
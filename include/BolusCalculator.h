@@ -6,20 +6,39 @@ BolusCalculator
         + Control IQ Auto Adjustments – Shares logic with automated correction bolus algorithms.
     - Design Notes:
         + Uses user profile parameters: ICR, Correction Factor, and Target BG.
+        + Accepts either a Profile or an immutable ProfileSnapshot (simulation-side callers).
         + Can compute extended bolus splits for spread-out insulin delivery.
         + Future expansion: incorporate safety checks, Control IQ conditions, logging.
+        + calculateBolusBatch() evaluates the same formula over parallel arrays for population
+          audits: no I/O, two doses per step with SSE4.1 when the CPU has it (picked at run time),
+          scalar otherwise. Rounding reproduces std::round (half away from zero) and the
+          operations match the scalar path one for one, so results are bit-identical.
     - Class Overview:
         + calculateBolus() – Combines carb and correction bolus, adjusts for IOB.
         + calculateExtendedBolusSplit() – Splits total bolus into fractions.
         + calculateCorrectionBolus() – Calculates correction dose based on BG delta.
+        + calculateBolusBatch() – Recommended doses for many patients in one pass.
 */
 
 #ifndef BOLUSCALCULATOR_H
 #define BOLUSCALCULATOR_H
 
 #include <cmath>
+#include <cstddef>
 
 class Profile;
+class ProfileSnapshot;
+
+// Parallel input arrays for BolusCalculator::calculateBolusBatch(), `count` entries each
+struct BolusBatchInput {
+    const double* currentBG = nullptr;
+    const double* carbIntake = nullptr;
+    const double* iob = nullptr;
+    const double* icr = nullptr;
+    const double* correctionFactor = nullptr;
+    const double* targetBG = nullptr;
+    std::size_t count = 0;
+};
 
 class BolusCalculator {
 public:
@@ -27,8 +46,15 @@ public:
     ~BolusCalculator();
 
     double calculateBolus(double currentBG, double carbIntake, double iob, Profile* profile);
+    double calculateBolus(double currentBG, double carbIntake, double iob, const ProfileSnapshot& profile);
     double calculateExtendedBolusSplit(double totalBolus, double splits);
     double calculateCorrectionBolus(double currentBG, double targetBG, double correctionFactor);
+
+    static void calculateBolusBatch(const BolusBatchInput& input, double* doses);
+
+private:
+    double calculateBolus(double currentBG, double carbIntake, double iob,
+                          double icr, double correctionFactor, double targetBG);
 };
 
 #endif // BOLUSCALCULATOR_H
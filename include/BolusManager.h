@@ -9,15 +9,26 @@ BolusManager
         + Uses ProfileManager to fetch the active user profile.
         + Uses BolusCalculator for dose computation and delegates to InsulinDeliveryManager for delivery.
         + Optionally uses CGMSensorInterface to obtain real-time glucose values.
+        + Recommendations are memoized. Inputs are quantized to what the pump can tell apart
+          (BG 0.1 mmol/L, carbs 0.1 g, IOB one 0.05 U stroke), and the dose is computed from
+          the quantized values, so a cached answer is exactly what a fresh calculation would
+          give. The small direct-mapped cache belongs to one (profile version, IOB) pair and is
+          emptied when either changes.
     - Class Overview:
         + computeRecommendedDose() – Calculates dose based on inputs and profile data.
-        + deliverBolus(...) – Sends insulin via delivery manager (immediate or extended).
+        + submitBolus(request) – Hands a BolusRequest to the delivery manager and returns its status.
         + getBGFromCGM() – Returns CGM blood glucose (if sensor available).
+        + clearDoseCache() / getDoseCacheHits() / getDoseCacheMisses() – Memo control and stats.
 */
 
 #ifndef BOLUSMANAGER_H
 #define BOLUSMANAGER_H
 
+#include "BolusRequest.h"
+#include "InsulinUnits.h"
+#include <cstddef>
+#include <cstdint>
+
 class ProfileManager;
 class BolusCalculator;
 class InsulinDeliveryManager;
@@ -30,17 +41,33 @@ public:
     ~BolusManager();
 
     double computeRecommendedDose(double currentBG, double carbIntake);
-    void deliverBolus(double dose, bool extended = false, double duration = 0.0);
-    void deliverBolus(double dose, bool extended, double immediateAmount, double duration, int splits);
-    void deliverBolus(double dose, bool extended, double immediateAmount, double duration, int splits, int startTime);
+    BolusStatus submitBolus(const BolusRequest& request);
 
     double getBGFromCGM() const;
 
+    void clearDoseCache();
+    std::uint64_t getDoseCacheHits() const { return doseCacheHits; }
+    std::uint64_t getDoseCacheMisses() const { return doseCacheMisses; }
+
 private:
+    struct DoseCacheEntry {
+        bool valid;
+        std::int64_t bgKey;        // BG in 0.1 mmol/L
+        std::int64_t carbKey;      // Carbs in 0.1 g
+        double dose;
+    };
+    static const std::size_t kDoseCacheSize = 64;   // Power of two
+
     ProfileManager* profileManager;
     BolusCalculator* bolusCalculator;
     InsulinDeliveryManager* deliveryManager;
     CGMSensorInterface* cgmSensor;
+
+    DoseCacheEntry doseCache[kDoseCacheSize];
+    std::uint64_t cachedProfileVersion;
+    MicroUnits cachedIOB;
+    std::uint64_t doseCacheHits;
+    std::uint64_t doseCacheMisses;
 };
 
 #endif // BOLUSMANAGER_H
@@ -0,0 +1,80 @@
+/*
+BolusRequest
+    - Purpose: One value type describing any bolus the pump can deliver, manual or automated.
+    - Spec Refs:
+        + Deliver Manual Bolus – Immediate, extended and dual-wave (immediate + extended) boluses.
+        + Control IQ Auto Adjustments – Automated correction boluses use the same request.
+    - Design Notes:
+        + Plain data, built with the named factories; InsulinDeliveryManager::submitBolus() is the
+          single path that validates, checks the cartridge and schedules the splits.
+        + startTime anchors the extended splits (split i is due at start + i * duration / splits);
+          kStartNow means "the delivery manager's current simulated time".
+        + The outcome is reported as a BolusStatus instead of only a log line. A batched request
+          is Queued first; its final status is recorded as a BolusOutcome carrying the caller's tag.
+        + PatientBolusRequest pairs a request with the pump it is meant for, for batches that
+          span several simulated patients.
+    - Class Overview:
+        + BolusRequest::immediate() / extended() / dualWave()
+        + PatientBolusRequest – Request plus target pump for cohort batches.
+        + BolusOutcome – Final status of a queued request, keyed by its tag.
+        + bolusStatusName(status) – Human-readable status for logs and dialogs.
+        + bolusSucceeded(status) – Delivered or Scheduled.
+*/
+
+#ifndef BOLUSREQUEST_H
+#define BOLUSREQUEST_H
+
+#include "DoseLedger.h"
+
+class InsulinDeliveryManager;
+
+enum class BolusStatus {
+    Delivered,              // Immediate bolus given
+    Scheduled,              // Immediate part (if any) given, splits queued
+    InvalidRequest,
+    NoCartridge,
+    InsufficientInsulin,
+    DeliveryFailed,         // Cartridge draw failed or the line is occluded
+    Busy,                   // No free extended bolus slot
+    Queued                  // Accepted by a batch; submitted when its start time comes
+};
+
+struct BolusRequest {
+    enum Kind {
+        Immediate,
+        Extended,           // Whole dose spread over the duration
+        DualWave            // immediateUnits now, the rest spread over the duration
+    };
+
+    static constexpr double kStartNow = -1.0;
+
+    Kind kind = Immediate;
+    double totalUnits = 0.0;
+    double immediateUnits = 0.0;
+    double durationMinutes = 0.0;
+    int splits = 1;
+    double startTime = kStartNow;         // Simulated minutes
+    DoseSource source = DoseSource::Manual;
+    int tag = -1;                         // Caller's id, echoed in the BolusOutcome of a batched request
+
+    static BolusRequest immediate(double units, DoseSource source = DoseSource::Manual);
+    static BolusRequest extended(double units, double durationMinutes, int splits, double startTime = kStartNow);
+    static BolusRequest dualWave(double totalUnits, double immediateUnits, double durationMinutes, int splits,
+                                 double startTime = kStartNow);
+};
+
+struct PatientBolusRequest {
+    InsulinDeliveryManager* patient = nullptr;
+    BolusRequest request;
+};
+
+struct BolusOutcome {
+    int tag = -1;
+    double startTime = 0.0;               // Minute the request was submitted
+    BolusStatus status = BolusStatus::Queued;
+};
+
+const char* bolusStatusName(BolusStatus status);
+bool bolusSucceeded(BolusStatus status);
+
+#endif // BOLUSREQUEST_H
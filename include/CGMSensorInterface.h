@@ -1,10 +1,15 @@
 #ifndef CGMSENSORINTERFACE_H
 #define CGMSENSORINTERFACE_H
 
+#include "CGMTrend.h"
+#include <array>
+#include <cstdint>
+#include <random>
 #include <vector>
 
 class Profile;
 class InsulinDeliveryManager;
+class PumpEventBus;
 
 /*
  * CGMSensorInterface
@@ -12,10 +17,25 @@ class InsulinDeliveryManager;
  * This class simulates a Continuous Glucose Monitor (CGM) sensor.
  * It provides the current blood glucose (BG) value and can simulate the next reading.
  *
+ * The physiology (carbs, insulin, noise) advances every one-minute tick, but the sensor only
+ * reports on its own cadence (every 5 minutes by default, on a fixed phase). Between readings
+ * getCurrentBG() holds the last reported value. Each reading sees the BG from latencyMinutes
+ * earlier (a per-minute delay line, like interstitial lag) scaled by a calibration gain that
+ * drifts by calibrationDriftPct per day until calibrate() is called.
+ *
  * Use Cases Supported:
  * - Feeding CGM data to ControlIQController for automatic insulin adjustments.
+ * - Handle Pump Malfunction: signal loss and a reading offset (e.g. compression lows) can be
+ *   injected; the physiology keeps running underneath and getCurrentBG() reports the sensor value.
+ * - With an event bus attached, each new reading publishes a BGReadingEvent and signal loss or
+ *   recovery publishes a CGMSignalEvent.
+ * - Every reading also feeds a CGMTrend (O(1) per reading), so the controller, alerts and the
+ *   GUI share one rate of change and trend arrow; the event carries both. Signal loss resets it.
  */
 class CGMSensorInterface {
+public:
+    static constexpr int kMaxLatencyMinutes = 31;
+
 private:
     Profile* profile;
     double currentBG;
@@ -25,7 +45,26 @@ private:
     std::vector<std::pair<int, int>> carbSchedule; // (minute, grams)
     int simulatedTime = 0;
     InsulinDeliveryManager* deliveryManager = nullptr;
+    std::mt19937 noise;                            // Per-sensor noise source (reproducible with setSeed)
+    bool signalLost = false;
+    double readingOffset = 0.0;                    // Sensor error added to the true BG (mmol/L)
 
+    // Sensor model: cadence, interstitial latency and calibration drift
+    int cadenceMinutes = 5;
+    int nextReadingMinute = 0;
+    int latencyMinutes = 0;
+    std::array<double, kMaxLatencyMinutes + 1> bgDelayLine {};   // True BG per minute, newest at delayHead
+    std::size_t delayHead = 0;
+    double calibrationDriftPct = 0.0;              // Gain drift, % per day
+    int calibratedAt = 0;
+    double sensorBG;                               // Last reported reading
+    std::uint64_t readingCount = 0;                // Radio readings taken (battery model)
+    PumpEventBus* eventBus = nullptr;
+    CGMTrend trend;
+
+    void takeReading();
+    void recordReading();
+    void publishReading();
 
 public:
     CGMSensorInterface();
@@ -33,15 +72,35 @@ public:
 
     // Get the current blood glucose reading.
     double getCurrentBG() const;
-    // Simulate the next sensor reading.
+    // Advance the physiology one minute; takes a sensor reading when one is due.
     void simulateNextReading();
-    // Set a new blood glucose value.
+    // Set a new blood glucose value (reported immediately).
     void setBG(double newValue);
+    double getTrueBG() const;               // Physiological BG, before latency and sensor error
 
     void addCarbs(int grams);               // Call this to simulate snacking
     void setSimulatedTime(int time);        // Called by PumpSimulator each tick
     void setDeliveryManager(InsulinDeliveryManager* dm);  // Inject dependency
+    void setSeed(unsigned int seed);        // Makes the reading noise reproducible
+    std::uint64_t getReadingCount() const;  // Readings taken so far
+
+    // Sensor model
+    void setCadenceMinutes(int minutes);    // >= 1
+    int getCadenceMinutes() const;
+    int getNextReadingMinute() const;       // Simulated minute of the next scheduled reading
+    void setLatencyMinutes(int minutes);    // 0..kMaxLatencyMinutes
+    int getLatencyMinutes() const;
+    void setCalibrationDrift(double pctPerDay);
+    void calibrate();                       // Clears the drift accumulated so far
+    const CGMTrend& getTrend() const;       // Rate of change over recent readings
+
+    // Fault hooks (FaultInjector)
+    void setSignalLost(bool lost);
+    bool isReadingAvailable() const;        // False while the sensor signal is lost
+    void setReadingOffset(double offset);
 
+    void setEventBus(PumpEventBus* bus);
+    void publishState();
 };
 
 #endif // CGMSENSORINTERFACE_H
\ No newline at end of file
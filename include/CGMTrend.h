@@ -0,0 +1,89 @@
+/*
+CGMTrend
+    - Purpose: Rate of change, acceleration and trend arrow of recent CGM readings.
+    - Spec Refs:
+        + Control IQ Auto Adjustments – The controller projects BG along the trend.
+        + View Pump Info & History – Trend arrow next to the current reading.
+        + Handle Pump Malfunction – Rate-of-change alerts.
+    - Design Notes:
+        + Fixed-capacity ring of (minute, BG) samples held inline; the window is time-based
+          (kWindowMinutes), so it works for any sensor cadence. Samples older than the window are
+          evicted from the front as new ones arrive.
+        + Running sums of t, t², t³, t⁴, y, ty and t²y are updated on every add and evict, so the
+          least-squares slope (linear fit) and acceleration (quadratic fit) cost O(1) per reading
+          instead of a pass over the history.
+        + Times are stored relative to an origin. Once the newest sample is more than an hour
+          (kRebaseMinutes) past it, the origin moves to the oldest sample, about kWindowMinutes
+          back, and the sums are rebuilt from the ring (at most kCapacity samples). That happens
+          roughly every 45 minutes of readings, which keeps t⁴ small and also discards accumulated
+          rounding from the add/subtract updates.
+        + A reading at the same minute as the newest sample replaces it.
+        + Arrow thresholds follow the usual CGM convention (1, 2 and 3 mg/dL per minute).
+    - Class Overview:
+        + addReading(minute, bg) / clear() – Feed and reset.
+        + hasTrend() – At least kMinSamples samples spanning more than one minute.
+        + getSlope() – mmol/L per minute (linear fit over the window).
+        + getAcceleration() – mmol/L per minute² (quadratic fit; 0 with fewer than 3 samples).
+        + getArrow() / arrowFor(slope) / arrowSymbol(arrow) / arrowName(arrow) – Trend arrows.
+*/
+
+#ifndef CGMTREND_H
+#define CGMTREND_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+enum class TrendArrow : std::uint8_t {
+    None,               // Not enough readings
+    DoubleDown,
+    SingleDown,
+    FortyFiveDown,
+    Flat,
+    FortyFiveUp,
+    SingleUp,
+    DoubleUp
+};
+
+class CGMTrend {
+public:
+    static const std::size_t kCapacity = 32;        // Power of two; covers the window at a 1-minute cadence
+    static const int kWindowMinutes = 15;
+    static const std::size_t kMinSamples = 2;
+
+    CGMTrend();
+
+    void addReading(int minute, double bg);
+    void clear();
+
+    bool hasTrend() const;
+    std::size_t getSampleCount() const { return count; }
+    double getSlope() const;
+    double getAcceleration() const;
+    TrendArrow getArrow() const;
+
+    static TrendArrow arrowFor(double slope);
+    static const char* arrowSymbol(TrendArrow arrow);
+    static const char* arrowName(TrendArrow arrow);
+
+private:
+    struct Sample {
+        int minute;
+        double bg;
+    };
+
+    void accumulate(const Sample& sample, double sign);
+    void evictBefore(int minute);
+    void rebase();
+
+    std::array<Sample, kCapacity> samples;
+    std::size_t head;                  // Oldest sample
+    std::size_t count;
+    int origin;                        // Times in the sums are minute - origin
+
+    // Running sums over the samples in the window
+    double sumT, sumT2, sumT3, sumT4;
+    double sumY, sumTY, sumT2Y;
+};
+
+#endif // CGMTREND_H
@@ -9,10 +9,22 @@ Cartridge
     - Design Notes:
         + Supports consumption, refill, and low-level detection.
         + Default capacity is 200 units (modifiable).
-        + Could be extended to simulate occlusion, leaks, or expiry.
+        + Volumes are held in integer MicroUnits so repeated small draws never drift.
+        + leak() removes insulin that never reaches the patient (FaultInjector).
+        + Scheduled doses use a two-phase protocol: reserve() sets insulin aside when a plan is
+          made, commitReserved() draws it at delivery time and release() returns whatever a
+          cancelled or failed plan no longer needs. Unreserved draws (useMicroUnits) can only
+          take the available (unreserved) volume. All three are O(1).
+        + A leak or manual volume change can leave less insulin than is reserved; the shortfall
+          shows up as a failed commitReserved().
+        + With an event bus attached, every change of the volume publishes a CartridgeVolumeEvent.
     - Class Overview:
-        + useInsulin(amount) – Deducts units; returns success/failure.
+        + useInsulin(amount) / useMicroUnits(amount) – Deducts insulin; returns success/failure.
         + refill() – Resets to full capacity.
+        + leak(amount) – Silently loses insulin (clamped at empty).
+        + reserve() / commitReserved() / release() – Reservations for scheduled doses.
+        + getAvailableMicroUnits() / getReservedMicroUnits() – Unreserved and reserved insulin.
+        + setEventBus(bus) / publishState() – Volume change notifications.
         + isLow() – Returns true if under 10% capacity.
         + get/set methods – For capacity and volume.
 */
@@ -20,23 +32,43 @@ Cartridge
 #ifndef CARTRIDGE_H
 #define CARTRIDGE_H
 
+#include "InsulinUnits.h"
+
+class PumpEventBus;
+
 class Cartridge {
 private:
-    double capacity;
-    double currentVolume;
+    MicroUnits capacity;
+    MicroUnits currentVolume;
+    MicroUnits reserved;
+    PumpEventBus* eventBus;
+    MicroUnits publishedVolume;     // Last volume published on the bus
+
+    void publishVolume();
 
 public:
     Cartridge();
     ~Cartridge();
 
     bool useInsulin(double amount);
+    bool useMicroUnits(MicroUnits amount);
     void refill();
+    void leak(MicroUnits amount);
+    bool reserve(MicroUnits amount);
+    bool commitReserved(MicroUnits amount);
+    void release(MicroUnits amount);
     bool isLow() const;
 
     double getCapacity() const;
     void setCapacity(double cap);
     double getCurrentVolume() const;
     void setCurrentVolume(double vol);
+    MicroUnits getCurrentMicroUnits() const;
+    MicroUnits getAvailableMicroUnits() const;
+    MicroUnits getReservedMicroUnits() const;
+
+    void setEventBus(PumpEventBus* bus);
+    void publishState();
 };
 
 #endif // CARTRIDGE_H
@@ -5,26 +5,35 @@ ControlIQController
         + Control IQ Auto Adjustments – Delivers predictive corrections and adjusts basal.
         + Handle Pump Malfunction – Should be prepared for missing sensor or delivery manager.
     - Design Notes:
-        + Designed to run periodically (e.g., each tick) to read CGM and adjust dosing.
-        + Uses a basic BG offset for prediction, modifiable later with trend data.
+        + Runs once per new CGM reading (every 5 minutes by default); PumpSimulator wakes it
+          through its SimScheduler at the sensor's next reading minute.
+        + Predicts from the current reading, the insulin on board and the sensor's CGMTrend slope
+          projected over kTrendHorizonMinutes (the trend is maintained by the sensor; the
+          controller does not keep its own history).
+        + Holds the active profile as an immutable snapshot refreshed by PumpSimulator each tick.
     - Class Overview:
         + processSensorReading() – Updates predicted BG based on current CGM input.
-        + predictBGTrend() – Offsets current BG to simulate a short-term prediction.
+        + predictBGTrend() – Short-term prediction from BG, IOB and the CGM trend.
         + applyAutomaticAdjustments() – Uses thresholds to stop, reduce, increase basal or trigger bolus.
 */
 
 #ifndef CONTROLIQCONTROLLER_H
 #define CONTROLIQCONTROLLER_H
 
+#include <memory>
+
 class CGMSensorInterface;
 class InsulinDeliveryManager;
-class Profile;
+class ProfileSnapshot;
 
 class ControlIQController {
+public:
+    static constexpr double kTrendHorizonMinutes = 10.0;
+
 private:
     CGMSensorInterface* cgmSensor;
     InsulinDeliveryManager* deliveryManager;
-    Profile* activeProfile;
+    std::shared_ptr<const ProfileSnapshot> activeProfile;
     double predictedBG;
     bool isActive;
 
@@ -46,6 +55,9 @@ public:
 
     CGMSensorInterface* getCGMSensor() const;
     void setCGMSensor(CGMSensorInterface* sensor);
+
+    std::shared_ptr<const ProfileSnapshot> getProfileSnapshot() const;
+    void setProfileSnapshot(std::shared_ptr<const ProfileSnapshot> snapshot);
 };
 
 #endif // CONTROLIQCONTROLLER_H
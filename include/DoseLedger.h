@@ -0,0 +1,77 @@
+/*
+DoseLedger
+    - Purpose: Keeps the individual doses behind insulin on board instead of only their sum.
+    - Spec Refs:
+        + View Pump Info & History – Recent boluses and basal pulses with their origin.
+        + Control IQ Auto Adjustments – Doses issued by the controller are tagged as such.
+    - Design Notes:
+        + Records live in a FixedRing held inline (no heap); the oldest record is overwritten
+          when full, so steady-state recording never allocates.
+        + kCapacity covers the insulin action duration with headroom: delivery emits at most one
+          basal record per tick (one-minute ticks) plus occasional bolus and extended parts.
+        + Records are appended in simulated-time order, so range queries walk back from the newest
+          record and stop at the first one outside the window.
+        + Readers visit records in place (forEachSince, at); nothing is copied out.
+    - Class Overview:
+        + record(time, amount, type, source) – Appends one delivered dose.
+        + size() / at(i) / latest() – Retained records, oldest first.
+        + forEachSince(time, fn) / sumSince(time) – Window queries (e.g. insulin action time).
+        + getTotalRecorded() – Records ever appended, including overwritten ones.
+*/
+
+#ifndef DOSELEDGER_H
+#define DOSELEDGER_H
+
+#include "FixedRing.h"
+#include "InsulinUnits.h"
+#include <cstddef>
+#include <cstdint>
+
+enum class DoseType : std::uint8_t { Bolus, Basal };
+enum class DoseSource : std::uint8_t { Manual, ControlIQ, Extended };
+
+struct DoseRecord {
+    double time = 0.0;             // Simulated minutes
+    MicroUnits amount = 0;
+    DoseType type = DoseType::Bolus;
+    DoseSource source = DoseSource::Manual;
+};
+
+class DoseLedger {
+public:
+    static const int kInsulinActionMinutes = 300;
+    static const std::size_t kCapacity = 1024;   // Power of two, > 2 records per action minute
+
+    DoseLedger();
+
+    void record(double time, MicroUnits amount, DoseType type, DoseSource source);
+    void clear() { records.clear(); }
+
+    std::size_t size() const { return records.size(); }
+    bool empty() const { return records.empty(); }
+    std::uint64_t getTotalRecorded() const { return records.getTotalWritten(); }
+
+    const DoseRecord& at(std::size_t index) const { return records.at(index); }   // 0 = oldest retained record
+    const DoseRecord& latest() const { return records.latest(); }                 // Requires !empty()
+
+    // Visits records with time >= since, oldest first
+    template <typename Fn>
+    void forEachSince(double since, Fn&& fn) const {
+        std::size_t count = size();
+        std::size_t first = count;
+        while (first > 0 && at(first - 1).time >= since)
+            --first;
+        for (std::size_t i = first; i < count; ++i)
+            fn(at(i));
+    }
+
+    MicroUnits sumSince(double since) const;
+
+    static const char* typeName(DoseType type);
+    static const char* sourceName(DoseSource source);
+
+private:
+    FixedRing<DoseRecord, kCapacity> records;
+};
+
+#endif // DOSELEDGER_H
@@ -0,0 +1,112 @@
+/*
+EventBus
+    - Purpose: Typed publish/subscribe between subsystems, so consumers react to state changes
+      instead of polling getters every tick.
+    - Spec Refs:
+        + Handle Pump Malfunction – Alerts react to battery, cartridge and sensor changes.
+        + View Pump Info & History – Displayed pump state follows published changes.
+    - Design Notes:
+        + The event types are fixed at compile time (EventBus<Events...>). Each type has its own
+          EventChannel in a std::tuple, picked by std::get, so publishing an event type the bus
+          does not carry is a compile error rather than a lookup.
+        + A subscription is the listener pointer plus a plain function pointer instantiated for
+          (listener type, event type) that calls listener->onEvent(event). No std::function, no
+          virtual interface, no heap: each channel holds at most kMaxSubscribers in an array.
+        + publish() calls subscribers synchronously, in subscription order, on the publishing
+          thread. The bus is not thread-safe; it belongs to the simulation thread.
+        + Publishers are expected to publish only when a value actually changes.
+    - Class Overview:
+        + subscribe<Event>(listener) / unsubscribe<Event>(listener) – One event type.
+        + unsubscribeAll(listener) – Removes the listener from every channel.
+        + publish(event) – Delivers to the subscribers of decltype(event).
+*/
+
+#ifndef EVENTBUS_H
+#define EVENTBUS_H
+
+#include <array>
+#include <cstddef>
+#include <tuple>
+
+template <typename Event>
+class EventChannel {
+public:
+    static constexpr std::size_t kMaxSubscribers = 8;
+
+    // Returns false if the channel is full; subscribing twice is a no-op
+    template <typename Listener>
+    bool subscribe(Listener* listener) {
+        for (std::size_t i = 0; i < count; ++i)
+            if (slots[i].listener == listener)
+                return true;
+        if (count == kMaxSubscribers)
+            return false;
+        slots[count++] = { listener, &deliver<Listener> };
+        return true;
+    }
+
+    void unsubscribe(const void* listener) {
+        for (std::size_t i = 0; i < count; ++i) {
+            if (slots[i].listener == listener) {
+                for (std::size_t j = i + 1; j < count; ++j)
+                    slots[j - 1] = slots[j];
+                --count;
+                return;
+            }
+        }
+    }
+
+    void publish(const Event& event) const {
+        for (std::size_t i = 0; i < count; ++i)
+            slots[i].call(slots[i].listener, event);
+    }
+
+    std::size_t getSubscriberCount() const { return count; }
+
+private:
+    struct Slot {
+        void* listener;
+        void (*call)(void*, const Event&);
+    };
+
+    template <typename Listener>
+    static void deliver(void* listener, const Event& event) {
+        static_cast<Listener*>(listener)->onEvent(event);
+    }
+
+    std::array<Slot, kMaxSubscribers> slots {};
+    std::size_t count = 0;
+};
+
+template <typename... Events>
+class EventBus {
+public:
+    template <typename Event, typename Listener>
+    bool subscribe(Listener* listener) {
+        return std::get<EventChannel<Event>>(channels).subscribe(listener);
+    }
+
+    template <typename Event>
+    void unsubscribe(const void* listener) {
+        std::get<EventChannel<Event>>(channels).unsubscribe(listener);
+    }
+
+    void unsubscribeAll(const void* listener) {
+        (std::get<EventChannel<Events>>(channels).unsubscribe(listener), ...);
+    }
+
+    template <typename Event>
+    void publish(const Event& event) const {
+        std::get<EventChannel<Event>>(channels).publish(event);
+    }
+
+    template <typename Event>
+    std::size_t getSubscriberCount() const {
+        return std::get<EventChannel<Event>>(channels).getSubscriberCount();
+    }
+
+private:
+    std::tuple<EventChannel<Events>...> channels;
+};
+
+#endif // EVENTBUS_H
@@ -0,0 +1,95 @@
+/*
+FaultInjector
+    - Purpose: Makes pump hardware and the CGM fail mid-run on a schedule, so alarm and
+      delivery-suspension paths can be exercised headlessly and at full simulation speed.
+    - Spec Refs:
+        + Handle Pump Malfunction – Occlusions, sensor signal loss, battery and cartridge faults.
+    - Design Notes:
+        + The whole campaign is a precomputed list of FaultEvents (explicit, random, or both);
+          onTick() only walks a cursor over the sorted list and the few active faults, so it
+          costs nothing when no fault starts or ends.
+        + Random campaigns are a Poisson process (exponential gaps) with per-kind duration and
+          magnitude ranges, drawn from their own seed so runs are reproducible.
+        + Faults act through small hooks on the components (occluded line, lost CGM signal,
+          reading offset, battery sag, cartridge leak); overlapping faults of one kind add up.
+        + Fault kinds and effects:
+              Occlusion       – strokes are blocked; the delivery manager detects it and suspends
+              CGMDropout      – no sensor reading is available
+              CompressionLow  – readings are magnitude mmol/L below the true BG
+              BatterySag      – reported level drops by magnitude %
+              CartridgeLeak   – magnitude U/hr is lost from the cartridge
+    - Class Overview:
+        + schedule(event) / generateRandom(seed, horizon, faultsPerDay) / clear()
+        + onTick(minute) – Starts and ends faults due at this simulated minute.
+        + isActive(kind) / getInjectedCount() / getSchedule()
+*/
+
+#ifndef FAULTINJECTOR_H
+#define FAULTINJECTOR_H
+
+#include <cstddef>
+#include <vector>
+
+class Battery;
+class Cartridge;
+class CGMSensorInterface;
+class InsulinDeliveryManager;
+
+struct FaultEvent {
+    enum Kind {
+        Occlusion,
+        CGMDropout,
+        CompressionLow,     // magnitude = mmol/L
+        BatterySag,         // magnitude = %
+        CartridgeLeak,      // magnitude = U/hr
+        KindCount
+    };
+
+    Kind kind = Occlusion;
+    int startMinute = 0;
+    int durationMinutes = 1;
+    double magnitude = 0.0;
+};
+
+class FaultInjector {
+public:
+    FaultInjector();
+
+    void schedule(const FaultEvent& event);
+    void generateRandom(unsigned int seed, int horizonMinutes, double faultsPerDay);
+    void clear();
+
+    void onTick(int minute);
+
+    bool isActive(FaultEvent::Kind kind) const;
+    int getInjectedCount() const { return injectedCount; }
+    const std::vector<FaultEvent>& getSchedule() const { return events; }
+
+    void setBattery(Battery* b) { battery = b; }
+    void setCartridge(Cartridge* c) { cartridge = c; }
+    void setCGMSensor(CGMSensorInterface* cgm) { cgmSensor = cgm; }
+    void setInsulinDeliveryManager(InsulinDeliveryManager* idm) { deliveryManager = idm; }
+
+    static const char* kindName(FaultEvent::Kind kind);
+
+private:
+    void begin(const FaultEvent& event);
+    void end(const FaultEvent& event);
+    void applyEffects();
+
+    std::vector<FaultEvent> events;          // Sorted by start minute before the first tick
+    bool sorted;
+    std::size_t nextEvent;
+    std::vector<std::size_t> active;         // Indices into events
+
+    int activeCount[FaultEvent::KindCount];
+    double activeMagnitude[FaultEvent::KindCount];
+    int injectedCount;
+
+    Battery* battery;
+    Cartridge* cartridge;
+    CGMSensorInterface* cgmSensor;
+    InsulinDeliveryManager* deliveryManager;
+};
+
+#endif // FAULTINJECTOR_H
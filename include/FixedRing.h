@@ -0,0 +1,49 @@
+/*
+FixedRing
+    - Purpose: Fixed-capacity record log that keeps the newest entries, for histories that must not
+      grow however long the simulation runs.
+    - Design Notes:
+        + Slots are held inline (no heap); Capacity must be a power of two. The write position
+          runs freely and is masked on access, so the total ever written is kept for free.
+        + push() hands back the slot to fill in place; when the ring is full that is the oldest
+          entry, so steady-state recording never allocates or shifts.
+        + Single-threaded and never refuses a write (unlike SpscRing, which hands samples across
+          threads and fails when full).
+        + Used by DoseLedger and AlertHistory.
+    - Class Overview:
+        + push() – Slot for the next entry (overwrites the oldest when full).
+        + size() / at(i) / latest() – Retained entries, oldest first.
+        + getTotalWritten() – Entries ever pushed, including overwritten ones.
+        + clear()
+*/
+
+#ifndef FIXEDRING_H
+#define FIXEDRING_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+template <typename T, std::size_t Capacity>
+class FixedRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    FixedRing() : slots(), written(0) {}
+
+    T& push() { return slots[written++ & (Capacity - 1)]; }
+    void clear() { written = 0; }
+
+    std::size_t size() const { return written < Capacity ? static_cast<std::size_t>(written) : Capacity; }
+    bool empty() const { return written == 0; }
+    std::uint64_t getTotalWritten() const { return written; }
+
+    const T& at(std::size_t index) const { return slots[(written - size() + index) & (Capacity - 1)]; }   // 0 = oldest
+    const T& latest() const { return slots[(written - 1) & (Capacity - 1)]; }                          // Requires !empty()
+
+private:
+    std::array<T, Capacity> slots;
+    std::uint64_t written;              // Next write position (runs freely)
+};
+
+#endif // FIXEDRING_H
@@ -0,0 +1,88 @@
+/*
+GlycemicMetrics
+    - Purpose: Scores a run's glycemic outcome while it runs, without storing the BG trace.
+    - Spec Refs:
+        + View Pump Info & History – Time in range and related outcome figures.
+    - Design Notes:
+        + O(1) memory: every statistic is a running count, sum or extreme.
+        + Mean and SD use Welford's update (numerically stable over long runs).
+        + Ranges follow the international consensus targets: in range 3.9-10.0 mmol/L,
+          below < 3.9, very low < 3.0, above > 10.0 (boundaries count as in range).
+        + GMI (%) = 3.31 + 0.02392 x mean glucose in mg/dL.
+        + LBGI/HBGI (Kovatchev): f = 1.509 (ln(BG mg/dL)^1.084 - 5.381), risk = 10 f^2, split by
+          the sign of f and averaged over all readings.
+        + Readings are weighted by the minutes they represent (one per tick by default), so the
+          percentages are time-based.
+        + Total daily insulin scales delivered insulin to 24 h of elapsed time. Elapsed minutes are
+          counted with the insulin, not with the readings, so CGM gaps (which still deliver
+          insulin) do not inflate it.
+    - Class Overview:
+        + addReading(bg, minutes) / addInsulin(units, minutes) / reset()
+        + getMean() / getSD() / getCV() / getGMI() / getMin() / getMax()
+        + getTimeInRangePct() / getTimeBelowPct() / getTimeVeryLowPct() / getTimeAbovePct()
+        + getLBGI() / getHBGI() / getTotalInsulin() / getTotalDailyInsulin()
+*/
+
+#ifndef GLYCEMICMETRICS_H
+#define GLYCEMICMETRICS_H
+
+class GlycemicMetrics {
+public:
+    static constexpr double kRangeLow = 3.9;      // mmol/L
+    static constexpr double kRangeHigh = 10.0;
+    static constexpr double kVeryLow = 3.0;
+
+    GlycemicMetrics();
+
+    void addReading(double bg, double minutes = 1.0);
+    void addInsulin(double units, double minutes = 1.0);   // Delivered over that many elapsed minutes
+    void reset();
+
+    long getCount() const { return count; }
+    double getMinutes() const { return minutes; }                 // Minutes covered by readings
+    double getElapsedMinutes() const { return elapsedMinutes; }   // Minutes covered by addInsulin()
+
+    double getMean() const { return count ? mean : 0.0; }
+    double getSD() const;                   // Sample standard deviation, mmol/L
+    double getCV() const;                   // Coefficient of variation, %
+    double getGMI() const;                  // Glucose management indicator, %
+    double getMin() const { return count ? minBG : 0.0; }
+    double getMax() const { return count ? maxBG : 0.0; }
+
+    double getTimeInRangePct() const { return percentOfTime(inRangeMinutes); }
+    double getTimeBelowPct() const { return percentOfTime(belowMinutes); }
+    double getTimeVeryLowPct() const { return percentOfTime(veryLowMinutes); }
+    double getTimeAbovePct() const { return percentOfTime(aboveMinutes); }
+
+    double getLBGI() const { return count ? lowRiskSum / count : 0.0; }
+    double getHBGI() const { return count ? highRiskSum / count : 0.0; }
+
+    double getTotalInsulin() const { return totalInsulin; }
+    double getTotalDailyInsulin() const;    // Units per 24 h of elapsed time
+
+private:
+    double percentOfTime(double part) const { return minutes > 0.0 ? 100.0 * part / minutes : 0.0; }
+
+    long count;
+    double minutes;
+
+    // Welford
+    double mean;
+    double m2;
+
+    double minBG;
+    double maxBG;
+
+    double inRangeMinutes;
+    double belowMinutes;
+    double veryLowMinutes;
+    double aboveMinutes;
+
+    double lowRiskSum;
+    double highRiskSum;
+
+    double totalInsulin;
+    double elapsedMinutes;
+};
+
+#endif // GLYCEMICMETRICS_H
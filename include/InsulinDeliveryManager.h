@@ -10,50 +10,122 @@ InsulinDeliveryManager
     - Design Notes:
         + Interfaces with Cartridge and Battery to simulate hardware.
         + Supports future Control IQ logic for predictive delivery.
-        + Tracks and executes extended bolus events based on simulation time.
+        + Every bolus arrives as a BolusRequest through submitBolus(), the one path that
+          validates, checks the cartridge and schedules splits.
+        + A plan is accepted only if the cartridge's unreserved insulin covers all of it. The
+          extended part is then reserved in the Cartridge and each split commits its share, so
+          scheduled splits cannot be starved by later boluses or basal. A split that still fails
+          (occlusion, leak) releases its share.
+        + Extended boluses live in a fixed set of slots (kMaxExtendedBoluses), each storing its
+          split plan rather than one entry per split, so submitting and delivering never allocate.
+        + submitBolusBatch() takes many requests (for one pump, or for many pumps at once via
+          PatientBolusRequest) without logging: each is validated, stably sorted by start time
+          into its pump's pending queue in one pass and given a status code. Queued boluses are
+          submitted by processPendingBoluses() at the start of the tick they fall due. The
+          newest final statuses are kept as BolusOutcomes in a FixedRing (getBolusOutcomes()),
+          and failures are also counted, so long runs keep flat memory and still know how many
+          queued boluses failed.
+        + Insulin is accounted in integer MicroUnits and delivered in whole 0.05 U strokes.
+          Boluses round down to a stroke; basal accrues exactly per millisecond and carries
+          sub-stroke remainders between ticks; extended splits distribute whole strokes so the
+          scheduled parts always sum to the requested remainder.
+        + Every delivered dose is appended to a DoseLedger with its time, type and source
+          (manual, Control-IQ or extended). Time comes from setSimulatedTime(), like the CGM.
+        + While the line is occluded (FaultInjector) strokes fail without drawing insulin; once
+          kOcclusionThreshold of insulin has been blocked the occlusion is detected and basal is
+          suspended. Basal cannot be started again until the line clears.
+        + With an event bus attached, IOB changes publish an IOBChangedEvent and occlusion
+          detection (and clearing) publishes an OcclusionEvent.
 */
 
 #ifndef INSULINDELIVERYMANAGER_H
 #define INSULINDELIVERYMANAGER_H
 
+#include "BolusRequest.h"
+#include "DoseLedger.h"
+#include "FixedRing.h"
+#include "InsulinUnits.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
 class BolusCalculator;
+class PumpEventBus;
 class Battery;
 class Cartridge;
 
-struct ExtendedDoseEvent {
-    double dose;
-    double scheduledTime; // In simulated minutes
+// Split plan of one extended bolus: every split gets baseDose, the first extraStrokeSplits one
+// more stroke, so the splits add up exactly to the extended amount
+struct ExtendedBolusSlot {
+    bool active = false;
+    MicroUnits baseDose = 0;
+    int extraStrokeSplits = 0;
+    int splits = 0;
+    int delivered = 0;
+    double startTime = 0.0;     // Simulated minutes
+    double interval = 0.0;      // Minutes between splits
 };
 
 class InsulinDeliveryManager {
+public:
+    static constexpr int kMaxExtendedBoluses = 4;
+    static constexpr std::size_t kMaxBolusOutcomes = 64;   // Power of two
+
 private:
     double currentBasalRate;
-    double insulinOnBoard;
+    MicroUnits insulinOnBoard;
     bool basalRunning;
     double previousBasalRate;
+    MicroUnits totalDelivered;      // Delivered since start (bolus, extended and basal)
+    MicroUnits basalPending;        // Accrued basal not yet delivered (below one stroke)
+    std::int64_t basalAccrualRem;   // Sub-microunit accrual remainder (uU*ms per hour)
+    DoseSource basalSource;         // Who set the running basal rate
+    double simulatedTime;           // Minutes; stamps ledger records
+    bool occluded;                  // Line blocked (fault), detected or not
+    bool occlusionDetected;
+    MicroUnits blockedSinceOcclusion;
+    std::uint64_t strokeCount;      // Motor strokes attempted (including blocked ones)
+
+    DoseLedger doseLedger;
 
     BolusCalculator* bolusCalculator;
     Battery* battery;
     Cartridge* cartridge;
+    PumpEventBus* eventBus;
+    MicroUnits publishedIOB;        // Last IOB published on the bus
+
+    std::array<ExtendedBolusSlot, kMaxExtendedBoluses> extendedSlots;
+    MicroUnits scheduledRemaining;  // Insulin reserved in the cartridge for queued splits
+
+    std::vector<BolusRequest> pendingBoluses;   // Sorted by startTime (always resolved)
+    std::size_t pendingHead;                    // First request not yet submitted
+    FixedRing<BolusOutcome, kMaxBolusOutcomes> bolusOutcomes;   // Newest final statuses of queued requests
+    std::uint64_t failedBolusOutcomes;          // Queued requests neither delivered nor scheduled
 
-    std::vector<ExtendedDoseEvent> extendedSchedule;
+    bool deliverFromCartridge(MicroUnits amount, DoseType type, DoseSource source, bool fromReservation = false);
+    void publishIOBIfChanged();
+    BolusStatus checkBatchRequest(const BolusRequest& request) const;
+    void queueSortedBoluses(const BolusRequest* sorted, std::size_t count);
 
 public:
+    static constexpr MicroUnits kOcclusionThreshold = 500000;   // 0.5 U of blocked strokes
+
     InsulinDeliveryManager();
     ~InsulinDeliveryManager();
 
-    void deliverBolus(double amount, bool extended, double duration = 0.0);
-    void deliverBolus(double totalDose, bool extended, double immediateAmount, double duration, int splits);
-    
-    // For CLI testing: supports simulation-time aware scheduling
-    void deliverBolus(double totalDose, bool extended, double immediateAmount, double duration, int splits, double currentSimTime);
-
-
+    BolusStatus submitBolus(const BolusRequest& request);
+    void submitBolusBatch(const BolusRequest* requests, std::size_t count, BolusStatus* statuses);
+    static void submitBolusBatch(const PatientBolusRequest* requests, std::size_t count, BolusStatus* statuses);
+    void processPendingBoluses(double currentSimTime);
+    std::size_t getPendingBolusCount() const;
+    const FixedRing<BolusOutcome, kMaxBolusOutcomes>& getBolusOutcomes() const;   // Oldest first
+    std::uint64_t getFailedBolusOutcomeCount() const;     // Since the last clear, including overwritten ones
+    void clearBolusOutcomes();
     void processScheduledExtendedDoses(double currentSimTime);
+    MicroUnits getScheduledBolusMicroUnits() const;  // Owed to extended splits not yet delivered
 
-    void startBasalDelivery(double rate);
+    void startBasalDelivery(double rate, DoseSource source = DoseSource::Manual);
     void stopBasalDelivery();
     void resumeBasalDelivery();
 
@@ -65,12 +137,22 @@ public:
     void setCurrentBasalRate(double rate);
     double getInsulinOnBoard() const;
     void setInsulinOnBoard(double iob);
+    double getTotalDelivered() const;
+    MicroUnits getTotalDeliveredMicroUnits() const;
+    const DoseLedger& getDoseLedger() const;
+    std::uint64_t getStrokeCount() const;
+    void setSimulatedTime(double minutes);
+
+    void setOccluded(bool blocked);                  // Fault hook; clearing also clears detection
+    bool isOcclusionDetected() const;
     bool isBasalRunning() const;
     void setBasalRunning(bool running);
 
     void setCartridge(Cartridge* cart);
     void setBolusCalculator(BolusCalculator* bc);
     void setBattery(Battery* bat);
+    void setEventBus(PumpEventBus* bus);
+    void publishState();
 };
 
 #endif // INSULINDELIVERYMANAGER_H
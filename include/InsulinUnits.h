@@ -0,0 +1,48 @@
+/*
+InsulinUnits
+    - Purpose: Exact integer accounting for insulin amounts.
+    - Design Notes:
+        + Amounts are held as MicroUnits (1 U = 1,000,000), so sums over weeks of tiny basal doses
+          are exact and comparisons need no tolerance.
+        + The pump mechanism delivers whole strokes of 0.05 U; delivery code rounds requests down to
+          a stroke and carries any sub-stroke remainder forward.
+        + Doubles remain the interface for settings and display (U, U/hr); conversions happen at
+          the edges with fromUnits()/toUnits().
+        + fromUnits() saturates at +/-kMaxUnits (NaN converts to 0), so no input can overflow the
+          conversion and the sum or difference of two converted amounts still fits in 64 bits.
+          Callers that take user input should still reject out-of-range amounts themselves.
+*/
+
+#ifndef INSULINUNITS_H
+#define INSULINUNITS_H
+
+#include <cmath>
+#include <cstdint>
+
+typedef std::int64_t MicroUnits;
+
+namespace InsulinUnits {
+
+const MicroUnits kMicroUnitsPerUnit = 1000000;
+const MicroUnits kStroke = 50000;                  // 0.05 U per pump stroke
+const double kMaxUnits = 1.0e12;                   // Saturation bound: 1e18 micro-units (int64 holds 9.2e18)
+
+inline MicroUnits fromUnits(double units) {
+    if (std::isnan(units))
+        return 0;
+    units = units > kMaxUnits ? kMaxUnits : (units < -kMaxUnits ? -kMaxUnits : units);
+    return static_cast<MicroUnits>(std::llround(units * kMicroUnitsPerUnit));
+}
+
+inline double toUnits(MicroUnits amount) {
+    return static_cast<double>(amount) / kMicroUnitsPerUnit;
+}
+
+// Largest whole number of strokes not exceeding amount (amount >= 0)
+inline MicroUnits floorToStroke(MicroUnits amount) {
+    return amount - amount % kStroke;
+}
+
+}
+
+#endif // INSULINUNITS_H
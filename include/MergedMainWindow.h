@@ -13,11 +13,15 @@
 QT_CHARTS_USE_NAMESPACE
 
 #include "PumpSimulator.h"
+#include "SimulationSnapshot.h"
+#include "BGHistory.h"
 
 class QTimer;
 class QLabel;
 class QWidget;
 class QStackedWidget;
+class QComboBox;
+class QPushButton;
 
 class DataLogger;
 class Profile;
@@ -30,6 +34,7 @@ class Battery;
 class Cartridge;
 class ControlIQController;
 class AlertManager;
+class SimulationWorker;
 
 class MergedMainWindow : public QMainWindow
 {
@@ -40,9 +45,18 @@ public:
     ~MergedMainWindow();
 
 private slots:
-    void onSimulationTick();
+    void onFrameTick();
 
 private:
+    // Render latest simulation state (GUI thread only)
+    void applySnapshot(const SimulationSnapshot& snapshot, const SimulationSnapshot* previous);
+    void drainBGSamples();
+
+    // Time-warp controls (row under the clock)
+    QWidget* setupTimeWarpControls();
+    void setSimulationSpeed(int index);
+    void togglePause();
+
     // Home Page
     void setupHomePage();
     void showHomePage();
@@ -54,6 +68,8 @@ private:
     // BG Graph Page
     void setupBGGraphPage();
     void showBGGraphPage();
+    void refreshBGChart();
+    void changeBGZoom(int step);
 
     // Pump 
     void setupPumpPage();
@@ -102,9 +118,18 @@ private:
 
     QStackedWidget* stackedWidget = nullptr;
     QLabel* simTimeLabel = nullptr;
-    QTimer* simulationTimer = nullptr;
+    QTimer* frameTimer = nullptr;
+    QComboBox* speedCombo = nullptr;
+    QPushButton* pauseButton = nullptr;
+    QPushButton* stepButton = nullptr;
     QTime simulationTime;
 
+    SimulationWorker* simulationWorker = nullptr;
+    SimulationSnapshot lastSnapshot;
+    bool snapshotApplied = false;        // lastSnapshot has been shown at least once
+    std::uint64_t lastAlarmSequence = 0;
+    bool alarmPopupOpen = false;
+
     QLabel* iobLabel = nullptr;
     QLabel* bgLabel = nullptr;
 
@@ -137,6 +162,11 @@ private:
     QWidget* bgGraphPage = nullptr;
     QChartView* chartView = nullptr;
     QLineSeries* bgSeries = nullptr;
+    QLabel* bgZoomLabel = nullptr;
+    QLabel* bgMetricsLabel = nullptr;
+    BGHistory bgHistory;                 // Whole-session BG, fixed memory
+    int bgZoomIndex = 0;                 // Index into the zoom window table
+    bool bgChartDirty = false;
 };
 
 #endif // MERGEDMAINWINDOW_H
@@ -0,0 +1,78 @@
+/*
+ParameterSweep
+    - Purpose: Explores profile settings (ICR, correction factor, target BG, basal scale) for one
+      scenario and reports glycemic outcomes per setting, replacing trial and error in the GUI.
+    - Design Notes:
+        + Points come from a full grid over the axes or from a Latin hypercube (each axis split
+          into `samples` strata, one sample per stratum, strata shuffled independently per axis).
+        + Every point is run with the same list of CGM seeds (common random numbers): the meal
+          timeline and the noise stream are identical across points, so differences between
+          points reflect the parameters rather than the luck of the draw.
+        + All point x seed runs go through ScenarioRunner::runAll, which spreads them over threads.
+        + Per point: mean and SD of time in range across seeds, mean time below/above range,
+          mean BG, lowest BG seen and the share of seeds reaching severe hypoglycemia (< 3.0).
+    - Class Overview:
+        + SweepAxis::parse("icr=5:20:7") – Axis from a command-line spec; ranges must be finite and
+          positive (ICR and CF divide in the calculator), with at most 1000 grid steps.
+        + ParameterSweep::makePoints(config) – Grid or Latin-hypercube design.
+        + ParameterSweep::run(config) – Runs the design, returns per-point statistics.
+        + ParameterSweep::writeCsv(out, results)
+*/
+
+#ifndef PARAMETERSWEEP_H
+#define PARAMETERSWEEP_H
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "Scenario.h"
+
+struct SweepAxis {
+    enum Parameter { InsulinToCarbRatio, CorrectionFactor, TargetBG, BasalScale };
+
+    Parameter parameter = InsulinToCarbRatio;
+    double min = 0.0;
+    double max = 0.0;
+    int steps = 1;              // Grid only; Latin hypercube uses SweepConfig::samples
+
+    static bool parse(const std::string& spec, SweepAxis& out);   // "name=min:max[:steps]"
+};
+
+struct SweepPoint {
+    double insulinToCarbRatio;
+    double correctionFactor;
+    double targetBG;
+    double basalScale;
+};
+
+struct SweepConfig {
+    Scenario base;
+    std::vector<SweepAxis> axes;
+    bool latinHypercube = false;
+    int samples = 32;                 // Latin-hypercube points
+    int seedsPerPoint = 16;
+    unsigned int designSeed = 1;      // Latin-hypercube shuffles; CGM seeds derive from base.seed
+    int jobs = 1;
+};
+
+struct SweepPointResult {
+    SweepPoint point;
+    int runs = 0;
+    double timeInRangeMean = 0.0;
+    double timeInRangeSD = 0.0;
+    double timeBelowMean = 0.0;
+    double timeAboveMean = 0.0;
+    double meanBG = 0.0;
+    double lowestBG = 0.0;
+    double severeHypoPct = 0.0;       // % of seeds with any BG < 3.0 mmol/L
+};
+
+class ParameterSweep {
+public:
+    static std::vector<SweepPoint> makePoints(const SweepConfig& config);
+    static std::vector<SweepPointResult> run(const SweepConfig& config);
+    static void writeCsv(std::ostream& out, const std::vector<SweepPointResult>& results);
+};
+
+#endif // PARAMETERSWEEP_H
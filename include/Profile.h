@@ -4,6 +4,7 @@ Profile
     - Spec Refs: Use Case - Manage Personal Profiles (CRUD); Project Spec Section 3 (Insulin Delivery Settings)
     - Design Notes: 
         + Stores time-based basal segments and key bolus parameters (IC ratio, correction factor, target BG).
+        + Carries its own alert thresholds (AlertSettings); defaults apply until they are edited.
         + Validated via isValid() before being used in calculations.
     - Class Overview:
         + isValid() – Validates the profile’s fields and basal segments.
@@ -16,6 +17,7 @@ Profile
 
 #include <string>
 #include <vector>
+#include "AlertSettings.h"
 #include "BasalSegment.h"
 
 class Profile {
@@ -25,6 +27,7 @@ private:
     double insulinToCarbRatio;   // Grams of carbs covered by 1 unit of insulin
     double correctionFactor;     // BG drop per unit of insulin
     double targetBG;             // Target blood glucose level (mmol/L)
+    AlertSettings alertSettings; // Per-profile alert thresholds
 
 public:
     Profile();
@@ -45,6 +48,9 @@ public:
     double getTargetBG() const;
     void setTargetBG(double bg);
 
+    const AlertSettings& getAlertSettings() const;
+    void setAlertSettings(const AlertSettings& settings);
+
     const std::vector<BasalSegment*>& getBasalSegments() const;
     void addBasalSegment(BasalSegment* segment);
 };
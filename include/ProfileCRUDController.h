@@ -5,6 +5,7 @@ ProfileCRUDController
     - Design Notes:
         + Uses ProfileManager to handle business logic.
         + Creates a default basal segment from 0 to 24h at 1.0 U/hr (can be refined via UI later).
+        + Every change is persisted incrementally through ProfileManager's store (if attached).
     - Class Overview:
         + createProfile() – Creates a profile with initial values and default basal.
         + updateProfile() – Updates profile fields (name, ratios, targets).
@@ -5,27 +5,53 @@ ProfileManager
     - Design Notes:
         + Handles profile creation, retrieval, update, deletion, and active profile selection.
         + Deletes old profiles when replaced or removed to manage memory.
+        + Optionally backed by a ProfileStore: stored profiles are only decoded when first
+          looked up, and every change is appended to the store as it happens.
+        + Profile objects are only touched by the GUI/authoring side. Simulation code reads the
+          active profile through immutable ProfileSnapshots (RCU style): edits stage a new snapshot
+          and the simulator publishes it at the next tick boundary with an atomic pointer swap.
     - Class Overview:
         + createProfile() – Adds a new validated profile.
-        + getProfileByName(name) – Looks up profile by name.
+        + getProfileByName(name) – Looks up profile by name (loads it from the store if needed).
         + updateProfile() – Replaces a profile with same name.
+        + commitProfileEdit() – Persists a profile that was edited in place.
         + deleteProfile() – Removes and deletes profile.
         + setActiveProfile(name) – Sets current active profile.
+        + setProfileStore(store) – Attaches persistent storage and restores the active profile.
+        + getActiveSnapshot() – Lock-free read of the published active profile snapshot.
+        + publishStagedSnapshot() – Makes the latest edit visible (called once per tick).
 */
 
 #ifndef PROFILEMANAGER_H
 #define PROFILEMANAGER_H
 
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
 class Profile;
+class ProfileSnapshot;
+class ProfileStore;
 
 class ProfileManager {
 private:
     std::vector<Profile*> profiles;     // All stored profiles
     Profile* activeProfile;             // Currently selected profile in use
 
+    ProfileStore* profileStore;         // Optional persistence (not owned)
+    std::vector<std::string> pendingNames; // Stored profiles not yet decoded
+
+    // Copy-on-write snapshots of the active profile (accessed with std::atomic_load/store)
+    std::shared_ptr<const ProfileSnapshot> stagedSnapshot;    // Latest edit, not yet visible
+    std::shared_ptr<const ProfileSnapshot> publishedSnapshot; // What simulation readers see
+    std::uint64_t snapshotVersion;
+    bool publishAtTickBoundary;
+
+    Profile* loadPendingProfile(const std::string& name);
+    void dropPendingName(const std::string& name);
+    void restageActiveSnapshot();
+
 public:
     ProfileManager();
     ~ProfileManager();
@@ -33,12 +59,21 @@ public:
     void createProfile(Profile* newProfile);              // Add a new profile
     Profile* getProfileByName(const std::string& name);   // Lookup by name
     void updateProfile(Profile* updatedProfile);          // Replace profile if exists
+    void commitProfileEdit(Profile* profile, const std::string& previousName); // Persist in-place edit
     void deleteProfile(const std::string& name);          // Delete by name
 
     Profile* getActiveProfile() const;                    // Get active profile
     void setActiveProfile(const std::string& profileName);// Set active by name
 
-    std::vector<Profile*> getAllProfiles() const;         // Return all profiles
+    std::vector<Profile*> getAllProfiles();               // Return all profiles (loads pending ones)
+    std::vector<std::string> getProfileNames() const;     // Names only, no decoding
+
+    void setProfileStore(ProfileStore* store);
+    ProfileStore* getProfileStore() const;
+
+    std::shared_ptr<const ProfileSnapshot> getActiveSnapshot() const; // Safe from any thread
+    bool publishStagedSnapshot();                         // Returns true if a new snapshot became visible
+    void setPublishAtTickBoundary(bool deferred);         // false = edits publish immediately
 };
 
 #endif // PROFILEMANAGER_H
@@ -0,0 +1,57 @@
+/*
+ProfileSnapshot
+    - Purpose: Immutable copy of a Profile that simulation code can read without locking.
+    - Spec Refs:
+        + Manage Personal Profiles (CRUD) – Edits produce a new snapshot instead of mutating a shared one.
+        + Deliver Manual Bolus / Control IQ Auto Adjustments – Readers use the snapshot's parameters.
+    - Design Notes:
+        + Built by ProfileManager (copy-on-write) whenever the active profile changes.
+        + Handed out as std::shared_ptr<const ProfileSnapshot>; a reader keeps its snapshot alive
+          for as long as it holds the pointer, so a concurrent edit can never change it mid-tick.
+        + Basal segments are stored by value so the snapshot shares nothing with the Profile.
+        + Version increases with every published edit (useful as a cache key).
+    - Class Overview:
+        + fromProfile() – Builds a snapshot from the current state of a Profile.
+        + getBasalRateForTime(hour) – Same lookup as Profile.
+        + Read-only getters mirroring Profile.
+*/
+
+#ifndef PROFILESNAPSHOT_H
+#define PROFILESNAPSHOT_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "AlertSettings.h"
+#include "BasalSegment.h"
+
+class Profile;
+
+class ProfileSnapshot {
+private:
+    std::string name;
+    std::vector<BasalSegment> basalSegments;
+    double insulinToCarbRatio;
+    double correctionFactor;
+    double targetBG;
+    AlertSettings alertSettings;
+    std::uint64_t version;
+
+    ProfileSnapshot();
+
+public:
+    static std::shared_ptr<const ProfileSnapshot> fromProfile(const Profile& profile, std::uint64_t version);
+
+    double getBasalRateForTime(double hour) const;
+
+    const std::string& getName() const;
+    double getInsulinToCarbRatio() const;
+    double getCorrectionFactor() const;
+    double getTargetBG() const;
+    const AlertSettings& getAlertSettings() const;
+    const std::vector<BasalSegment>& getBasalSegments() const;
+    std::uint64_t getVersion() const;
+};
+
+#endif // PROFILESNAPSHOT_H
@@ -0,0 +1,93 @@
+/*
+ProfileStore
+    - Purpose: Persists personal profiles between launches in a compact, versioned binary file.
+    - Spec Refs: Use Case - Manage Personal Profiles (CRUD)
+    - Design Notes:
+        + File is an 8-byte header ("IPPS", format version) followed by an append-only record log.
+        + Each record is a fixed 12-byte header (kind, name length, payload length, checksum),
+          the profile name and, for upserts, the encoded profile fields, basal segments and
+          (format version 2) the alert thresholds. Version 1 upserts, which end after the
+          segments, still load with default alert thresholds.
+        + open() memory-maps the file and checksums every record while building a name index.
+          Validation is therefore not lazy: open() costs one sequential pass over the whole file
+          (FNV-1a, no decoding or allocation per record), which is what lets it tell a torn tail
+          from mid-file damage and refuse unverified delete/active records. Decoding and profile
+          field validation are deferred until a profile is actually loaded, and loadProfile()
+          trusts the checksum already verified at open() (or the record it appended itself).
+        + A damaged record at the end of the file is a torn append and is truncated away. Damage
+          followed by intact records is not repaired: open() fails and leaves the file as it is,
+          so no valid profile is ever dropped and no unverified delete/active record is applied.
+        + Create/update/delete/active changes are appended as single records, so edits never
+          rewrite the whole file. Superseded records are dropped by compaction on open.
+        + JSON import/export is provided for human-readable backup and exchange.
+        + Host byte order is little-endian (x86/ARM Linux targets), so fields are stored as-is.
+    - Class Overview:
+        + open(path) – Maps an existing store (or creates an empty one) and indexes it.
+        + getProfileNames() – Names of live profiles in file order (no decoding).
+        + loadProfile(name) – Decodes and validates one profile on demand.
+        + appendProfile() / appendDelete() / appendActive() – Incremental persistence.
+        + exportJson() / importJson() – JSON exchange path.
+*/
+
+#ifndef PROFILESTORE_H
+#define PROFILESTORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Profile;
+
+class ProfileStore {
+public:
+    static const std::uint16_t kFormatVersion = 2;
+
+    ProfileStore();
+    ~ProfileStore();
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const;
+
+    std::vector<std::string> getProfileNames() const;
+    bool hasProfile(const std::string& name) const;
+    Profile* loadProfile(const std::string& name);        // Caller owns the returned profile
+    std::string getActiveProfileName() const;
+
+    bool appendProfile(const Profile* profile);
+    bool appendDelete(const std::string& name);
+    bool appendActive(const std::string& name);
+
+    static bool exportJson(const std::string& path, const std::vector<Profile*>& profiles,
+                           const std::string& activeName);
+    static std::vector<Profile*> importJson(const std::string& path, std::string* activeName = nullptr);
+
+private:
+    struct RecordRef {
+        std::size_t offset;   // Start of record header within the file
+        std::size_t length;   // Header + name + payload
+    };
+
+    std::size_t recordLengthAt(std::size_t offset) const;
+    bool indexRecords();
+    bool compact();
+    bool ensureMapped(std::size_t endOffset);
+    bool appendRecord(std::uint8_t kind, const std::string& name, const std::string& payload,
+                      std::size_t* recordOffset = nullptr);
+    void unmap();
+
+    std::string path;
+    int fd;
+    const unsigned char* mapped;
+    std::size_t mappedSize;            // Length passed to mmap (munmap needs the same)
+    std::size_t fileSize;
+
+    std::unordered_map<std::string, RecordRef> index;   // Latest upsert per live profile
+    std::vector<std::string> order;                      // Live names in first-seen order
+    std::string activeName;
+    std::size_t deadRecords;                             // Superseded records (compaction hint)
+};
+
+#endif // PROFILESTORE_H
@@ -0,0 +1,52 @@
+/*
+PumpEvents
+    - Purpose: State-change events published by the pump subsystems, and the bus that carries them.
+    - Spec Refs:
+        + Handle Pump Malfunction – Battery, cartridge, occlusion and sensor signal changes.
+        + View Pump Info & History – BG, IOB, battery and cartridge changes for display.
+    - Design Notes:
+        + Events are small plain structs carrying the new value, published only on change.
+          Work that is due at a given time uses PumpSimulator's SimScheduler instead.
+        + PumpEventBus is a class (not a typedef) so headers can forward-declare it.
+        + PumpSimulator owns the bus and attaches it to the subsystems it is given; the subsystems
+          publish through setEventBus() and publishState() re-sends their current values.
+*/
+
+#ifndef PUMPEVENTS_H
+#define PUMPEVENTS_H
+
+#include "CGMTrend.h"
+#include "EventBus.h"
+#include "InsulinUnits.h"
+
+struct BGReadingEvent {
+    double bg;                  // mmol/L, as reported by the CGM
+    int minute;                 // Simulated minute of the reading
+    double slope;               // mmol/L per minute over the CGMTrend window (0 without a trend)
+    TrendArrow trend;           // TrendArrow::None until the sensor has enough readings
+};
+
+struct CGMSignalEvent {
+    bool available;
+};
+
+struct IOBChangedEvent {
+    MicroUnits iob;
+};
+
+struct BatteryLevelEvent {
+    int level;                  // %
+};
+
+struct CartridgeVolumeEvent {
+    MicroUnits volume;
+};
+
+struct OcclusionEvent {
+    bool detected;
+};
+
+class PumpEventBus : public EventBus<BGReadingEvent, CGMSignalEvent, IOBChangedEvent, BatteryLevelEvent,
+                                     CartridgeVolumeEvent, OcclusionEvent> {};
+
+#endif // PUMPEVENTS_H
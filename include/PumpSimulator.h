@@ -1,6 +1,12 @@
 #ifndef PUMPSIMULATOR_H
 #define PUMPSIMULATOR_H
 
+#include "GlycemicMetrics.h"
+#include "InsulinUnits.h"
+#include "PumpEvents.h"
+#include "SimScheduler.h"
+#include "TickProfiler.h"
+
 class ProfileManager;
 class BolusCalculator;
 class InsulinDeliveryManager;
@@ -9,6 +15,9 @@ class ControlIQController;
 class AlertManager;
 class Battery;
 class Cartridge;
+class TraceRecorder;
+class FaultInjector;
+struct SimulationSnapshot;
 
 class PumpSimulator {
 private:
@@ -31,9 +40,48 @@ private:
     int guiSimulatedMinutes = 0;       // For GUI
     bool cliMode = false;
 
+    // Per-subsystem tick latency (timers compiled out unless PUMP_ENABLE_TICK_PROFILING)
+    TickProfiler tickProfiler;
+
+    // Outcome metrics, updated every tick and reset by startSimulation()
+    GlycemicMetrics glycemicMetrics;
+    MicroUnits lastDeliveredTotal = 0;
+
+    // Optional hardware/sensor fault campaign (not owned)
+    FaultInjector* faultInjector = nullptr;
+
+    // Optional timeline export (not owned; nullptr = tracing off)
+    TraceRecorder* traceRecorder = nullptr;
+
+    // State-change events. The setters attach the bus to the subsystems (and AlertManager to the
+    // bus); the displayed values below follow the events instead of being read every tick.
+    PumpEventBus eventBus;
+    double observedBG = 0.0;
+    double observedSlope = 0.0;
+    TrendArrow observedTrend = TrendArrow::None;
+    MicroUnits observedIOB = 0;
+    int observedBatteryLevel = 0;
+    MicroUnits observedCartridgeVolume = 0;
+
+    // Timers on the simulated clock (alert escalation, snooze, deadlines), run at the start of
+    // every tick; setAlertManager() attaches it to the manager. The simulator does not own the
+    // manager and never touches it on destruction, so the manager must be detached
+    // (setAlertManager(nullptr)) or destroyed before the simulator.
+    SimScheduler scheduler;
+
+    // ControlIQ only runs on ticks with a new CGM reading: a timer set for the sensor's next
+    // reading minute marks the controller due, and the tick runs it after the reading is taken
+    SimScheduler::TimerId controllerTimer = SimScheduler::kNoTimer;
+    bool controllerDue = false;
+    std::uint64_t controllerRuns = 0;
+    void scheduleControllerWake(int minute);
+
+    void recordTraceCounters();
+
+    void distributeProfileSnapshot();
+
 public:
     PumpSimulator();
-    ~PumpSimulator();
 
     void startSimulation();
     void stopSimulation();
@@ -73,6 +121,32 @@ public:
     double getCurrentBG() const;
     double getIOB() const;
 
+    void captureSnapshot(SimulationSnapshot& out) const; // Copies current state for display
+
+    PumpEventBus& getEventBus() { return eventBus; }
+    SimScheduler& getScheduler() { return scheduler; }
+    void onTimer(int tag);
+    std::uint64_t getControllerRunCount() const { return controllerRuns; }
+    void onEvent(const BGReadingEvent& event) {
+        observedBG = event.bg;
+        observedSlope = event.slope;
+        observedTrend = event.trend;
+    }
+    void onEvent(const IOBChangedEvent& event) { observedIOB = event.iob; }
+    void onEvent(const BatteryLevelEvent& event) { observedBatteryLevel = event.level; }
+    void onEvent(const CartridgeVolumeEvent& event) { observedCartridgeVolume = event.volume; }
+
+    TickProfiler& getTickProfiler() { return tickProfiler; }
+    const TickProfiler& getTickProfiler() const { return tickProfiler; }
+
+    const GlycemicMetrics& getGlycemicMetrics() const { return glycemicMetrics; }
+
+    void setFaultInjector(FaultInjector* injector) { faultInjector = injector; }
+    FaultInjector* getFaultInjector() const { return faultInjector; }
+
+    void setTraceRecorder(TraceRecorder* recorder) { traceRecorder = recorder; }
+    TraceRecorder* getTraceRecorder() const { return traceRecorder; }
+
 };
 
 #endif // PUMPSIMULATOR_H
@@ -19,16 +19,38 @@ public:
     PumpTester();
     ~PumpTester();
 
-    void runAllTests();
+    bool runAllTests();                 // True when every check passed
     void testManualBolus();
     void testExtendedBolus();
     void testBasalControl();
 
     void testIOBDecayWithExtendedBolus();
+    void testBatchBolusCalculator();
+    void testLatencyHistogram();
+    void testGlycemicMetrics();
+    void testBatteryActivity();
+    void testBolusValidation();
+    void testBatchBolusOutcomes();
+    void testCartridgeReservations();
+    void testDoseLedger();
+    void testSimScheduler();
+    void testEventBus();
+    void testAlertTiming();
+    void testCGMTrend();
+    void testCGMSensorModel();
+    void testBGHistory();
+    void testTraceRecorder();
+    void testProfileStore();
+    void testScenarios();
+    void testParameterSweep();
+    void testAlertRules();
 
 private:
     void simulateTime(double minutes);
     void printHeader(const std::string& title);
+    bool check(bool condition, const std::string& what);
+
+    int failures;
 
     // Core components
     PumpSimulator* simulator;
@@ -0,0 +1,97 @@
+/*
+Scenario
+    - Purpose: Declarative description of a headless simulation run, loaded from a text file.
+    - Design Notes:
+        + One directive per line; '#' starts a comment. Header directives describe the patient
+          and profile, "at <minute> ..." lines form the event timeline:
+              name      breakfast-large
+              duration  1440                # simulated minutes (default one day)
+              seed      42                  # CGM noise seed (default 1)
+              bg        7.5                 # starting BG, mmol/L
+              icr 10 / cf 2 / target 6      # profile settings
+              segment   0 24 0.8            # basal segment: start hour, end hour, U/hr
+              at 480 meal 60                # carbs, grams
+              at 480 bolus 6                # immediate bolus, units
+              at 480 mealbolus 60           # carbs + calculator-recommended bolus
+              at 540 correction             # calculator correction bolus (no carbs)
+              at 600 extended 6 2 120 4     # total, immediate, duration min, splits
+              at 720 basal 1.2 | basal stop | basal resume
+              at 900 fault battery 5 | fault cartridge 0 | fault bg 2.8
+              at 960 fault occlusion 120              # timed faults: duration (min) [magnitude]
+              at 960 fault cgm-dropout 45 | fault compression 60 3 | fault battery-sag 20 30
+              at 960 fault leak 90 1.5                # U/hr lost from the cartridge
+              random-faults 4                         # Poisson fault campaign, faults per day
+              cgm-cadence 5 / cgm-latency 10          # sensor reading interval and lag (min)
+              cgm-drift 3                             # calibration gain drift, % per day
+              at 720 calibrate                        # fingerstick calibration (clears drift)
+        + Timed and random faults are not applied as events; the runner precomputes them into a
+          FaultInjector schedule before the run starts.
+        + Events are kept sorted by minute (stable, so same-minute events keep file order).
+        + Parsing reports the first error with its line number and leaves the scenario unusable.
+          Values the runner converts to integers (durations, cadence, seed, carbs, splits, battery
+          level) are range-checked here, so an out-of-range number is an error, not a wrap.
+    - Class Overview:
+        + Scenario::loadFile(path, out, error) / Scenario::parse(text, out, error)
+*/
+
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include <string>
+#include <vector>
+
+struct ScenarioEvent {
+    enum Type {
+        Meal,            // a = grams
+        Bolus,           // a = units
+        MealBolus,       // a = grams; dose from BolusCalculator with the active profile
+        Correction,      // dose from BolusCalculator for the current BG, no carbs
+        ExtendedBolus,   // a = total, b = immediate, c = duration (min), d = splits
+        BasalRate,       // a = U/hr
+        BasalStop,
+        BasalResume,
+        FaultBattery,    // a = level (%)
+        FaultCartridge,  // a = volume (U)
+        FaultBG,         // a = BG (mmol/L)
+        FaultOcclusion,  // a = duration (min)
+        FaultCGMDropout, // a = duration (min)
+        FaultCompression,// a = duration (min), b = depth (mmol/L)
+        FaultBatterySag, // a = duration (min), b = sag (%)
+        FaultLeak,       // a = duration (min), b = U/hr
+        Calibrate
+    };
+
+    int minute = 0;
+    Type type = Meal;
+    double a = 0.0, b = 0.0, c = 0.0, d = 0.0;
+};
+
+struct ScenarioSegment {
+    double startHour;
+    double endHour;
+    double unitsPerHour;
+};
+
+struct Scenario {
+    std::string name;
+    int durationMinutes = 24 * 60;
+    unsigned int seed = 1;
+    double initialBG = 6.0;
+
+    double insulinToCarbRatio = 10.0;
+    double correctionFactor = 2.0;
+    double targetBG = 6.0;
+    std::vector<ScenarioSegment> basalSegments;   // Empty = one 0.8 U/hr segment all day
+    double randomFaultsPerDay = 0.0;              // 0 = only the faults listed as events
+
+    int cgmCadenceMinutes = 5;
+    int cgmLatencyMinutes = 0;
+    double cgmDriftPctPerDay = 0.0;
+
+    std::vector<ScenarioEvent> events;            // Sorted by minute
+
+    static bool parse(const std::string& text, Scenario& out, std::string* error = nullptr);
+    static bool loadFile(const std::string& path, Scenario& out, std::string* error = nullptr);
+};
+
+#endif // SCENARIO_H
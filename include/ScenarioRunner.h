@@ -0,0 +1,68 @@
+/*
+ScenarioRunner
+    - Purpose: Executes Scenarios headlessly at full speed and summarises each run.
+    - Design Notes:
+        + Every run builds its own simulator and subsystems, so runs share no state and can
+          execute on parallel threads. CGM noise is seeded from the scenario, making results
+          reproducible.
+        + Events for minute M are applied just before tick M; mealbolus/correction doses come from
+          BolusCalculator with the scenario profile. Basal follows the profile segments
+          (the rate changes when the segment changes); "basal <rate>" sets a temporary rate until
+          the next segment boundary.
+        + Timed faults and the random-faults campaign (seeded from the scenario seed) are
+          precomputed into a FaultInjector schedule before the first tick.
+        + Fixed-dose bolus and extended events are queued with one submitBolusBatch() call
+          before the first tick and submitted at the start of their minute. Minutes that also
+          carry other events are not batched, so same-minute events keep file order.
+        + Bolus requests that end up neither delivered nor scheduled (rejected at submission or
+          failed when their queued minute came) are counted in failedBoluses.
+        + Outcomes come from the simulator's streaming GlycemicMetrics (no trace is stored).
+        + The runner does not touch std::cout; callers that want quiet runs redirect it once
+          before starting.
+    - Class Overview:
+        + run(scenario) – One run, on the calling thread.
+        + runAll(scenarios, jobs) – Runs on `jobs` threads; results keep the input order.
+        + writeSummaryCsv(out, results) – One CSV row per run.
+*/
+
+#ifndef SCENARIORUNNER_H
+#define SCENARIORUNNER_H
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "Scenario.h"
+
+struct ScenarioResult {
+    std::string name;
+    int minutes = 0;
+    double finalBG = 0.0;
+    double meanBG = 0.0;
+    double sdBG = 0.0;
+    double cvPct = 0.0;
+    double gmiPct = 0.0;
+    double minBG = 0.0;
+    double maxBG = 0.0;
+    double timeInRangePct = 0.0;     // 3.9-10.0 mmol/L
+    double timeBelowPct = 0.0;       // < 3.9 mmol/L
+    double timeVeryLowPct = 0.0;     // < 3.0 mmol/L
+    double timeAbovePct = 0.0;       // > 10.0 mmol/L
+    double lbgi = 0.0;
+    double hbgi = 0.0;
+    double insulinDelivered = 0.0;   // Units (bolus, extended and basal)
+    double totalDailyInsulin = 0.0;  // Units per 24 h
+    unsigned long long alarms = 0;
+    int faults = 0;                  // Injected hardware/sensor faults
+    int failedBoluses = 0;           // Bolus requests neither delivered nor scheduled
+    double wallMs = 0.0;
+};
+
+class ScenarioRunner {
+public:
+    static ScenarioResult run(const Scenario& scenario);
+    static std::vector<ScenarioResult> runAll(const std::vector<Scenario>& scenarios, int jobs);
+    static void writeSummaryCsv(std::ostream& out, const std::vector<ScenarioResult>& results);
+};
+
+#endif // SCENARIORUNNER_H
@@ -0,0 +1,83 @@
+/*
+SimScheduler
+    - Purpose: Timers on the simulated clock, for work that falls due at a given minute instead of
+      being checked every tick.
+    - Spec Refs:
+        + Handle Pump Malfunction – Alert escalation, snooze and sensor-silence deadlines.
+    - Design Notes:
+        + Binary min-heap in a fixed-capacity array, ordered by due minute and then by scheduling
+          order (timers due together fire first-scheduled first). schedule() and firing a timer
+          are O(log n); a tick with nothing due costs one comparison. No heap allocation.
+        + A timer is the owner pointer, a plain function pointer instantiated for the owner type
+          that calls owner->onTimer(tag), and an integer tag the owner uses to tell its timers
+          apart (the same dispatch as EventBus).
+        + Ids come from a counter that is never reused, so cancelling a timer that already fired
+          is a harmless no-op rather than cancelling someone else's. cancel() finds the entry by a
+          scan of at most kMaxTimers and removes it in O(log n). cancelAll() filters the array and
+          rebuilds the heap in O(n).
+        + runDue(minute) advances now() and fires everything due at or before it, in due order.
+          A callback may schedule or cancel timers, including ones due in the same pass.
+        + PumpSimulator owns the scheduler and runs it at the start of every tick. Not thread-safe;
+          it belongs to the simulation thread.
+    - Class Overview:
+        + schedule(dueMinute, owner, tag) – Returns the timer id, or kNoTimer if the heap is full.
+        + cancel(id) / cancelAll(owner) – Removes pending timers.
+        + runDue(minute) – Fires due timers.
+        + now() / getPendingCount() – Current simulated minute and pending timer count.
+*/
+
+#ifndef SIMSCHEDULER_H
+#define SIMSCHEDULER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+class SimScheduler {
+public:
+    using TimerId = std::uint32_t;
+    static constexpr TimerId kNoTimer = 0;
+    static constexpr std::size_t kMaxTimers = 64;
+
+    SimScheduler();
+
+    template <typename Owner>
+    TimerId schedule(int dueMinute, Owner* owner, int tag) {
+        return push(dueMinute, owner, &fire<Owner>, tag);
+    }
+
+    bool cancel(TimerId id);
+    void cancelAll(const void* owner);
+
+    void runDue(int minute);
+
+    int now() const { return currentMinute; }
+    std::size_t getPendingCount() const { return count; }
+
+private:
+    struct Timer {
+        int due;
+        TimerId id;                     // Also the tie-break: ids increase with scheduling order
+        void* owner;
+        void (*call)(void*, int);
+        int tag;
+    };
+
+    template <typename Owner>
+    static void fire(void* owner, int tag) {
+        static_cast<Owner*>(owner)->onTimer(tag);
+    }
+
+    TimerId push(int dueMinute, void* owner, void (*call)(void*, int), int tag);
+    void removeAt(std::size_t index);
+    void siftUp(std::size_t index);
+    void siftDown(std::size_t index);
+    static bool earlier(const Timer& a, const Timer& b);
+
+    std::array<Timer, kMaxTimers> heap;
+    std::size_t count;
+    TimerId nextId;
+    int currentMinute;
+};
+
+#endif // SIMSCHEDULER_H
@@ -0,0 +1,52 @@
+/*
+SimulationSnapshot
+    - Purpose: Compact copy of the pump state after a simulation tick, for display on another thread.
+    - Spec Refs:
+        + View Pump Info & History – BG, IOB, recent doses, battery, cartridge, outcome metrics and alert status.
+        + Handle Pump Malfunction – Carries the latest raised alarm so the GUI can notify the user.
+    - Design Notes:
+        + Plain data only (no heap members) so it can be copied into a TripleBuffer slot cheaply.
+        + alarmSequence increases every time an alarm is raised; the GUI compares it to decide
+          whether to show a popup, and uses alarmId to snooze that alarm from it.
+*/
+
+#ifndef SIMULATIONSNAPSHOT_H
+#define SIMULATIONSNAPSHOT_H
+
+#include "CGMTrend.h"
+#include "DoseLedger.h"
+#include <cstdint>
+
+struct SimulationSnapshot {
+    std::uint64_t tick = 0;          // Number of ticks simulated so far
+    int simMinute = 0;               // Simulated minutes since start
+
+    double bg = 0.0;                 // mmol/L
+    double bgSlope = 0.0;            // mmol/L per minute (CGMTrend)
+    TrendArrow bgTrend = TrendArrow::None;
+    double iob = 0.0;                // Units
+    double basalRate = 0.0;          // U/hr
+    bool basalRunning = false;
+
+    int batteryLevel = 0;            // %
+    double cartridgeVolume = 0.0;    // Units
+
+    // Outcome so far (GlycemicMetrics)
+    double timeInRangePct = 0.0;
+    double timeBelowPct = 0.0;
+    double meanBG = 0.0;
+    double cvPct = 0.0;
+    double gmiPct = 0.0;
+
+    // Most recent deliveries from the DoseLedger, oldest first
+    static const int kRecentDoses = 16;
+    DoseRecord recentDoses[kRecentDoses];
+    int recentDoseCount = 0;
+
+    int activeAlarmCount = 0;
+    std::uint64_t alarmSequence = 0;
+    char alarmMessage[128] = {};     // Message of the most recently raised alarm
+    char alarmId[24] = {};           // Its alarm id
+};
+
+#endif // SIMULATIONSNAPSHOT_H
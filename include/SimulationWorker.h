@@ -0,0 +1,96 @@
+/*
+SimulationWorker
+    - Purpose: Runs PumpSimulator ticks on a dedicated thread so the GUI never waits on simulation work.
+    - Spec Refs:
+        + View Pump Info & History – Publishes a SimulationSnapshot after every tick batch for display.
+        + Deliver Manual Bolus, Start/Stop Basal – GUI actions are queued and run between ticks.
+    - Design Notes:
+        + The worker thread is the only thread that touches simulation objects once started.
+        + Snapshots go through a lock-free TripleBuffer; the GUI polls it at its own frame rate.
+        + Every tick's BG reading is also pushed to an SpscRing so the graph misses nothing when
+          many ticks run per frame.
+        + Time warp: at speed N one tick runs every baseInterval / N; ticks that fall due together
+          run as one batch and only the batch end is published. Speed 0 means "as fast as possible"
+          (continuous batches). Batches are capped so queued GUI commands still run promptly.
+        + Commands from the GUI wake the worker immediately and run before the next tick.
+        + invoke() runs a command and waits for it (for reads that need a consistent result);
+          post() is fire-and-forget.
+    - Class Overview:
+        + start(intervalMs) / stop() – Thread lifecycle (stop joins). intervalMs is the 1x tick period.
+        + setSpeed(multiplier) / pause() / resume() / step() – Time-warp controls.
+        + post(fn) / invoke(fn) – Queue work onto the simulation thread.
+        + pollSnapshot() / latestSnapshot() – GUI-side access to the newest published state.
+        + drainBGSamples(fn) – GUI-side access to every BG reading since the last drain.
+*/
+
+#ifndef SIMULATIONWORKER_H
+#define SIMULATIONWORKER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "BGHistory.h"
+#include "SimulationSnapshot.h"
+#include "SpscRing.h"
+#include "TripleBuffer.h"
+
+class PumpSimulator;
+
+class SimulationWorker {
+private:
+    static const int kMaxTicksPerBatch = 512;
+
+    PumpSimulator* simulator;
+    TripleBuffer<SimulationSnapshot> snapshots;
+    SpscRing<BGPoint, 65536> bgSamples;
+    std::atomic<unsigned long long> droppedSamples;
+
+    std::thread thread;
+    std::mutex commandMutex;
+    std::condition_variable wake;
+    std::vector<std::function<void()>> commands;
+    std::atomic<bool> running;
+
+    // Time warp (guarded by commandMutex; rescheduled flags a change for the loop)
+    int baseIntervalMs;
+    int speed;              // Multiplier of real time; 0 = maximum speed
+    bool paused;
+    bool rescheduled;
+
+    int tickCount;
+
+    void run();
+    void tick();
+    void publishSnapshot();
+
+public:
+    explicit SimulationWorker(PumpSimulator* sim);
+    ~SimulationWorker();
+
+    void start(int intervalMs);
+    void stop();
+    bool isRunning() const;
+
+    void setSpeed(int multiplier);
+    int getSpeed();
+    void pause();
+    void resume();
+    bool isPaused();
+    void step();                                       // Runs exactly one tick (intended while paused)
+
+    void post(std::function<void()> command);
+    void invoke(const std::function<void()>& command);
+
+    bool pollSnapshot();                               // GUI thread: true if a newer snapshot arrived
+    const SimulationSnapshot& latestSnapshot() const;  // GUI thread: last polled snapshot
+
+    template <typename Fn>
+    std::size_t drainBGSamples(Fn&& fn) { return bgSamples.consumeAll(fn); }
+    unsigned long long getDroppedSampleCount() const { return droppedSamples; }
+};
+
+#endif // SIMULATIONWORKER_H
@@ -0,0 +1,57 @@
+/*
+SpscRing
+    - Purpose: Fixed-capacity single-producer/single-consumer queue for streaming per-tick samples
+      from the simulation thread to the GUI without locks or allocation.
+    - Spec Refs:
+        + View Pump Info & History – Every BG reading reaches the graph even when many ticks run per frame.
+    - Design Notes:
+        + Capacity must be a power of two; indices run freely and are masked on access.
+        + push() fails (returns false) when full instead of overwriting, so the consumer never
+          sees a half-written slot; the producer decides what to do with the sample.
+        + consumeAll() drains everything currently queued in one pass.
+*/
+
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <atomic>
+#include <cstddef>
+
+template <typename T, std::size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+private:
+    T slots[Capacity];
+    std::atomic<std::size_t> head;   // Next slot to read (consumer)
+    std::atomic<std::size_t> tail;   // Next slot to write (producer)
+
+public:
+    SpscRing() : slots(), head(0), tail(0) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer
+    bool push(const T& value) {
+        std::size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == Capacity)
+            return false;
+        slots[t & (Capacity - 1)] = value;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer: calls fn(const T&) for every queued item, returns how many were consumed
+    template <typename Fn>
+    std::size_t consumeAll(Fn&& fn) {
+        std::size_t h = head.load(std::memory_order_relaxed);
+        std::size_t t = tail.load(std::memory_order_acquire);
+        for (std::size_t i = h; i != t; ++i)
+            fn(slots[i & (Capacity - 1)]);
+        head.store(t, std::memory_order_release);
+        return t - h;
+    }
+};
+
+#endif // SPSCRING_H
@@ -0,0 +1,126 @@
+/*
+TickProfiler
+    - Purpose: Measures where simulation tick time goes, per subsystem, with low overhead.
+    - Design Notes:
+        + Each stage of PumpSimulator::updateSimulationState() is wrapped in PUMP_TICK_SCOPE, which
+          records the elapsed steady_clock nanoseconds into that stage's LatencyHistogram.
+        + LatencyHistogram is HDR-style log-linear: values below 64 ns get exact buckets, above that
+          each power of two is split into 32 sub-buckets (~3% relative precision). Recording is an
+          index computation and an increment; memory is fixed (~10 KB per stage).
+        + Timers compile to nothing unless PUMP_ENABLE_TICK_PROFILING is defined
+          (qmake: CONFIG+=tick_profiling). The profiler object and its API always exist, so callers
+          need no #ifdefs; with profiling off the histograms simply stay empty.
+        + Single-threaded: recorded and read on the simulation thread (use SimulationWorker::invoke
+          to read it from the GUI).
+        + endTick() dumps a p50/p99/max table every dumpInterval ticks (0 disables the periodic dump).
+    - Class Overview:
+        + LatencyHistogram::record(ns) / percentile(p) / getMax() / getCount() / reset()
+        + TickProfiler::record(stage, ns), getHistogram(stage), percentile(stage, p), getMax(stage)
+        + TickProfiler::endTick() / setDumpInterval(ticks) / dump(out) / reset()
+*/
+
+#ifndef TICKPROFILER_H
+#define TICKPROFILER_H
+
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+
+class LatencyHistogram {
+public:
+    static const int kSubBucketBits = 5;                       // 32 sub-buckets per power of two
+    static const int kSubBucketCount = 1 << kSubBucketBits;
+    static const int kMaxValueBits = 42;                       // ~73 minutes in ns; larger values clamp
+    static const int kBucketCount = (kMaxValueBits - kSubBucketBits + 1) * kSubBucketCount;
+
+    LatencyHistogram();
+
+    void record(std::uint64_t value);
+    void reset();
+
+    std::uint64_t getCount() const { return count; }
+    std::uint64_t getMin() const { return count ? minValue : 0; }
+    std::uint64_t getMax() const { return maxValue; }
+    double getMean() const { return count ? static_cast<double>(sum) / count : 0.0; }
+    std::uint64_t percentile(double p) const;                 // p in [0, 100]; bucket upper bound
+
+private:
+    static int bucketIndex(std::uint64_t value);
+    static std::uint64_t bucketUpperBound(int index);
+
+    std::uint64_t counts[kBucketCount];
+    std::uint64_t count;
+    std::uint64_t sum;
+    std::uint64_t minValue;
+    std::uint64_t maxValue;
+};
+
+class TickProfiler {
+public:
+    enum Stage {
+        Timers,
+        Faults,
+        Battery,
+        DeliveryTick,
+        CGMReading,
+        ControlIQ,
+        ExtendedDoses,
+        Total,
+        StageCount
+    };
+
+    TickProfiler();
+
+    void record(Stage stage, std::uint64_t nanoseconds);
+    void endTick();                                           // Counts a tick; dumps on the interval
+    void reset();
+
+    const LatencyHistogram& getHistogram(Stage stage) const { return histograms[stage]; }
+    std::uint64_t percentile(Stage stage, double p) const { return histograms[stage].percentile(p); }
+    std::uint64_t getMax(Stage stage) const { return histograms[stage].getMax(); }
+    std::uint64_t getTickCount() const { return ticks; }
+
+    void setDumpInterval(int tickInterval) { dumpInterval = tickInterval; }
+    int getDumpInterval() const { return dumpInterval; }
+    void dump(std::ostream& out) const;
+
+    static const char* stageName(Stage stage);
+    static bool isCompiledIn();
+
+private:
+    LatencyHistogram histograms[StageCount];
+    std::uint64_t ticks;
+    int dumpInterval;
+};
+
+// RAII timer behind PUMP_TICK_SCOPE; records into the profiler when it goes out of scope
+class ScopedTickTimer {
+public:
+    ScopedTickTimer(TickProfiler& p, TickProfiler::Stage s)
+        : profiler(p), stage(s), start(std::chrono::steady_clock::now()) {}
+    ~ScopedTickTimer() {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        profiler.record(stage, static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+
+    ScopedTickTimer(const ScopedTickTimer&) = delete;
+    ScopedTickTimer& operator=(const ScopedTickTimer&) = delete;
+
+private:
+    TickProfiler& profiler;
+    TickProfiler::Stage stage;
+    std::chrono::steady_clock::time_point start;
+};
+
+#define PUMP_TICK_CONCAT_INNER(a, b) a##b
+#define PUMP_TICK_CONCAT(a, b) PUMP_TICK_CONCAT_INNER(a, b)
+
+#ifdef PUMP_ENABLE_TICK_PROFILING
+#define PUMP_TICK_SCOPE(profiler, stage) \
+    ScopedTickTimer PUMP_TICK_CONCAT(tickScope_, __LINE__)((profiler), TickProfiler::stage)
+#else
+#define PUMP_TICK_SCOPE(profiler, stage) ((void)0)
+#endif
+
+#endif // TICKPROFILER_H
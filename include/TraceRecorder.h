@@ -0,0 +1,116 @@
+/*
+TraceRecorder
+    - Purpose: Optional timeline of a simulation run, exported as Chrome trace-event JSON
+      (opens in chrome://tracing and ui.perfetto.dev).
+    - Design Notes:
+        + Each recording thread gets its own fixed-size ring of TraceEvents, created on first use
+          and found again through a thread_local cache, so recording takes no lock and never
+          allocates. When a ring is full the oldest events are overwritten (flight recorder).
+        + Spans are recorded as single "complete" events at scope exit (start + duration);
+          counters (BG, IOB, basal rate, cartridge volume) become counter tracks.
+        + Event names must be string literals (or otherwise outlive the recorder); only the
+          pointer is stored.
+        + Recording is switched on and off at runtime with setEnabled(); a disabled or null
+          recorder costs one branch per span.
+        + writeChromeTrace() reads every ring; call it after recording threads have stopped or
+          after setEnabled(false).
+    - Class Overview:
+        + setEnabled(bool) / isEnabled()
+        + setThreadName(name) – Labels the calling thread's track.
+        + recordSpan(name, startNs, durationNs, arg) / recordCounter(name, value)
+        + nowNs() – Timestamp on the recorder's clock.
+        + writeChromeTrace(path) / clear()
+        + TraceSpan / PUMP_TRACE_SPAN – RAII span helper.
+*/
+
+#ifndef TRACERECORDER_H
+#define TRACERECORDER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct TraceEvent {
+    const char* name;
+    char phase;                 // 'X' complete span, 'C' counter
+    std::uint64_t timestampNs;  // Since the recorder's epoch
+    std::uint64_t durationNs;   // Spans only
+    double value;               // Counter value, or span argument
+    bool hasValue;
+};
+
+class TraceRecorder {
+public:
+    static const std::size_t kDefaultEventsPerThread = 1 << 16;
+
+    explicit TraceRecorder(std::size_t eventsPerThread = kDefaultEventsPerThread);
+    ~TraceRecorder();
+
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    void setEnabled(bool enabled) { recording.store(enabled, std::memory_order_relaxed); }
+    bool isEnabled() const { return recording.load(std::memory_order_relaxed); }
+
+    void setThreadName(const std::string& name);
+
+    std::uint64_t nowNs() const;
+    void recordSpan(const char* name, std::uint64_t startNs, std::uint64_t durationNs);
+    void recordSpan(const char* name, std::uint64_t startNs, std::uint64_t durationNs, double arg);
+    void recordCounter(const char* name, double value);
+
+    bool writeChromeTrace(const std::string& path) const;
+    void clear();
+    std::size_t getEventCount() const;
+
+private:
+    struct ThreadBuffer {
+        std::vector<TraceEvent> ring;
+        std::uint64_t written = 0;   // Total events ever written (ring index = written % size)
+        std::string threadName;
+        std::thread::id owner;
+        int tid = 0;
+    };
+
+    ThreadBuffer& localBuffer();
+    void push(const TraceEvent& event);
+
+    const std::uint64_t id;          // Distinguishes recorders in the thread_local cache
+    const std::size_t eventsPerThread;
+    const std::chrono::steady_clock::time_point epoch;
+    std::atomic<bool> recording;
+
+    mutable std::mutex buffersMutex; // Guards the buffer list, not the events
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+};
+
+// RAII span; records nothing if the recorder is null or disabled when the span opens
+class TraceSpan {
+public:
+    TraceSpan(TraceRecorder* r, const char* n)
+        : recorder(r && r->isEnabled() ? r : nullptr), name(n), start(recorder ? recorder->nowNs() : 0) {}
+    ~TraceSpan() {
+        if (recorder)
+            recorder->recordSpan(name, start, recorder->nowNs() - start);
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    TraceRecorder* recorder;
+    const char* name;
+    std::uint64_t start;
+};
+
+#define PUMP_TRACE_CONCAT_INNER(a, b) a##b
+#define PUMP_TRACE_CONCAT(a, b) PUMP_TRACE_CONCAT_INNER(a, b)
+#define PUMP_TRACE_SPAN(recorder, name) TraceSpan PUMP_TRACE_CONCAT(traceSpan_, __LINE__)((recorder), (name))
+
+#endif // TRACERECORDER_H
@@ -0,0 +1,59 @@
+/*
+TripleBuffer
+    - Purpose: Hands the latest value from one producer thread to one consumer thread without locks.
+    - Spec Refs:
+        + View Pump Info & History – GUI reads per-tick pump state published by the simulation thread.
+    - Design Notes:
+        + Three slots: the writer owns one, the reader owns one, the third is the shared "middle".
+        + publish() swaps the writer's slot with the middle and marks it fresh; update() swaps the
+          middle into the reader if it is fresh. Both are a single atomic exchange.
+        + Neither side ever waits; intermediate values the reader did not pick up are overwritten.
+        + T should be cheap to copy/assign (plain data), since slots are reused.
+    - Class Overview:
+        + writeBuffer() / publish() – Producer side.
+        + update() / readBuffer() – Consumer side; update() returns true if a newer value arrived.
+*/
+
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+
+template <typename T>
+class TripleBuffer {
+private:
+    static const unsigned kIndexMask = 0x3;
+    static const unsigned kFreshBit = 0x4;
+
+    T buffers[3];
+    std::atomic<unsigned> middle;   // Index of shared slot + fresh flag
+    unsigned writeIndex;            // Producer-owned slot
+    unsigned readIndex;             // Consumer-owned slot
+
+public:
+    TripleBuffer() : buffers(), middle(1), writeIndex(0), readIndex(2) {}
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Producer: fill this slot, then call publish()
+    T& writeBuffer() { return buffers[writeIndex]; }
+
+    void publish() {
+        unsigned previous = middle.exchange(writeIndex | kFreshBit, std::memory_order_acq_rel);
+        writeIndex = previous & kIndexMask;
+    }
+
+    // Consumer: returns true if a value newer than readBuffer() was taken
+    bool update() {
+        if (!(middle.load(std::memory_order_relaxed) & kFreshBit))
+            return false;
+        unsigned previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & kIndexMask;
+        return true;
+    }
+
+    const T& readBuffer() const { return buffers[readIndex]; }
+};
+
+#endif // TRIPLEBUFFER_H
@@ -0,0 +1,35 @@
+#include "AlertHistory.h"
+#include <cstring>
+
+namespace {
+// Truncating copy that always terminates
+template <std::size_t N>
+void copyText(char (&dest)[N], const char* text) {
+    std::strncpy(dest, text ? text : "", N - 1);
+    dest[N - 1] = '\0';
+}
+}
+
+AlertHistory::AlertHistory() : records() {}
+
+void AlertHistory::record(int minute, AlertAction action, const char* alarmId, const char* severity,
+                          const char* message) {
+    AlertRecord& slot = records.push();
+    slot.minute = minute;
+    slot.action = action;
+    copyText(slot.alarmId, alarmId);
+    copyText(slot.severity, severity);
+    copyText(slot.message, message);
+}
+
+const char* AlertHistory::actionName(AlertAction action) {
+    switch (action) {
+        case AlertAction::Raised: return "Raised";
+        case AlertAction::Escalated: return "Escalated";
+        case AlertAction::Reminded: return "Reminded";
+        case AlertAction::Snoozed: return "Snoozed";
+        case AlertAction::Acknowledged: return "Acknowledged";
+        case AlertAction::Resolved: return "Resolved";
+    }
+    return "Unknown";
+}
@@ -2,89 +2,306 @@
 #include "Alarm.h"
 #include "Battery.h"
 #include "Cartridge.h"
-#include "Profile.h"
+#include "InsulinDeliveryManager.h"
+#include "CGMSensorInterface.h"
+#include "ProfileSnapshot.h"
+#include "PumpEvents.h"
+#include <cmath>
+#include <cstdio>
 #include <iostream>
-#include <sstream>
+#include <limits>
 
-#include <QMessageBox>
-#include <QApplication>
+namespace {
+// One level up; critical stays critical
+const char* escalatedSeverity(const std::string& severity) {
+    if (severity == "info") return "warning";
+    return "critical";
+}
+}
 
-AlertManager::AlertManager() : profile(nullptr) {}
+AlertManager::AlertManager()
+    : profile(), raisedCount(0), suppressedCount(0), rules(), scheduler(nullptr), signalLostSince(-1),
+      silenceTimer(SimScheduler::kNoTimer) {
+    lastValue.fill(std::numeric_limits<double>::quiet_NaN());
+}
 
 AlertManager::~AlertManager() {
-    for (Alarm* alarm : activeAlarms) {
-        delete alarm;
+    if (scheduler)
+        scheduler->cancelAll(this);
+    for (AlarmEntry& entry : alarms) {
+        delete entry.alarm;
     }
-    activeAlarms.clear();
+    alarms.clear();
 }
 
-// Raises "BAT_LOW" if battery level < 20%
+// Evaluates the battery rules against the current level
 void AlertManager::checkBattery(Battery* batt) {
     if (!batt) return;
-    int level = batt->getLevel();
-    if (level < 21) {
-        Alarm* alarm = new Alarm();
-        alarm->setAlarmId("BAT_LOW");
-        std::ostringstream msg;
-        msg << "Battery level is low: " << level << "%.";
-        alarm->setMessage(msg.str());
-        alarm->setSeverity("critical");
-        raiseAlarm(alarm);
-    }
+    evaluate(AlertSignal::BatteryLevel, batt->getLevel());
 }
 
-// Raises "CARTRIDGE_EMPTY" if insulin < 1.0 units
+// Evaluates the cartridge rules against the current volume
 void AlertManager::checkCartridge(Cartridge* cart) {
     if (!cart) return;
-    double volume = cart->getCurrentVolume();
-    if (volume < 20.0) {
-        Alarm* alarm = new Alarm();
-        alarm->setAlarmId("CARTRIDGE_EMPTY");
-        std::ostringstream msg;
-        msg << "Cartridge nearly empty: " << volume << " units remaining.";
-        alarm->setMessage(msg.str());
-        alarm->setSeverity("warning");
-        raiseAlarm(alarm);
+    evaluate(AlertSignal::CartridgeVolume, cart->getCurrentVolume());
+}
+
+// Raises "OCCLUSION" once blocked strokes have been detected (basal is already suspended)
+void AlertManager::checkOcclusion(InsulinDeliveryManager* delivery) {
+    if (!delivery) return;
+    if (delivery->isOcclusionDetected())
+        raiseOcclusion();
+}
+
+// Raises "CGM_SIGNAL_LOSS" while the sensor has no reading
+void AlertManager::checkCGM(CGMSensorInterface* cgm) {
+    if (!cgm) return;
+    if (!cgm->isReadingAvailable())
+        raiseSignalLoss();
+}
+
+// Same conditions, evaluated when the subsystems publish a change. All or nothing: a full
+// channel would silently drop that alert, so the manager backs out of the bus instead
+bool AlertManager::subscribeTo(PumpEventBus& bus) {
+    if (bus.subscribe<BatteryLevelEvent>(this) && bus.subscribe<CartridgeVolumeEvent>(this) &&
+        bus.subscribe<OcclusionEvent>(this) && bus.subscribe<CGMSignalEvent>(this) &&
+        bus.subscribe<BGReadingEvent>(this))
+        return true;
+    bus.unsubscribeAll(this);
+    std::cout << "[AlertManager] Event bus channel full; not subscribed.\n";
+    return false;
+}
+
+void AlertManager::onEvent(const BatteryLevelEvent& event) {
+    evaluate(AlertSignal::BatteryLevel, event.level);
+}
+
+void AlertManager::onEvent(const CartridgeVolumeEvent& event) {
+    evaluate(AlertSignal::CartridgeVolume, InsulinUnits::toUnits(event.volume));
+}
+
+// Level rules on every reading; rate rules once the sensor has a trend
+void AlertManager::onEvent(const BGReadingEvent& event) {
+    evaluate(AlertSignal::BG, event.bg);
+    if (event.trend != TrendArrow::None)
+        evaluate(AlertSignal::BGRate, event.slope);
+}
+
+void AlertManager::onEvent(const OcclusionEvent& event) {
+    if (event.detected)
+        raiseOcclusion();
+}
+
+void AlertManager::onEvent(const CGMSignalEvent& event) {
+    if (!event.available) {
+        raiseSignalLoss();
+        signalLostSince = now();
+        scheduleSilenceDeadline();
+    } else {
+        signalLostSince = -1;
+        if (scheduler)
+            scheduler->cancel(silenceTimer);
+        silenceTimer = SimScheduler::kNoTimer;
+        evaluate(AlertSignal::CGMSilence, 0.0);
     }
 }
 
-// Only raise a new alarm if it's not already active
-#include <QMessageBox>
-#include <QApplication> // for QWidget pointer to parent window
+void AlertManager::onTimer(int tag) {
+    if (tag == kSilenceTimerTag) {
+        silenceTimer = SimScheduler::kNoTimer;
+        if (signalLostSince >= 0) {
+            evaluate(AlertSignal::CGMSilence, now() - signalLostSince);
+            scheduleSilenceDeadline();
+        }
+        return;
+    }
+    std::size_t index = static_cast<std::size_t>(tag / kAlarmTimerKinds);
+    if (index >= alarms.size()) return;
+    if (tag % kAlarmTimerKinds == EscalationTimer)
+        escalate(index);
+    else
+        endSnooze(index);
+}
 
-void AlertManager::raiseAlarm(Alarm* alarm) {
-    // Avoid duplicates
-    for (auto a : activeAlarms) {
-        if (a->getAlarmId() == alarm->getAlarmId() && a->getIsActive()) {
+// Raises or resolves alarms for the rules of one signal that changed state
+void AlertManager::evaluate(AlertSignal signal, double value) {
+    lastValue[static_cast<std::size_t>(signal)] = value;
+    rules.evaluate(signal, value, [this](const AlertRule& rule, bool raised, double current) {
+        if (!raised) {
+            resolveAlarm(rule.id);
             return;
         }
+        char message[128];
+        std::snprintf(message, sizeof(message), rule.format, current);
+        Alarm* alarm = new Alarm();
+        alarm->setAlarmId(rule.id);
+        alarm->setMessage(message);
+        alarm->setSeverity(rule.severity);
+        raiseAlarm(alarm, rule.policy);
+    });
+}
+
+// The condition has cleared: deactivate without the acknowledgement log
+void AlertManager::resolveAlarm(const std::string& alarmId) {
+    AlarmEntry* entry = findEntry(alarmId);
+    if (!entry || !entry->alarm->getIsActive())
+        return;
+    entry->alarm->setIsActive(false);
+    cancelTimers(*entry);
+    history.record(now(), AlertAction::Resolved, alarmId.c_str(), entry->alarm->getSeverity().c_str(), "");
+    std::cout << "[Alert] Resolved: " << alarmId << "\n";
+}
+
+void AlertManager::raiseOcclusion() {
+    Alarm* alarm = new Alarm();
+    alarm->setAlarmId("OCCLUSION");
+    alarm->setMessage("Occlusion detected. Insulin delivery suspended.");
+    alarm->setSeverity("critical");
+    raiseAlarm(alarm, AlertPolicy{ 0, 0 });
+}
+
+void AlertManager::raiseSignalLoss() {
+    Alarm* alarm = new Alarm();
+    alarm->setAlarmId("CGM_SIGNAL_LOSS");
+    alarm->setMessage("CGM signal lost. Control-IQ is holding the current basal rate.");
+    alarm->setSeverity("warning");
+    raiseAlarm(alarm, AlertPolicy{ 30, 0 });
+}
+
+void AlertManager::raiseAlarm(Alarm* alarm) {
+    raiseAlarm(alarm, AlertPolicy());
+}
+
+// Only raise a new alarm if it's not already active; an inactive one is replaced by the new occurrence
+void AlertManager::raiseAlarm(Alarm* alarm, const AlertPolicy& policy) {
+    const std::string id = alarm->getAlarmId();
+    auto it = alarmIndex.find(id);
+    if (it == alarmIndex.end()) {
+        it = alarmIndex.emplace(id, alarms.size()).first;
+        alarms.push_back({ alarm, policy, now(), SimScheduler::kNoTimer, SimScheduler::kNoTimer });
+        announce(alarms.back(), AlertAction::Raised);
+        scheduleEscalation(it->second);
+        return;
+    }
+
+    AlarmEntry& entry = alarms[it->second];
+    // Avoid duplicates
+    if (entry.alarm->getIsActive()) {
+        delete alarm;
+        return;
     }
 
-    activeAlarms.push_back(alarm);
-    std::cout << "[Alert] Raised: " << alarm->getAlarmId() << " - " << alarm->getMessage() << "\n";
+    delete entry.alarm;
+    entry.alarm = alarm;
+    entry.policy = policy;
+    if (scheduler && now() - entry.lastAnnounced < policy.dedupMinutes) {
+        ++suppressedCount;            // Flapping: active again, but not announced again
+    } else {
+        entry.lastAnnounced = now();
+        announce(entry, AlertAction::Raised);
+    }
+    scheduleEscalation(it->second);
+}
+
+void AlertManager::announce(AlarmEntry& entry, AlertAction action) {
+    const Alarm* alarm = entry.alarm;
+    const char* label = action == AlertAction::Raised ? "Raised"
+                      : action == AlertAction::Escalated ? "Escalated"
+                      : "Reminder";
+    std::cout << "[Alert] " << label << ": " << alarm->getAlarmId() << " - " << alarm->getMessage();
+    if (action == AlertAction::Escalated)
+        std::cout << " (" << alarm->getSeverity() << ")";
+    std::cout << "\n";
+    history.record(now(), action, alarm->getAlarmId().c_str(), alarm->getSeverity().c_str(),
+                   alarm->getMessage().c_str());
 
-    // === SHOW POPUP ===
-    QString msg = QString::fromStdString(alarm->getMessage());
-    QMessageBox::warning(nullptr, "Pump Alert", msg);  // nullptr means no parent (system modal)
+    // Popup is shown by the GUI when it sees the raised count change
+    lastRaisedMessage = alarm->getMessage();
+    lastRaisedId = alarm->getAlarmId();
+    ++raisedCount;
 }
 
+void AlertManager::scheduleEscalation(std::size_t index) {
+    AlarmEntry& entry = alarms[index];
+    if (!scheduler || entry.policy.escalateMinutes <= 0 || entry.alarm->isCritical())
+        return;
+    scheduler->cancel(entry.escalationTimer);
+    entry.escalationTimer = scheduler->schedule(now() + entry.policy.escalateMinutes, this,
+                                                static_cast<int>(index) * kAlarmTimerKinds + EscalationTimer);
+}
+
+void AlertManager::cancelTimers(AlarmEntry& entry) {
+    if (scheduler) {
+        scheduler->cancel(entry.escalationTimer);
+        scheduler->cancel(entry.snoozeTimer);
+    }
+    entry.escalationTimer = SimScheduler::kNoTimer;
+    entry.snoozeTimer = SimScheduler::kNoTimer;
+}
+
+// Next silence threshold still ahead, measured from the minute the signal was lost
+void AlertManager::scheduleSilenceDeadline() {
+    if (scheduler)
+        scheduler->cancel(silenceTimer);
+    silenceTimer = SimScheduler::kNoTimer;
+    double threshold = 0.0;
+    if (!scheduler || signalLostSince < 0 || !rules.nextThreshold(AlertSignal::CGMSilence, threshold))
+        return;
+    int due = signalLostSince + static_cast<int>(std::ceil(threshold));
+    silenceTimer = scheduler->schedule(due, this, kSilenceTimerTag);
+}
+
+// Unacknowledged for the escalation delay: one severity level up, announced again
+void AlertManager::escalate(std::size_t index) {
+    AlarmEntry& entry = alarms[index];
+    entry.escalationTimer = SimScheduler::kNoTimer;
+    if (!entry.alarm->getIsActive())
+        return;
+    entry.alarm->setSeverity(escalatedSeverity(entry.alarm->getSeverity()));
+    announce(entry, AlertAction::Escalated);
+    scheduleEscalation(index);
+}
+
+void AlertManager::endSnooze(std::size_t index) {
+    AlarmEntry& entry = alarms[index];
+    entry.snoozeTimer = SimScheduler::kNoTimer;
+    if (!entry.alarm->getIsActive())
+        return;
+    announce(entry, AlertAction::Reminded);
+    scheduleEscalation(index);
+}
 
 // Acknowledge and deactivate an alarm by ID
 void AlertManager::clearAlarm(const std::string &alarmId) {
-    for (Alarm* alarm : activeAlarms) {
-        if (alarm->getAlarmId() == alarmId && alarm->getIsActive()) {
-            alarm->acknowledge();
-            std::cout << "[AlertManager] Alarm " << alarmId << " acknowledged and cleared.\n";
-            return;
-        }
+    AlarmEntry* entry = findEntry(alarmId);
+    if (entry && entry->alarm->getIsActive()) {
+        entry->alarm->acknowledge();
+        cancelTimers(*entry);
+        history.record(now(), AlertAction::Acknowledged, alarmId.c_str(), entry->alarm->getSeverity().c_str(), "");
+        std::cout << "[AlertManager] Alarm " << alarmId << " acknowledged and cleared.\n";
+        return;
     }
     std::cout << "[AlertManager] Alarm " << alarmId << " not found.\n";
 }
 
+// Keeps the alarm active but quiet: escalation is held off until the snooze ends
+bool AlertManager::snoozeAlarm(const std::string& alarmId, int minutes) {
+    AlarmEntry* entry = findEntry(alarmId);
+    if (!entry || !entry->alarm->getIsActive() || !scheduler || minutes <= 0)
+        return false;
+    cancelTimers(*entry);
+    entry->snoozeTimer = scheduler->schedule(now() + minutes, this,
+                                             static_cast<int>(entry - alarms.data()) * kAlarmTimerKinds + SnoozeTimer);
+    history.record(now(), AlertAction::Snoozed, alarmId.c_str(), entry->alarm->getSeverity().c_str(), "");
+    std::cout << "[AlertManager] Alarm " << alarmId << " snoozed for " << minutes << " min.\n";
+    return true;
+}
+
 // Print all currently active alarms
 void AlertManager::update() {
     std::cout << "[AlertManager] Updating alarms. Active alarms:\n";
-    for (Alarm* a : activeAlarms) {
+    for (const AlarmEntry& entry : alarms) {
+        const Alarm* a = entry.alarm;
         if (a->getIsActive()) {
             std::cout << "  Alarm ID: " << a->getAlarmId()
                       << ", Message: " << a->getMessage()
@@ -93,6 +310,74 @@ void AlertManager::update() {
     }
 }
 
-Profile* AlertManager::getProfile() const { return profile; }
-void AlertManager::setProfile(Profile* p) { profile = p; }
+int AlertManager::now() const { return scheduler ? scheduler->now() : 0; }
+
+AlertManager::AlarmEntry* AlertManager::findEntry(const std::string& alarmId) {
+    auto it = alarmIndex.find(alarmId);
+    return it == alarmIndex.end() ? nullptr : &alarms[it->second];
+}
+
+const Alarm* AlertManager::findAlarm(const std::string& alarmId) const {
+    auto it = alarmIndex.find(alarmId);
+    return it == alarmIndex.end() ? nullptr : alarms[it->second].alarm;
+}
+
+const AlertHistory& AlertManager::getHistory() const { return history; }
+
+int AlertManager::getActiveAlarmCount() const {
+    int count = 0;
+    for (const AlarmEntry& entry : alarms)
+        if (entry.alarm->getIsActive())
+            ++count;
+    return count;
+}
 
+unsigned long long AlertManager::getRaisedCount() const { return raisedCount; }
+unsigned long long AlertManager::getSuppressedCount() const { return suppressedCount; }
+std::string AlertManager::getLastRaisedMessage() const { return lastRaisedMessage; }
+std::string AlertManager::getLastRaisedId() const { return lastRaisedId; }
+
+SimScheduler* AlertManager::getScheduler() const { return scheduler; }
+// Timers belong to the scheduler they were set on; moving drops them (active alarms stay active)
+void AlertManager::setScheduler(SimScheduler* s) {
+    if (scheduler)
+        scheduler->cancelAll(this);
+    for (AlarmEntry& entry : alarms) {
+        entry.escalationTimer = SimScheduler::kNoTimer;
+        entry.snoozeTimer = SimScheduler::kNoTimer;
+    }
+    silenceTimer = SimScheduler::kNoTimer;
+    scheduler = s;
+    scheduleSilenceDeadline();
+}
+
+std::shared_ptr<const ProfileSnapshot> AlertManager::getProfileSnapshot() const { return profile; }
+// A new snapshot may carry new thresholds. The table is rebuilt (rules that are up stay up) and
+// the last known values are re-evaluated against it, so the change applies straight away.
+void AlertManager::setProfileSnapshot(std::shared_ptr<const ProfileSnapshot> snapshot) {
+    bool changed = snapshot != profile;
+    profile = snapshot;
+    if (!changed)
+        return;
+
+    std::array<const char*, AlertRuleTable::kMaxRules> wasActive {};
+    std::size_t activeCount = 0;
+    for (std::size_t i = 0; i < rules.getRuleCount(); ++i)
+        if (rules.getRule(i).active)
+            wasActive[activeCount++] = rules.getRule(i).id;
+
+    rules.compile(profile ? profile->getAlertSettings() : AlertSettings());
+    for (std::size_t s = 0; s < lastValue.size(); ++s) {
+        AlertSignal signal = static_cast<AlertSignal>(s);
+        if (signal != AlertSignal::CGMSilence && !std::isnan(lastValue[s]))
+            evaluate(signal, lastValue[s]);
+    }
+    if (signalLostSince >= 0)
+        evaluate(AlertSignal::CGMSilence, now() - signalLostSince);    // Silence keeps growing
+
+    // Rules switched off in the new settings no longer exist to clear their alarms
+    for (std::size_t a = 0; a < activeCount; ++a)
+        if (!rules.isActive(wasActive[a]))
+            resolveAlarm(wasActive[a]);
+    scheduleSilenceDeadline();
+}
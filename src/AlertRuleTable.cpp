@@ -0,0 +1,94 @@
+#include "AlertRuleTable.h"
+#include <cstring>
+
+namespace {
+// Distance from the raise threshold a value must move back before the alert clears
+const double kBatteryHysteresisPct = 2.0;
+const double kCartridgeHysteresisUnits = 5.0;
+const double kBGHysteresis = 0.5;
+const double kRateHysteresis = 0.05;
+
+// Deduplication window and escalation delay (minutes) per alarm. Critical alarms cannot escalate.
+const AlertPolicy kBatteryPolicy { 60, 0 };
+const AlertPolicy kCartridgePolicy { 60, 60 };
+const AlertPolicy kBGLowPolicy { 15, 0 };
+const AlertPolicy kBGHighPolicy { 30, 60 };
+const AlertPolicy kBGRatePolicy { 15, 0 };
+const AlertPolicy kCGMStalePolicy { 30, 30 };
+}
+
+AlertRuleTable::AlertRuleTable() : rules(), count(0), signalStart() {
+    compile(AlertSettings());
+}
+
+// Rules are added grouped by signal so each signal's rules form one contiguous range
+void AlertRuleTable::compile(const AlertSettings& settings) {
+    std::array<const char*, kMaxRules> wasActive {};
+    std::size_t activeCount = 0;
+    for (std::size_t i = 0; i < count; ++i)
+        if (rules[i].active)
+            wasActive[activeCount++] = rules[i].id;
+    count = 0;
+
+    add(AlertSignal::BatteryLevel, "BAT_LOW", "critical", "Battery level is low: %g%%.",
+        true, settings.batteryLowPct, kBatteryHysteresisPct, kBatteryPolicy);
+    add(AlertSignal::CartridgeVolume, "CARTRIDGE_EMPTY", "warning", "Cartridge nearly empty: %g units remaining.",
+        true, settings.cartridgeLowUnits, kCartridgeHysteresisUnits, kCartridgePolicy);
+    if (settings.bgLow > 0.0)
+        add(AlertSignal::BG, "BG_LOW", "critical", "Low glucose: %.1f mmol/L.",
+            true, settings.bgLow, kBGHysteresis, kBGLowPolicy);
+    if (settings.bgHigh > 0.0)
+        add(AlertSignal::BG, "BG_HIGH", "warning", "High glucose: %.1f mmol/L.",
+            false, settings.bgHigh, kBGHysteresis, kBGHighPolicy);
+    if (settings.bgFallRate > 0.0)
+        add(AlertSignal::BGRate, "BG_FALLING", "warning", "Glucose falling fast: %.2f mmol/L per minute.",
+            true, -settings.bgFallRate, kRateHysteresis, kBGRatePolicy);
+    if (settings.bgRiseRate > 0.0)
+        add(AlertSignal::BGRate, "BG_RISING", "info", "Glucose rising fast: %.2f mmol/L per minute.",
+            false, settings.bgRiseRate, kRateHysteresis, kBGRatePolicy);
+    if (settings.cgmStaleMinutes > 0.0)
+        add(AlertSignal::CGMSilence, "CGM_STALE", "warning", "No CGM reading for %g minutes.",
+            false, settings.cgmStaleMinutes, 0.0, kCGMStalePolicy);
+
+    std::size_t rule = 0;
+    for (std::size_t s = 0; s <= static_cast<std::size_t>(AlertSignal::Count); ++s) {
+        while (rule < count && static_cast<std::size_t>(rules[rule].signal) < s)
+            ++rule;
+        signalStart[s] = rule;
+    }
+
+    for (std::size_t i = 0; i < count; ++i)
+        for (std::size_t a = 0; a < activeCount; ++a)
+            if (std::strcmp(rules[i].id, wasActive[a]) == 0)
+                rules[i].active = true;
+}
+
+void AlertRuleTable::add(AlertSignal signal, const char* id, const char* severity, const char* format,
+                         bool below, double raiseAt, double hysteresis, AlertPolicy policy) {
+    if (count == kMaxRules)
+        return;
+    double clearAt = below ? raiseAt + hysteresis : raiseAt - hysteresis;
+    rules[count++] = { id, severity, format, signal, below, raiseAt, clearAt, false, policy };
+}
+
+// Only meaningful for at-or-above rules; at-or-below rules are skipped
+bool AlertRuleTable::nextThreshold(AlertSignal signal, double& raiseAt) const {
+    std::size_t s = static_cast<std::size_t>(signal);
+    bool found = false;
+    for (std::size_t i = signalStart[s]; i < signalStart[s + 1]; ++i) {
+        const AlertRule& rule = rules[i];
+        if (rule.below || rule.active)
+            continue;
+        if (!found || rule.raiseAt < raiseAt)
+            raiseAt = rule.raiseAt;
+        found = true;
+    }
+    return found;
+}
+
+bool AlertRuleTable::isActive(const char* id) const {
+    for (std::size_t i = 0; i < count; ++i)
+        if (std::strcmp(rules[i].id, id) == 0)
+            return rules[i].active;
+    return false;
+}
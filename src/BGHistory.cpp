@@ -0,0 +1,192 @@
+#include "BGHistory.h"
+#include <algorithm>
+#include <cmath>
+
+BGHistory::BGHistory(std::size_t capacity, int levelCount, int decimationFactor)
+    : levelCapacity(std::max<std::size_t>(capacity, 4)),
+      decimation(std::max(decimationFactor, 2)) {
+    levels.resize(static_cast<std::size_t>(std::max(levelCount, 1)));
+    for (Level& level : levels)
+        level.ring.resize(levelCapacity);
+}
+
+void BGHistory::Level::push(const BGPoint& p) {
+    ring[head] = p;
+    head = (head + 1) % ring.size();
+    if (count < ring.size())
+        ++count;
+}
+
+const BGPoint& BGHistory::Level::at(std::size_t i) const {
+    return ring[(head + ring.size() - count + i) % ring.size()];
+}
+
+// Index of the first retained point with minute >= the given minute
+std::size_t BGHistory::Level::lowerBound(double minute) const {
+    std::size_t lo = 0, hi = count;
+    while (lo < hi) {
+        std::size_t mid = (lo + hi) / 2;
+        if (at(mid).minute < minute)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+// Adds a raw reading and rolls completed groups up into the coarser levels
+void BGHistory::append(double minute, double bg) {
+    BGPoint p = { minute, bg };
+    levels[0].push(p);
+    if (levels.size() > 1)
+        feed(1, p, p);
+}
+
+// Accumulates one group from level (levelIndex - 1); emits a min/max pair when `decimation` groups are in
+void BGHistory::feed(std::size_t levelIndex, const BGPoint& groupMin, const BGPoint& groupMax) {
+    Level& level = levels[levelIndex];
+
+    if (level.pendingGroups == 0) {
+        level.pendingMin = groupMin;
+        level.pendingMax = groupMax;
+    } else {
+        if (groupMin.bg < level.pendingMin.bg) level.pendingMin = groupMin;
+        if (groupMax.bg > level.pendingMax.bg) level.pendingMax = groupMax;
+    }
+
+    if (++level.pendingGroups < decimation)
+        return;
+
+    // Keep the pair in time order so the line is drawn left to right
+    const BGPoint& first = (level.pendingMin.minute <= level.pendingMax.minute) ? level.pendingMin : level.pendingMax;
+    const BGPoint& second = (&first == &level.pendingMin) ? level.pendingMax : level.pendingMin;
+    level.push(first);
+    if (second.minute != first.minute || second.bg != first.bg)
+        level.push(second);
+
+    BGPoint emittedMin = level.pendingMin;
+    BGPoint emittedMax = level.pendingMax;
+    level.pendingGroups = 0;
+
+    if (levelIndex + 1 < levels.size())
+        feed(levelIndex + 1, emittedMin, emittedMax);
+}
+
+// Collects points for [fromMinute, toMinute] from the finest level that covers it, capped at maxPoints
+void BGHistory::query(double fromMinute, double toMinute, std::size_t maxPoints, std::vector<BGPoint>& out) const {
+    out.clear();
+    if (empty() || toMinute < fromMinute) return;
+
+    // Finest level that still retains fromMinute and is not far denser than requested
+    std::size_t chosen = levels.size() - 1;
+    for (std::size_t l = 0; l < levels.size(); ++l) {
+        const Level& level = levels[l];
+        if (level.count == 0) continue;
+        bool covers = level.at(0).minute <= fromMinute || level.count < level.ring.size();
+        std::size_t inRange = level.count - level.lowerBound(fromMinute);
+        if (covers && (inRange <= maxPoints * 4 || l + 1 == levels.size())) {
+            chosen = l;
+            break;
+        }
+    }
+
+    std::vector<BGPoint> points;
+    double lastTaken = fromMinute;
+    bool haveAny = false;
+
+    // Coarse level first, then newer points from finer levels that have not been rolled up yet
+    for (std::size_t l = chosen + 1; l-- > 0;) {
+        const Level& level = levels[l];
+        std::size_t i = level.lowerBound(haveAny ? std::nextafter(lastTaken, toMinute + 1.0) : fromMinute);
+        for (; i < level.count; ++i) {
+            const BGPoint& p = level.at(i);
+            if (p.minute > toMinute) break;
+            points.push_back(p);
+            lastTaken = p.minute;
+            haveAny = true;
+        }
+    }
+
+    if (maxPoints >= 3 && points.size() > maxPoints)
+        downsampleLTTB(points, maxPoints, out);
+    else
+        out.swap(points);
+}
+
+void BGHistory::clear() {
+    for (Level& level : levels) {
+        level.head = 0;
+        level.count = 0;
+        level.pendingGroups = 0;
+    }
+}
+
+bool BGHistory::empty() const {
+    return levels[0].count == 0;
+}
+
+// Oldest retained minute across all levels (coarsest level reaches furthest back)
+double BGHistory::firstMinute() const {
+    double first = lastMinute();
+    for (const Level& level : levels)
+        if (level.count > 0)
+            first = std::min(first, level.at(0).minute);
+    return first;
+}
+
+double BGHistory::lastMinute() const {
+    return empty() ? 0.0 : levels[0].at(levels[0].count - 1).minute;
+}
+
+// Largest-Triangle-Three-Buckets: keeps first/last points and the most "visually significant" one per bucket
+void BGHistory::downsampleLTTB(const std::vector<BGPoint>& in, std::size_t threshold, std::vector<BGPoint>& out) {
+    out.clear();
+    if (threshold >= in.size() || threshold < 3) {
+        out = in;
+        return;
+    }
+
+    out.reserve(threshold);
+    out.push_back(in.front());
+
+    const double bucketSize = static_cast<double>(in.size() - 2) / static_cast<double>(threshold - 2);
+    std::size_t a = 0;
+
+    for (std::size_t bucket = 0; bucket < threshold - 2; ++bucket) {
+        // Average of the next bucket is the third triangle vertex
+        std::size_t nextStart = static_cast<std::size_t>((bucket + 1) * bucketSize) + 1;
+        std::size_t nextEnd = std::min(static_cast<std::size_t>((bucket + 2) * bucketSize) + 1, in.size());
+        double avgX = 0.0, avgY = 0.0;
+        std::size_t nextCount = nextEnd > nextStart ? nextEnd - nextStart : 0;
+        if (nextCount == 0) {
+            avgX = in.back().minute;
+            avgY = in.back().bg;
+        } else {
+            for (std::size_t i = nextStart; i < nextEnd; ++i) {
+                avgX += in[i].minute;
+                avgY += in[i].bg;
+            }
+            avgX /= static_cast<double>(nextCount);
+            avgY /= static_cast<double>(nextCount);
+        }
+
+        std::size_t start = static_cast<std::size_t>(bucket * bucketSize) + 1;
+        std::size_t end = std::min(static_cast<std::size_t>((bucket + 1) * bucketSize) + 1, in.size() - 1);
+
+        double maxArea = -1.0;
+        std::size_t picked = start;
+        for (std::size_t i = start; i < end; ++i) {
+            double area = std::fabs((in[a].minute - avgX) * (in[i].bg - in[a].bg) -
+                                    (in[a].minute - in[i].minute) * (avgY - in[a].bg));
+            if (area > maxArea) {
+                maxArea = area;
+                picked = i;
+            }
+        }
+
+        out.push_back(in[picked]);
+        a = picked;
+    }
+
+    out.push_back(in.back());
+}
@@ -1,22 +1,90 @@
 #include "Battery.h"
+#include "PumpEvents.h"
 
 #include <algorithm>
+#include <cmath>
 
 // Battery starts fully charged
-Battery::Battery() : level(100) {}
+Battery::Battery()
+    : charge(kCapacity), sag(0), lastStrokeCount(0), lastReadingCount(0),
+      idleRemainder(0.0), screenOnRemaining(0.0), eventBus(nullptr), publishedLevel(-1) {}
 
 Battery::~Battery() {}
 
-// Returns current battery level
+// Returns current battery level (rounded up, so a full battery reads 100% until 1% is used)
 int Battery::getLevel() const {
-    return level;
+    int level = static_cast<int>((charge * 100 + kCapacity - 1) / kCapacity);
+    return std::max(0, level - sag);
 }
 
 // Sets battery level (e.g., via simulation or user action)
 void Battery::setLevel(int lvl) {
-    level = std::max(0, std::min(100, lvl));
+    charge = kCapacity * std::max(0, std::min(100, lvl)) / 100;
+    publishLevelIfChanged();
+}
+
+std::int64_t Battery::getCharge() const {
+    return charge;
+}
+
+// Charges the activity since the last call: elapsed idle/screen time plus new strokes and readings
+void Battery::accountActivity(double minutes, std::uint64_t strokeCount, std::uint64_t readingCount) {
+    // Totals can restart (e.g. a fresh delivery manager); charge from the new baseline
+    std::uint64_t strokes = strokeCount >= lastStrokeCount ? strokeCount - lastStrokeCount : strokeCount;
+    std::uint64_t readings = readingCount >= lastReadingCount ? readingCount - lastReadingCount : readingCount;
+    lastStrokeCount = strokeCount;
+    lastReadingCount = readingCount;
+
+    idleRemainder += std::max(0.0, minutes);
+    double wholeMinutes = std::floor(idleRemainder);
+    idleRemainder -= wholeMinutes;
+
+    double screenMinutes = std::min(screenOnRemaining, std::max(0.0, minutes));
+    screenOnRemaining -= screenMinutes;
+
+    std::int64_t cost = static_cast<std::int64_t>(wholeMinutes) * kIdleCostPerMinute
+                      + static_cast<std::int64_t>(strokes) * kStrokeCost
+                      + static_cast<std::int64_t>(readings) * kReadingCost
+                      + static_cast<std::int64_t>(std::llround(screenMinutes * kScreenCostPerMinute));
+    consume(cost);
+}
+
+// Screen stays on for the longer of the remaining time and the new timeout
+void Battery::wakeScreen(double minutes) {
+    screenOnRemaining = std::max(screenOnRemaining, minutes);
 }
 
 void Battery::drain(int amount) {
-    setLevel(level - amount);
-}
\ No newline at end of file
+    consume(kCapacity * amount / 100);
+}
+
+void Battery::consume(std::int64_t microAmpHours) {
+    charge = std::max<std::int64_t>(0, std::min(kCapacity, charge - microAmpHours));
+    publishLevelIfChanged();
+}
+
+void Battery::setSag(int pct) {
+    sag = std::max(0, pct);
+    publishLevelIfChanged();
+}
+
+void Battery::setEventBus(PumpEventBus* bus) {
+    eventBus = bus;
+    publishedLevel = -1;
+}
+
+// Sends the current level even if it has not changed (e.g. when a simulation starts)
+void Battery::publishState() {
+    publishedLevel = -1;
+    publishLevelIfChanged();
+}
+
+void Battery::publishLevelIfChanged() {
+    if (!eventBus)
+        return;
+    int level = getLevel();
+    if (level != publishedLevel) {
+        publishedLevel = level;
+        eventBus->publish(BatteryLevelEvent{ level });
+    }
+}
@@ -1,30 +1,95 @@
 #include "BolusCalculator.h"
 #include "Profile.h"
+#include "ProfileSnapshot.h"
 #include <cmath>
 #include <iostream>
 
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define PUMP_BOLUS_BATCH_SSE41 1
+#endif
+
+namespace {
+// The dose formula shared by the scalar and batch paths (same operations, same order)
+inline double recommendedDose(double currentBG, double carbIntake, double iob,
+                              double icr, double correctionFactor, double targetBG) {
+    double carbBolus = carbIntake / icr;
+    double correctionBolus = (currentBG - targetBG) / correctionFactor;
+    double dose = std::round(carbBolus + correctionBolus - iob);
+    return dose < 0 ? 0 : dose;
+}
+
+#ifdef PUMP_BOLUS_BATCH_SSE41
+// Two doses per iteration; returns how many entries were done (the caller finishes the tail)
+__attribute__((target("sse4.1")))
+std::size_t calculateBolusBatchSse41(const BolusBatchInput& in, double* doses) {
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d half = _mm_set1_pd(0.5);
+    const __m128d one = _mm_set1_pd(1.0);
+    const __m128d signBit = _mm_set1_pd(-0.0);
+
+    std::size_t i = 0;
+    for (; i + 2 <= in.count; i += 2) {
+        __m128d carbBolus = _mm_div_pd(_mm_loadu_pd(in.carbIntake + i), _mm_loadu_pd(in.icr + i));
+        __m128d correctionBolus = _mm_div_pd(_mm_sub_pd(_mm_loadu_pd(in.currentBG + i), _mm_loadu_pd(in.targetBG + i)),
+                                             _mm_loadu_pd(in.correctionFactor + i));
+        __m128d x = _mm_sub_pd(_mm_add_pd(carbBolus, correctionBolus), _mm_loadu_pd(in.iob + i));
+
+        // std::round: truncate, then step one away from zero when the dropped fraction is >= 0.5.
+        // Blending (rather than adding 0) keeps the sign of -0.0 results.
+        __m128d truncated = _mm_round_pd(x, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+        __m128d fraction = _mm_andnot_pd(signBit, _mm_sub_pd(x, truncated));
+        __m128d awayFromZero = _mm_add_pd(truncated, _mm_or_pd(_mm_and_pd(signBit, x), one));
+        __m128d dose = _mm_blendv_pd(truncated, awayFromZero, _mm_cmpge_pd(fraction, half));
+
+        // dose < 0 ? 0 : dose
+        dose = _mm_blendv_pd(dose, zero, _mm_cmplt_pd(dose, zero));
+        _mm_storeu_pd(doses + i, dose);
+    }
+    return i;
+}
+
+bool cpuHasSse41() {
+    static const bool supported = __builtin_cpu_supports("sse4.1");
+    return supported;
+}
+#endif
+}
+
 BolusCalculator::BolusCalculator() {}
 BolusCalculator::~BolusCalculator() {}
 
 // Calculates recommended insulin dose based on carbs, BG, and IOB (insulin on board)
 double BolusCalculator::calculateBolus(double currentBG, double carbIntake, double iob, Profile* profile) {
-    double icr = profile->getInsulinToCarbRatio();     // Grams of carbs covered by 1U insulin
-    double correctionFactor = profile->getCorrectionFactor(); // BG drop per unit insulin
-    double targetBG = profile->getTargetBG();          // Desired BG level
-
-    std::cout << "ICR: " << icr << ", correctionFactor: " << correctionFactor << ", targetBG: " << targetBG << "\n";
+    return calculateBolus(currentBG, carbIntake, iob, profile->getInsulinToCarbRatio(),
+                          profile->getCorrectionFactor(), profile->getTargetBG());
+}
 
-    // Carb bolus based on carb intake
-    double carbBolus = carbIntake / icr;
+// Same calculation from an immutable snapshot (used by simulation-side readers)
+double BolusCalculator::calculateBolus(double currentBG, double carbIntake, double iob, const ProfileSnapshot& profile) {
+    return calculateBolus(currentBG, carbIntake, iob, profile.getInsulinToCarbRatio(),
+                          profile.getCorrectionFactor(), profile.getTargetBG());
+}
 
-    // Correction bolus based on BG deviation
-    double correctionBolus = calculateCorrectionBolus(currentBG, targetBG, correctionFactor);
+// icr: grams of carbs covered by 1U, correctionFactor: BG drop per unit, targetBG: desired BG level
+double BolusCalculator::calculateBolus(double currentBG, double carbIntake, double iob,
+                                       double icr, double correctionFactor, double targetBG) {
+    std::cout << "ICR: " << icr << ", correctionFactor: " << correctionFactor << ", targetBG: " << targetBG << "\n";
 
-    // Total dose = carb bolus + correction - insulin already on board
-    double dose = std::round(carbBolus + correctionBolus - iob);
+    // Carb bolus + correction bolus - insulin already on board, rounded, never below 0U
+    return recommendedDose(currentBG, carbIntake, iob, icr, correctionFactor, targetBG);
+}
 
-    // Optionally add clamping or safety bounds here (e.g., min 0U)
-    return dose < 0 ? 0 : dose;
+// Batch form of calculateBolus() for many patients; silent and bit-identical to the scalar path
+void BolusCalculator::calculateBolusBatch(const BolusBatchInput& input, double* doses) {
+    std::size_t done = 0;
+#ifdef PUMP_BOLUS_BATCH_SSE41
+    if (cpuHasSse41())
+        done = calculateBolusBatchSse41(input, doses);
+#endif
+    for (std::size_t i = done; i < input.count; ++i)
+        doses[i] = recommendedDose(input.currentBG[i], input.carbIntake[i], input.iob[i],
+                                   input.icr[i], input.correctionFactor[i], input.targetBG[i]);
 }
 
 // Splits an extended bolus 
@@ -3,12 +3,18 @@
 #include "BolusCalculator.h"
 #include "InsulinDeliveryManager.h"
 #include "CGMSensorInterface.h"
-#include "Profile.h"
+#include "ProfileSnapshot.h"
+#include <cmath>
 #include <iostream>
 
+using InsulinUnits::fromUnits;
+using InsulinUnits::toUnits;
+using InsulinUnits::kStroke;
+
 BolusManager::BolusManager(ProfileManager* pm, BolusCalculator* bc,
                            InsulinDeliveryManager* idm, CGMSensorInterface* cgm)
-    : profileManager(pm), bolusCalculator(bc), deliveryManager(idm), cgmSensor(cgm) {}
+    : profileManager(pm), bolusCalculator(bc), deliveryManager(idm), cgmSensor(cgm),
+      doseCache(), cachedProfileVersion(0), cachedIOB(0), doseCacheHits(0), doseCacheMisses(0) {}
 
 BolusManager::~BolusManager() {
     // Does not delete pointers – assumes shared ownership elsewhere.
@@ -30,41 +36,59 @@ double BolusManager::computeRecommendedDose(double bg, double carbs) {
         return 0.0;
     }
 
-    Profile* active = profileManager->getActiveProfile();
+    // Snapshot stays valid for this whole call even if the profile is edited concurrently
+    std::shared_ptr<const ProfileSnapshot> active = profileManager->getActiveSnapshot();
     if (!active) {
         std::cerr << "[ERROR] No active profile set!\n";
         return 0.0;
     }
 
-    double iob = deliveryManager->getInsulinOnBoard();
-    std::cout << "[BolusManager] BG: " << bg << ", Carbs: " << carbs << ", IOB: " << iob << "\n";
+    // Quantize to the pump's resolution; the dose below is computed from these exact values
+    std::int64_t bgKey = std::llround(bg * 10.0);
+    std::int64_t carbKey = std::llround(carbs * 10.0);
+    MicroUnits iobStrokes = (fromUnits(deliveryManager->getInsulinOnBoard()) + kStroke / 2) / kStroke;
+    MicroUnits iobKey = iobStrokes * kStroke;
 
-    double dose = bolusCalculator->calculateBolus(bg, carbs, iob, active);
-    std::cout << "[BolusManager] Recommended dose: " << dose << "\n";
+    // The cache only ever holds entries for one profile version and one IOB
+    if (active->getVersion() != cachedProfileVersion || iobKey != cachedIOB) {
+        clearDoseCache();
+        cachedProfileVersion = active->getVersion();
+        cachedIOB = iobKey;
+    }
 
-    return dose;
-}
+    std::uint64_t hash = static_cast<std::uint64_t>(bgKey) * 0x9e3779b97f4a7c15ull
+                       ^ static_cast<std::uint64_t>(carbKey) * 0xc2b2ae3d27d4eb4full;
+    DoseCacheEntry& entry = doseCache[(hash >> 32) & (kDoseCacheSize - 1)];
+    if (entry.valid && entry.bgKey == bgKey && entry.carbKey == carbKey) {
+        ++doseCacheHits;
+        std::cout << "[BolusManager] Recommended dose: " << entry.dose << " (cached)\n";
+        return entry.dose;
+    }
 
+    double iob = toUnits(iobKey);
+    std::cout << "[BolusManager] BG: " << bgKey / 10.0 << ", Carbs: " << carbKey / 10.0 << ", IOB: " << iob << "\n";
 
+    double dose = bolusCalculator->calculateBolus(bgKey / 10.0, carbKey / 10.0, iob, *active);
+    std::cout << "[BolusManager] Recommended dose: " << dose << "\n";
 
-// Delivers a quick (immediate) bolus or extended if flag set
-void BolusManager::deliverBolus(double dose, bool extended, double duration) {
-    deliveryManager->deliverBolus(dose, extended, duration);
+    ++doseCacheMisses;
+    entry.valid = true;
+    entry.bgKey = bgKey;
+    entry.carbKey = carbKey;
+    entry.dose = dose;
+    return dose;
 }
 
-// Delivers a complex extended bolus with immediate and scheduled components
-void BolusManager::deliverBolus(double dose, bool extended, double immediateAmount, double duration, int splits) {
-    if (!extended)
-        deliveryManager->deliverBolus(dose, false, 0.0);
-    else
-        deliveryManager->deliverBolus(dose, true, immediateAmount, duration, splits);
+void BolusManager::clearDoseCache() {
+    for (DoseCacheEntry& entry : doseCache)
+        entry.valid = false;
 }
 
-void BolusManager::deliverBolus(double dose, bool extended, double immediateAmount, double duration, int splits, int startTime) {
-    if (!extended)
-        deliveryManager->deliverBolus(dose, false, 0.0);
-    else
-        deliveryManager->deliverBolus(dose, true, immediateAmount, duration, splits, startTime);
+
+
+// Delivers an immediate, extended or dual-wave bolus through the delivery manager
+BolusStatus BolusManager::submitBolus(const BolusRequest& request) {
+    return deliveryManager->submitBolus(request);
 }
 
 // Returns CGM BG reading, or 0.0 if CGM is not connected
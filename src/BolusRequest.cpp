@@ -0,0 +1,50 @@
+#include "BolusRequest.h"
+
+BolusRequest BolusRequest::immediate(double units, DoseSource source) {
+    BolusRequest request;
+    request.kind = Immediate;
+    request.totalUnits = units;
+    request.immediateUnits = units;
+    request.source = source;
+    return request;
+}
+
+BolusRequest BolusRequest::extended(double units, double durationMinutes, int splits, double startTime) {
+    BolusRequest request;
+    request.kind = Extended;
+    request.totalUnits = units;
+    request.durationMinutes = durationMinutes;
+    request.splits = splits;
+    request.startTime = startTime;
+    return request;
+}
+
+BolusRequest BolusRequest::dualWave(double totalUnits, double immediateUnits, double durationMinutes, int splits,
+                                    double startTime) {
+    BolusRequest request;
+    request.kind = DualWave;
+    request.totalUnits = totalUnits;
+    request.immediateUnits = immediateUnits;
+    request.durationMinutes = durationMinutes;
+    request.splits = splits;
+    request.startTime = startTime;
+    return request;
+}
+
+const char* bolusStatusName(BolusStatus status) {
+    switch (status) {
+        case BolusStatus::Delivered:           return "Delivered";
+        case BolusStatus::Scheduled:           return "Scheduled";
+        case BolusStatus::InvalidRequest:      return "Invalid request";
+        case BolusStatus::NoCartridge:         return "No cartridge";
+        case BolusStatus::InsufficientInsulin: return "Insufficient insulin";
+        case BolusStatus::DeliveryFailed:      return "Delivery failed";
+        case BolusStatus::Busy:                return "Extended bolus already running";
+        case BolusStatus::Queued:              return "Queued";
+    }
+    return "Unknown";
+}
+
+bool bolusSucceeded(BolusStatus status) {
+    return status == BolusStatus::Delivered || status == BolusStatus::Scheduled;
+}
@@ -1,16 +1,22 @@
 #include "CGMSensorInterface.h"
 #include "InsulinDeliveryManager.h"
+#include "PumpEvents.h"
 #include <algorithm>
-#include <cstdlib>
 #include <ctime>
 
-CGMSensorInterface::CGMSensorInterface() : profile(nullptr), currentBG(6.0), scheduledCarbs(0.0) {
-    std::srand(std::time(nullptr));
+CGMSensorInterface::CGMSensorInterface()
+    : profile(nullptr), currentBG(6.0), scheduledCarbs(0.0),
+      noise(static_cast<unsigned int>(std::time(nullptr))), sensorBG(6.0) {
+    bgDelayLine.fill(currentBG);
 }
 
 CGMSensorInterface::~CGMSensorInterface() {}
 
 double CGMSensorInterface::getCurrentBG() const {
+    return sensorBG;
+}
+
+double CGMSensorInterface::getTrueBG() const {
     return currentBG;
 }
 
@@ -36,12 +42,40 @@ void CGMSensorInterface::simulateNextReading() {
     currentBG = std::max(0.5, currentBG - iobDrop);
 
     // Add tiny fluctuation
-    double delta = (std::rand() % 9 - 6) / 2000.0;
+    double delta = std::uniform_int_distribution<int>(-6, 2)(noise) / 2000.0;
     currentBG += delta;
+
+    delayHead = (delayHead + 1) % bgDelayLine.size();
+    bgDelayLine[delayHead] = currentBG;
+
+    // Readings stay on a fixed phase: the next one is the first cadence step after now
+    if (simulatedTime >= nextReadingMinute) {
+        nextReadingMinute += ((simulatedTime - nextReadingMinute) / cadenceMinutes + 1) * cadenceMinutes;
+        takeReading();
+    }
 }
 
+// The sensor shows the new value at once; the delay line is refilled so latency starts from it
 void CGMSensorInterface::setBG(double newValue) {
     currentBG = newValue;
+    bgDelayLine.fill(newValue);
+    sensorBG = newValue;
+    recordReading();
+}
+
+// Samples the delay line and applies the sensor's calibration and offset errors
+void CGMSensorInterface::takeReading() {
+    ++readingCount;
+    std::size_t lag = static_cast<std::size_t>(latencyMinutes);
+    double interstitial = bgDelayLine[(delayHead + bgDelayLine.size() - lag) % bgDelayLine.size()];
+    if (readingOffset == 0.0 && calibrationDriftPct == 0.0) {
+        sensorBG = interstitial;
+    } else {
+        double days = (simulatedTime - calibratedAt) / 1440.0;
+        double gain = 1.0 + calibrationDriftPct / 100.0 * days;
+        sensorBG = std::max(0.5, interstitial * gain + readingOffset);   // Sensor floor
+    }
+    recordReading();
 }
 
 void CGMSensorInterface::addCarbs(int grams) {
@@ -56,4 +90,86 @@ void CGMSensorInterface::setSimulatedTime(int time) {
 
 void CGMSensorInterface::setDeliveryManager(InsulinDeliveryManager* dm) {
     deliveryManager = dm;
+}
+
+void CGMSensorInterface::setSeed(unsigned int seed) {
+    noise.seed(seed);
+}
+
+std::uint64_t CGMSensorInterface::getReadingCount() const {
+    return readingCount;
+}
+
+const CGMTrend& CGMSensorInterface::getTrend() const {
+    return trend;
+}
+
+void CGMSensorInterface::setCadenceMinutes(int minutes) {
+    cadenceMinutes = std::max(1, minutes);
+    nextReadingMinute = std::min(nextReadingMinute, simulatedTime + cadenceMinutes);
+}
+
+int CGMSensorInterface::getCadenceMinutes() const {
+    return cadenceMinutes;
+}
+
+int CGMSensorInterface::getNextReadingMinute() const {
+    return nextReadingMinute;
+}
+
+void CGMSensorInterface::setLatencyMinutes(int minutes) {
+    latencyMinutes = std::min(std::max(0, minutes), kMaxLatencyMinutes);
+}
+
+int CGMSensorInterface::getLatencyMinutes() const {
+    return latencyMinutes;
+}
+
+void CGMSensorInterface::setCalibrationDrift(double pctPerDay) {
+    calibrationDriftPct = pctPerDay;
+}
+
+void CGMSensorInterface::calibrate() {
+    calibratedAt = simulatedTime;
+}
+
+void CGMSensorInterface::setSignalLost(bool lost) {
+    if (lost == signalLost)
+        return;
+    signalLost = lost;
+    if (lost)
+        trend.clear();             // No slope across a gap
+    if (eventBus)
+        eventBus->publish(CGMSignalEvent{ !lost });
+}
+
+bool CGMSensorInterface::isReadingAvailable() const {
+    return !signalLost;
+}
+
+void CGMSensorInterface::setReadingOffset(double offset) {
+    readingOffset = offset;
+}
+
+void CGMSensorInterface::setEventBus(PumpEventBus* bus) { eventBus = bus; }
+
+// Sends the signal state and, if available, the current reading
+void CGMSensorInterface::publishState() {
+    if (!eventBus)
+        return;
+    eventBus->publish(CGMSignalEvent{ !signalLost });
+    publishReading();
+}
+
+// A new sensor value: into the trend window, then out to subscribers
+void CGMSensorInterface::recordReading() {
+    if (!signalLost)
+        trend.addReading(simulatedTime, getCurrentBG());
+    publishReading();
+}
+
+// Readings are only reported while the signal is up
+void CGMSensorInterface::publishReading() {
+    if (eventBus && !signalLost)
+        eventBus->publish(BGReadingEvent{ getCurrentBG(), simulatedTime, trend.getSlope(), trend.getArrow() });
 }
\ No newline at end of file
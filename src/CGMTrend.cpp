@@ -0,0 +1,156 @@
+#include "CGMTrend.h"
+
+static_assert((CGMTrend::kCapacity & (CGMTrend::kCapacity - 1)) == 0, "Capacity must be a power of two");
+
+namespace {
+// Rebuild the sums once the newest sample is this far from the origin. The new origin is the
+// oldest sample in the window, so this recurs about every kRebaseMinutes - kWindowMinutes.
+const int kRebaseMinutes = 4 * CGMTrend::kWindowMinutes;
+
+// Arrow boundaries in mmol/L per minute (about 1, 2 and 3 mg/dL per minute)
+const double kArrowSlight = 0.06;
+const double kArrowSingle = 0.11;
+const double kArrowDouble = 0.17;
+}
+
+CGMTrend::CGMTrend()
+    : samples(), head(0), count(0), origin(0),
+      sumT(0.0), sumT2(0.0), sumT3(0.0), sumT4(0.0), sumY(0.0), sumTY(0.0), sumT2Y(0.0) {}
+
+void CGMTrend::addReading(int minute, double bg) {
+    if (count > 0) {
+        Sample& newest = samples[(head + count - 1) & (kCapacity - 1)];
+        if (minute == newest.minute) {
+            accumulate(newest, -1.0);
+            newest.bg = bg;
+            accumulate(newest, 1.0);
+            return;
+        }
+        if (minute < newest.minute)
+            clear();                   // Clock went backwards (simulation restarted)
+    }
+
+    if (count == 0)
+        origin = minute;
+    evictBefore(minute - kWindowMinutes);
+    if (count == kCapacity)
+        evictBefore(samples[head].minute + 1);
+
+    Sample sample { minute, bg };
+    samples[(head + count) & (kCapacity - 1)] = sample;
+    ++count;
+    accumulate(sample, 1.0);
+
+    if (minute - origin > kRebaseMinutes)
+        rebase();
+}
+
+void CGMTrend::clear() {
+    head = 0;
+    count = 0;
+    origin = 0;
+    sumT = sumT2 = sumT3 = sumT4 = 0.0;
+    sumY = sumTY = sumT2Y = 0.0;
+}
+
+bool CGMTrend::hasTrend() const {
+    return count >= kMinSamples;
+}
+
+// Least-squares line through the window
+double CGMTrend::getSlope() const {
+    if (!hasTrend())
+        return 0.0;
+    double n = static_cast<double>(count);
+    double denominator = n * sumT2 - sumT * sumT;
+    if (denominator <= 0.0)
+        return 0.0;
+    return (n * sumTY - sumT * sumY) / denominator;
+}
+
+// Least-squares parabola y = a + bt + ct² (Cramer's rule for c); acceleration is 2c
+double CGMTrend::getAcceleration() const {
+    if (count < 3)
+        return 0.0;
+    double n = static_cast<double>(count);
+    double det = n * (sumT2 * sumT4 - sumT3 * sumT3)
+               - sumT * (sumT * sumT4 - sumT3 * sumT2)
+               + sumT2 * (sumT * sumT3 - sumT2 * sumT2);
+    if (det <= 0.0)
+        return 0.0;
+    double detC = n * (sumT2 * sumT2Y - sumT3 * sumTY)
+                - sumT * (sumT * sumT2Y - sumT3 * sumY)
+                + sumT2 * (sumT * sumTY - sumT2 * sumY);
+    return 2.0 * detC / det;
+}
+
+TrendArrow CGMTrend::getArrow() const {
+    return hasTrend() ? arrowFor(getSlope()) : TrendArrow::None;
+}
+
+TrendArrow CGMTrend::arrowFor(double slope) {
+    if (slope >= kArrowDouble) return TrendArrow::DoubleUp;
+    if (slope >= kArrowSingle) return TrendArrow::SingleUp;
+    if (slope >= kArrowSlight) return TrendArrow::FortyFiveUp;
+    if (slope > -kArrowSlight) return TrendArrow::Flat;
+    if (slope > -kArrowSingle) return TrendArrow::FortyFiveDown;
+    if (slope > -kArrowDouble) return TrendArrow::SingleDown;
+    return TrendArrow::DoubleDown;
+}
+
+const char* CGMTrend::arrowSymbol(TrendArrow arrow) {
+    switch (arrow) {
+        case TrendArrow::None: return "";
+        case TrendArrow::DoubleDown: return "⇊";
+        case TrendArrow::SingleDown: return "↓";
+        case TrendArrow::FortyFiveDown: return "↘";
+        case TrendArrow::Flat: return "→";
+        case TrendArrow::FortyFiveUp: return "↗";
+        case TrendArrow::SingleUp: return "↑";
+        case TrendArrow::DoubleUp: return "⇈";
+    }
+    return "";
+}
+
+const char* CGMTrend::arrowName(TrendArrow arrow) {
+    switch (arrow) {
+        case TrendArrow::None: return "None";
+        case TrendArrow::DoubleDown: return "DoubleDown";
+        case TrendArrow::SingleDown: return "SingleDown";
+        case TrendArrow::FortyFiveDown: return "FortyFiveDown";
+        case TrendArrow::Flat: return "Flat";
+        case TrendArrow::FortyFiveUp: return "FortyFiveUp";
+        case TrendArrow::SingleUp: return "SingleUp";
+        case TrendArrow::DoubleUp: return "DoubleUp";
+    }
+    return "Unknown";
+}
+
+void CGMTrend::accumulate(const Sample& sample, double sign) {
+    double t = static_cast<double>(sample.minute - origin);
+    double t2 = t * t;
+    sumT += sign * t;
+    sumT2 += sign * t2;
+    sumT3 += sign * t2 * t;
+    sumT4 += sign * t2 * t2;
+    sumY += sign * sample.bg;
+    sumTY += sign * t * sample.bg;
+    sumT2Y += sign * t2 * sample.bg;
+}
+
+// Drops samples older than minute from the front of the window
+void CGMTrend::evictBefore(int minute) {
+    while (count > 0 && samples[head].minute < minute) {
+        accumulate(samples[head], -1.0);
+        head = (head + 1) & (kCapacity - 1);
+        --count;
+    }
+}
+
+void CGMTrend::rebase() {
+    origin = samples[head].minute;
+    sumT = sumT2 = sumT3 = sumT4 = 0.0;
+    sumY = sumTY = sumT2Y = 0.0;
+    for (std::size_t i = 0; i < count; ++i)
+        accumulate(samples[(head + i) & (kCapacity - 1)], 1.0);
+}
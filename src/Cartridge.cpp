@@ -1,17 +1,28 @@
 #include "Cartridge.h"
+#include "PumpEvents.h"
+#include <algorithm>
 #include <iostream>
 
+using InsulinUnits::fromUnits;
+using InsulinUnits::toUnits;
+
 // Default: 200-unit cartridge (fully filled)
-Cartridge::Cartridge() : capacity(200.0), currentVolume(200.0) {}
+Cartridge::Cartridge() : capacity(fromUnits(200.0)), currentVolume(fromUnits(200.0)), reserved(0), eventBus(nullptr), publishedVolume(-1) {}
 
 Cartridge::~Cartridge() {}
 
 // Attempts to use insulin from cartridge; returns false if insufficient
 bool Cartridge::useInsulin(double amount) {
-    if (currentVolume >= amount) {
+    return useMicroUnits(fromUnits(amount));
+}
+
+// Unreserved draw: insulin set aside for scheduled doses is not touched
+bool Cartridge::useMicroUnits(MicroUnits amount) {
+    if (getAvailableMicroUnits() >= amount) {
         currentVolume -= amount;
-        std::cout << "[Cartridge] Using " << amount 
-                  << " units. Remaining: " << currentVolume << " units.\n";
+        std::cout << "[Cartridge] Using " << toUnits(amount)
+                  << " units. Remaining: " << toUnits(currentVolume) << " units.\n";
+        publishVolume();
         return true;
     }
     std::cout << "[Cartridge] Insufficient insulin.\n";
@@ -21,17 +32,79 @@ bool Cartridge::useInsulin(double amount) {
 // Refills cartridge to full capacity
 void Cartridge::refill() {
     currentVolume = capacity;
-    std::cout << "[Cartridge] Cartridge refilled to " << capacity << " units.\n";
+    std::cout << "[Cartridge] Cartridge refilled to " << toUnits(capacity) << " units.\n";
+    publishVolume();
+}
+
+// Loses insulin to a leak; no log line per tick, the fault itself is logged by the injector
+void Cartridge::leak(MicroUnits amount) {
+    currentVolume = std::max<MicroUnits>(0, currentVolume - amount);
+    publishVolume();
+}
+
+// Sets insulin aside for a scheduled dose; fails if the unreserved volume cannot cover it
+bool Cartridge::reserve(MicroUnits amount) {
+    if (amount < 0 || getAvailableMicroUnits() < amount)
+        return false;
+    reserved += amount;
+    return true;
+}
+
+// Draws previously reserved insulin. On failure (insulin lost since it was reserved) nothing is
+// drawn and the reservation stays; the caller releases it.
+bool Cartridge::commitReserved(MicroUnits amount) {
+    if (amount < 0 || amount > reserved)
+        return false;
+    if (currentVolume < amount) {
+        std::cout << "[Cartridge] Reserved insulin no longer available.\n";
+        return false;
+    }
+    currentVolume -= amount;
+    reserved -= amount;
+    std::cout << "[Cartridge] Using " << toUnits(amount)
+              << " units. Remaining: " << toUnits(currentVolume) << " units.\n";
+    publishVolume();
+    return true;
+}
+
+// Returns reserved insulin that a cancelled or failed plan no longer needs
+void Cartridge::release(MicroUnits amount) {
+    reserved -= std::min(std::max<MicroUnits>(0, amount), reserved);
 }
 
 // Returns true if insulin volume is less than 10% of capacity
 bool Cartridge::isLow() const {
-    return currentVolume < (capacity * 0.1);
+    return currentVolume * 10 < capacity;
 }
 
 // Getters and setters
-double Cartridge::getCapacity() const { return capacity; }
-void Cartridge::setCapacity(double cap) { capacity = cap; }
+double Cartridge::getCapacity() const { return toUnits(capacity); }
+void Cartridge::setCapacity(double cap) { capacity = fromUnits(cap); }
+
+double Cartridge::getCurrentVolume() const { return toUnits(currentVolume); }
+void Cartridge::setCurrentVolume(double vol) {
+    currentVolume = fromUnits(vol);
+    publishVolume();
+}
+
+MicroUnits Cartridge::getCurrentMicroUnits() const { return currentVolume; }
+MicroUnits Cartridge::getAvailableMicroUnits() const { return std::max<MicroUnits>(0, currentVolume - reserved); }
+MicroUnits Cartridge::getReservedMicroUnits() const { return reserved; }
+
+void Cartridge::setEventBus(PumpEventBus* bus) {
+    eventBus = bus;
+    publishedVolume = -1;
+}
+
+// Sends the current volume even if it has not changed (e.g. when a simulation starts)
+void Cartridge::publishState() {
+    publishedVolume = -1;
+    publishVolume();
+}
 
-double Cartridge::getCurrentVolume() const { return currentVolume; }
-void Cartridge::setCurrentVolume(double vol) { currentVolume = vol; }
+void Cartridge::publishVolume() {
+    if (eventBus && currentVolume != publishedVolume) {
+        publishedVolume = currentVolume;
+        eventBus->publish(CartridgeVolumeEvent{ currentVolume });
+    }
+}
@@ -1,7 +1,7 @@
 #include "ControlIQController.h"
 #include "CGMSensorInterface.h"
 #include "InsulinDeliveryManager.h"
-#include "Profile.h"
+#include "ProfileSnapshot.h"
 #include <iostream>
 #include <cmath>
 
@@ -9,7 +9,7 @@
 ControlIQController::ControlIQController()
     : cgmSensor(nullptr),
       deliveryManager(nullptr),
-      activeProfile(nullptr),
+      activeProfile(),
       predictedBG(0.0),
       isActive(false) {}
 
@@ -21,19 +21,27 @@ void ControlIQController::processSensorReading(double currentBG) {
     std::cout << "[ControlIQController] Received sensor reading: " << currentBG << " mmol/L\n";
 }
 
-// Simulate a simple BG trend prediction based on a constant offset
+// Short-term prediction: insulin on board plus where the CGM trend is heading
 void ControlIQController::predictBGTrend() {
     if (!cgmSensor || !deliveryManager) return;
+    if (!cgmSensor->isReadingAvailable()) {
+        std::cout << "[ControlIQController] No CGM reading; keeping previous prediction.\n";
+        return;
+    }
 
     double currentBG = cgmSensor->getCurrentBG();
     double iob = deliveryManager->getInsulinOnBoard();
+    const CGMTrend& trend = cgmSensor->getTrend();
 
     // Simulate BG drop based on IOB: e.g. 1 U drops BG by 1.5 mmol/L over 30 min
     double predictedDrop = iob * 1.5;
-    double predictedBG = currentBG - predictedDrop;
+    double trendChange = trend.getSlope() * kTrendHorizonMinutes;   // 0 until the sensor has a trend
+    double predictedBG = currentBG - predictedDrop + trendChange;
 
-    std::cout << "[ControlIQController] Current BG: " << currentBG << " mmol/L\n";
+    std::cout << "[ControlIQController] Current BG: " << currentBG << " mmol/L "
+              << CGMTrend::arrowSymbol(trend.getArrow()) << "\n";
     std::cout << "[ControlIQController] IOB: " << iob << " U → Predicted drop: " << predictedDrop << "\n";
+    std::cout << "[ControlIQController] Trend: " << trend.getSlope() << " mmol/L/min → Change: " << trendChange << "\n";
     std::cout << "[ControlIQController] Predicted BG in 30 minutes: " << predictedBG << " mmol/L\n";
 
     this->predictedBG = predictedBG;
@@ -45,6 +53,10 @@ void ControlIQController::applyAutomaticAdjustments() {
         std::cout << "[ControlIQController] [Error] Insulin Delivery Manager not set.\n";
         return;
     }
+    if (cgmSensor && !cgmSensor->isReadingAvailable()) {
+        std::cout << "[ControlIQController] No CGM reading. Holding current basal.\n";
+        return;
+    }
 
     if (predictedBG < 3.9) {
         std::cout << "[ControlIQController] Predicted BG (" << predictedBG << " mmol/L) is very low. Stopping basal delivery.\n";
@@ -55,7 +67,7 @@ void ControlIQController::applyAutomaticAdjustments() {
         if (deliveryManager->isBasalRunning()) {
             double currentRate = deliveryManager->getCurrentBasalRate();
             double newRate = currentRate * 0.8;
-            deliveryManager->startBasalDelivery(newRate);
+            deliveryManager->startBasalDelivery(newRate, DoseSource::ControlIQ);
         } else {
             std::cout << "[ControlIQController] Basal not running; cannot reduce rate.\n";
         }
@@ -68,7 +80,7 @@ void ControlIQController::applyAutomaticAdjustments() {
         if (deliveryManager->isBasalRunning()) {
             double currentRate = deliveryManager->getCurrentBasalRate();
             double newRate = currentRate * 1.2;
-            deliveryManager->startBasalDelivery(newRate);
+            deliveryManager->startBasalDelivery(newRate, DoseSource::ControlIQ);
         } else {
             std::cout << "[ControlIQController] Basal not running; cannot increase rate.\n";
         }
@@ -76,7 +88,7 @@ void ControlIQController::applyAutomaticAdjustments() {
     else {
         std::cout << "[ControlIQController] Predicted BG (" << predictedBG << " mmol/L) is very high. Delivering correction bolus.\n";
         double correctionDose = predictedBG - 7.0;  // Basic placeholder logic
-        deliveryManager->deliverBolus(correctionDose, false, 0.0);
+        deliveryManager->submitBolus(BolusRequest::immediate(correctionDose, DoseSource::ControlIQ));
     }
 }
 
@@ -90,5 +102,8 @@ void ControlIQController::setIsActive(bool active) { isActive = active; }
 CGMSensorInterface* ControlIQController::getCGMSensor() const { return cgmSensor; }
 void ControlIQController::setCGMSensor(CGMSensorInterface* sensor) { cgmSensor = sensor; }
 
+std::shared_ptr<const ProfileSnapshot> ControlIQController::getProfileSnapshot() const { return activeProfile; }
+void ControlIQController::setProfileSnapshot(std::shared_ptr<const ProfileSnapshot> snapshot) { activeProfile = snapshot; }
+
 void ControlIQController::setInsulinDeliveryManager(InsulinDeliveryManager* manager) { deliveryManager = manager; }
 InsulinDeliveryManager* ControlIQController::getInsulinDeliveryManager() const { return deliveryManager; }
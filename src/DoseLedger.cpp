@@ -0,0 +1,34 @@
+#include "DoseLedger.h"
+
+DoseLedger::DoseLedger() : records() {}
+
+void DoseLedger::record(double time, MicroUnits amount, DoseType type, DoseSource source) {
+    DoseRecord& slot = records.push();
+    slot.time = time;
+    slot.amount = amount;
+    slot.type = type;
+    slot.source = source;
+}
+
+MicroUnits DoseLedger::sumSince(double since) const {
+    MicroUnits total = 0;
+    forEachSince(since, [&](const DoseRecord& dose) { total += dose.amount; });
+    return total;
+}
+
+const char* DoseLedger::typeName(DoseType type) {
+    switch (type) {
+        case DoseType::Bolus: return "Bolus";
+        case DoseType::Basal: return "Basal";
+    }
+    return "Unknown";
+}
+
+const char* DoseLedger::sourceName(DoseSource source) {
+    switch (source) {
+        case DoseSource::Manual: return "Manual";
+        case DoseSource::ControlIQ: return "Control-IQ";
+        case DoseSource::Extended: return "Extended";
+    }
+    return "Unknown";
+}
@@ -0,0 +1,152 @@
+#include "FaultInjector.h"
+#include "Battery.h"
+#include "Cartridge.h"
+#include "CGMSensorInterface.h"
+#include "InsulinDeliveryManager.h"
+#include "InsulinUnits.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+namespace {
+// Duration (min) and magnitude ranges used for random campaigns, per fault kind
+struct FaultRange {
+    int minDuration, maxDuration;
+    double minMagnitude, maxMagnitude;
+};
+
+const FaultRange kRandomRanges[FaultEvent::KindCount] = {
+    { 60, 240, 0.0, 0.0 },      // Occlusion
+    { 10,  90, 0.0, 0.0 },      // CGMDropout
+    { 20,  90, 1.5, 4.0 },      // CompressionLow (mmol/L)
+    {  5,  30, 10.0, 40.0 },    // BatterySag (%)
+    { 30, 180, 0.5, 3.0 },      // CartridgeLeak (U/hr)
+};
+}
+
+FaultInjector::FaultInjector()
+    : sorted(true), nextEvent(0), activeCount(), activeMagnitude(), injectedCount(0),
+      battery(nullptr), cartridge(nullptr), cgmSensor(nullptr), deliveryManager(nullptr) {}
+
+void FaultInjector::schedule(const FaultEvent& event) {
+    FaultEvent copy = event;
+    copy.durationMinutes = std::max(1, copy.durationMinutes);
+    events.push_back(copy);
+    sorted = false;
+}
+
+// Poisson arrivals over [0, horizon) with uniformly chosen kinds
+void FaultInjector::generateRandom(unsigned int seed, int horizonMinutes, double faultsPerDay) {
+    if (faultsPerDay <= 0.0 || horizonMinutes <= 0)
+        return;
+
+    std::mt19937 rng(seed);
+    std::exponential_distribution<double> gap(faultsPerDay / (24.0 * 60.0));
+    std::uniform_int_distribution<int> pickKind(0, FaultEvent::KindCount - 1);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    for (double t = gap(rng); t < horizonMinutes; t += gap(rng)) {
+        FaultEvent event;
+        event.kind = static_cast<FaultEvent::Kind>(pickKind(rng));
+        const FaultRange& range = kRandomRanges[event.kind];
+        event.startMinute = static_cast<int>(t);
+        event.durationMinutes = range.minDuration +
+            static_cast<int>(unit(rng) * (range.maxDuration - range.minDuration));
+        event.magnitude = range.minMagnitude + unit(rng) * (range.maxMagnitude - range.minMagnitude);
+        schedule(event);
+    }
+}
+
+void FaultInjector::clear() {
+    for (std::size_t index : active)
+        end(events[index]);
+    active.clear();
+    applyEffects();
+    events.clear();
+    sorted = true;
+    nextEvent = 0;
+    injectedCount = 0;
+}
+
+void FaultInjector::onTick(int minute) {
+    if (!sorted) {
+        std::stable_sort(events.begin() + nextEvent, events.end(),
+                         [](const FaultEvent& x, const FaultEvent& y) { return x.startMinute < y.startMinute; });
+        sorted = true;
+    }
+
+    bool changed = false;
+
+    // End faults whose window has passed
+    for (std::size_t i = 0; i < active.size(); ) {
+        const FaultEvent& event = events[active[i]];
+        if (minute >= event.startMinute + event.durationMinutes) {
+            end(event);
+            active[i] = active.back();
+            active.pop_back();
+            changed = true;
+        } else {
+            ++i;
+        }
+    }
+
+    // Start faults that are due
+    while (nextEvent < events.size() && events[nextEvent].startMinute <= minute) {
+        begin(events[nextEvent]);
+        active.push_back(nextEvent);
+        ++nextEvent;
+        changed = true;
+    }
+
+    if (changed)
+        applyEffects();
+
+    // Leaks act continuously while active
+    if (cartridge && activeCount[FaultEvent::CartridgeLeak] > 0)
+        cartridge->leak(InsulinUnits::fromUnits(activeMagnitude[FaultEvent::CartridgeLeak] / 60.0));
+}
+
+bool FaultInjector::isActive(FaultEvent::Kind kind) const {
+    return activeCount[kind] > 0;
+}
+
+void FaultInjector::begin(const FaultEvent& event) {
+    ++activeCount[event.kind];
+    activeMagnitude[event.kind] += event.magnitude;
+    ++injectedCount;
+    std::cout << "[FaultInjector] " << kindName(event.kind) << " started for "
+              << event.durationMinutes << " min (magnitude " << event.magnitude << ").\n";
+}
+
+void FaultInjector::end(const FaultEvent& event) {
+    --activeCount[event.kind];
+    activeMagnitude[event.kind] -= event.magnitude;
+    if (activeCount[event.kind] == 0)
+        activeMagnitude[event.kind] = 0.0;   // Drop rounding residue
+    std::cout << "[FaultInjector] " << kindName(event.kind) << " cleared.\n";
+}
+
+// Pushes the combined state of all active faults into the components
+void FaultInjector::applyEffects() {
+    if (deliveryManager)
+        deliveryManager->setOccluded(isActive(FaultEvent::Occlusion));
+    if (cgmSensor) {
+        cgmSensor->setSignalLost(isActive(FaultEvent::CGMDropout));
+        cgmSensor->setReadingOffset(-activeMagnitude[FaultEvent::CompressionLow]);
+    }
+    if (battery)
+        battery->setSag(static_cast<int>(std::lround(activeMagnitude[FaultEvent::BatterySag])));
+}
+
+const char* FaultInjector::kindName(FaultEvent::Kind kind) {
+    switch (kind) {
+        case FaultEvent::Occlusion:      return "Occlusion";
+        case FaultEvent::CGMDropout:     return "CGM dropout";
+        case FaultEvent::CompressionLow: return "Compression low";
+        case FaultEvent::BatterySag:     return "Battery sag";
+        case FaultEvent::CartridgeLeak:  return "Cartridge leak";
+        case FaultEvent::KindCount:      break;
+    }
+    return "Unknown";
+}
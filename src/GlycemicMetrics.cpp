@@ -0,0 +1,80 @@
+#include "GlycemicMetrics.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const double kMgdlPerMmol = 18.0182;
+}
+
+GlycemicMetrics::GlycemicMetrics() {
+    reset();
+}
+
+void GlycemicMetrics::reset() {
+    count = 0;
+    minutes = 0.0;
+    mean = 0.0;
+    m2 = 0.0;
+    minBG = 0.0;
+    maxBG = 0.0;
+    inRangeMinutes = 0.0;
+    belowMinutes = 0.0;
+    veryLowMinutes = 0.0;
+    aboveMinutes = 0.0;
+    lowRiskSum = 0.0;
+    highRiskSum = 0.0;
+    totalInsulin = 0.0;
+    elapsedMinutes = 0.0;
+}
+
+void GlycemicMetrics::addReading(double bg, double span) {
+    ++count;
+    minutes += span;
+
+    double delta = bg - mean;
+    mean += delta / count;
+    m2 += delta * (bg - mean);
+
+    minBG = count == 1 ? bg : std::min(minBG, bg);
+    maxBG = count == 1 ? bg : std::max(maxBG, bg);
+
+    if (bg < kRangeLow) {
+        belowMinutes += span;
+        if (bg < kVeryLow)
+            veryLowMinutes += span;
+    } else if (bg > kRangeHigh) {
+        aboveMinutes += span;
+    } else {
+        inRangeMinutes += span;
+    }
+
+    // Kovatchev risk on the mg/dL scale (clamped to avoid log of non-positive values)
+    double mgdl = std::max(bg * kMgdlPerMmol, 1.0);
+    double f = 1.509 * (std::pow(std::log(mgdl), 1.084) - 5.381);
+    double risk = 10.0 * f * f;
+    if (f < 0.0)
+        lowRiskSum += risk;
+    else
+        highRiskSum += risk;
+}
+
+void GlycemicMetrics::addInsulin(double units, double span) {
+    totalInsulin += units;
+    elapsedMinutes += span;
+}
+
+double GlycemicMetrics::getSD() const {
+    return count > 1 ? std::sqrt(m2 / (count - 1)) : 0.0;
+}
+
+double GlycemicMetrics::getCV() const {
+    return count > 1 && mean > 0.0 ? 100.0 * getSD() / mean : 0.0;
+}
+
+double GlycemicMetrics::getGMI() const {
+    return count ? 3.31 + 0.02392 * mean * kMgdlPerMmol : 0.0;
+}
+
+double GlycemicMetrics::getTotalDailyInsulin() const {
+    return elapsedMinutes > 0.0 ? totalInsulin * (24.0 * 60.0) / elapsedMinutes : 0.0;
+}
@@ -2,153 +2,322 @@
 #include "BolusCalculator.h"
 #include "Battery.h"
 #include "Cartridge.h"
+#include "PumpEvents.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
 #include <iostream>
 
+using InsulinUnits::fromUnits;
+using InsulinUnits::toUnits;
+using InsulinUnits::floorToStroke;
+using InsulinUnits::kStroke;
+
+namespace {
+const std::int64_t kMsPerHour = 3600000;
+const MicroUnits kIOBDecayPerMinute = 50000;   // 0.05 U/min (3 U/hour)
+}
+
 InsulinDeliveryManager::InsulinDeliveryManager()
     : currentBasalRate(0.0),
-      insulinOnBoard(0.0),
+      insulinOnBoard(0),
       basalRunning(false),
       previousBasalRate(0.0),
+      totalDelivered(0),
+      basalPending(0),
+      basalAccrualRem(0),
+      basalSource(DoseSource::Manual),
+      simulatedTime(0.0),
+      occluded(false),
+      occlusionDetected(false),
+      blockedSinceOcclusion(0),
+      strokeCount(0),
       bolusCalculator(nullptr),
       battery(nullptr),
-      cartridge(nullptr) {}
+      cartridge(nullptr),
+      eventBus(nullptr),
+      publishedIOB(-1),
+      extendedSlots(),
+      scheduledRemaining(0),
+      pendingBoluses(),
+      pendingHead(0),
+      bolusOutcomes(),
+      failedBolusOutcomes(0) {}
 
 InsulinDeliveryManager::~InsulinDeliveryManager() {
     // Nothing dynamically owned directly here
 }
 
-// Handles a quick/immediate bolus (or error if extended params omitted)
-void InsulinDeliveryManager::deliverBolus(double amount, bool extended, double duration) {
-    if (!cartridge) {
-        std::cout << "[Error] No cartridge present.\n";
-        return;
-    }
-    if (cartridge->getCurrentVolume() < amount) {
-        std::cout << "[Error] Insufficient insulin. Bolus canceled.\n";
-        return;
-    }
-
-    if (!extended) {
-        if (!cartridge->useInsulin(amount)) {
-            std::cout << "[Error] Cartridge usage failed. Bolus not delivered.\n";
-            return;
+// Draws an exact amount from the cartridge (unreserved or, for splits, reserved insulin) and books
+// it against IOB, the total and the ledger
+bool InsulinDeliveryManager::deliverFromCartridge(MicroUnits amount, DoseType type, DoseSource source,
+                                                  bool fromReservation) {
+    if (occluded) {
+        strokeCount += static_cast<std::uint64_t>(amount / kStroke);   // Motor runs against the blockage
+        blockedSinceOcclusion += amount;
+        std::cout << "[Error] Delivery blocked: line occluded.\n";
+        if (!occlusionDetected && blockedSinceOcclusion >= kOcclusionThreshold) {
+            occlusionDetected = true;
+            std::cout << "[Error] Occlusion detected. Insulin delivery suspended.\n";
+            stopBasalDelivery();
+            if (eventBus)
+                eventBus->publish(OcclusionEvent{ true });
         }
-        insulinOnBoard += amount;
-        std::cout << "[Bolus] Delivered immediate bolus of " << amount << " units.\n";
-    } else {
-        std::cout << "[Error] Extended bolus parameters not provided.\n";
+        return false;
     }
+    if (!(fromReservation ? cartridge->commitReserved(amount) : cartridge->useMicroUnits(amount)))
+        return false;
+    insulinOnBoard += amount;
+    totalDelivered += amount;
+    publishIOBIfChanged();
+    strokeCount += static_cast<std::uint64_t>(amount / kStroke);
+    if (amount > 0)
+        doseLedger.record(simulatedTime, amount, type, source);
+    return true;
 }
 
-// Handles extended bolus: immediate portion + scheduled split delivery
-void InsulinDeliveryManager::deliverBolus(double totalDose, bool extended, double immediateAmount, double duration, int splits) {
-    if (!extended) {
-        deliverBolus(totalDose, false, 0.0);
-        return;
+// The single bolus path: validate, check the cartridge, give the immediate part, queue the splits
+BolusStatus InsulinDeliveryManager::submitBolus(const BolusRequest& request) {
+    if (!std::isfinite(request.totalUnits) || request.totalUnits < 0.0) {
+        std::cout << "[Error] Invalid bolus amount.\n";
+        return BolusStatus::InvalidRequest;
     }
-
-    if (!cartridge) {
-        std::cout << "[Error] No cartridge present.\n";
-        return;
-    }
-    if (immediateAmount > totalDose) {
+    const bool hasSplits = request.kind != BolusRequest::Immediate;
+    if (request.kind == BolusRequest::DualWave &&
+        (!std::isfinite(request.immediateUnits) || request.immediateUnits > request.totalUnits)) {
         std::cout << "[Error] Immediate portion exceeds total dose.\n";
-        return;
+        return BolusStatus::InvalidRequest;
     }
-    if (splits <= 0) {
+    if (hasSplits && request.splits <= 0) {
         std::cout << "[Error] Invalid split count.\n";
-        return;
+        return BolusStatus::InvalidRequest;
+    }
+    if (hasSplits && !(std::isfinite(request.durationMinutes) && request.durationMinutes >= 0.0)) {
+        std::cout << "[Error] Invalid extended duration.\n";
+        return BolusStatus::InvalidRequest;
+    }
+    if (!cartridge) {
+        std::cout << "[Error] No cartridge present.\n";
+        return BolusStatus::NoCartridge;
+    }
+    // No cartridge holds more than its capacity, so a larger dose is a bad request, not a shortage
+    if (request.totalUnits > cartridge->getCapacity()) {
+        std::cout << "[Error] Bolus amount exceeds cartridge capacity.\n";
+        return BolusStatus::InvalidRequest;
     }
 
-    if (!cartridge->useInsulin(immediateAmount)) {
-        std::cout << "[Error] Failed to deliver immediate portion.\n";
-        return;
+    MicroUnits total = floorToStroke(fromUnits(request.totalUnits));
+    MicroUnits immediate = total;
+    if (request.kind == BolusRequest::Extended)
+        immediate = 0;
+    else if (request.kind == BolusRequest::DualWave)
+        immediate = std::min(total, floorToStroke(std::max<MicroUnits>(0, fromUnits(request.immediateUnits))));
+    MicroUnits extendedPart = total - immediate;
+
+    // Insulin reserved for queued splits is not available to this bolus
+    if (cartridge->getAvailableMicroUnits() < total) {
+        std::cout << "[Error] Insufficient insulin. Bolus canceled.\n";
+        return BolusStatus::InsufficientInsulin;
     }
 
-    insulinOnBoard += immediateAmount;
-    std::cout << "[Bolus] Delivered immediate portion of " << immediateAmount << " units.\n";
+    ExtendedBolusSlot* slot = nullptr;
+    if (extendedPart > 0) {
+        for (ExtendedBolusSlot& candidate : extendedSlots) {
+            if (!candidate.active) {
+                slot = &candidate;
+                break;
+            }
+        }
+        if (!slot) {
+            std::cout << "[Error] Too many extended boluses running. Bolus canceled.\n";
+            return BolusStatus::Busy;
+        }
+    }
 
-    double remainingDose = totalDose - immediateAmount;
-    double perSplit = remainingDose / splits;
-    double interval = duration / splits;
+    // Commit the whole plan up front: the splits are reserved before the immediate part is drawn.
+    // The availability check above covers the reservation, so failing here means the cartridge
+    // changed underneath us; refuse the plan rather than schedule unreserved splits.
+    if (slot && !cartridge->reserve(extendedPart)) {
+        std::cout << "[Error] Could not reserve insulin for extended doses. Bolus canceled.\n";
+        return BolusStatus::InsufficientInsulin;
+    }
+    if (request.kind != BolusRequest::Extended) {
+        if (!deliverFromCartridge(immediate, DoseType::Bolus, request.source)) {
+            if (slot)
+                cartridge->release(extendedPart);
+            std::cout << "[Error] Cartridge usage failed. Bolus not delivered.\n";
+            return BolusStatus::DeliveryFailed;
+        }
+        std::cout << "[Bolus] Delivered " << (hasSplits ? "immediate portion of " : "immediate bolus of ")
+                  << toUnits(immediate) << " units.\n";
+    }
 
-    for (int i = 1; i <= splits; ++i) {
-        extendedSchedule.push_back({ perSplit, i * interval });
+    if (!hasSplits)
+        return BolusStatus::Delivered;
+    if (!slot) {
+        std::cout << "[Bolus] Nothing left to extend.\n";
+        return BolusStatus::Delivered;
     }
 
-    std::cout << "[Bolus] Scheduled " << remainingDose << " units across " << splits
-              << " splits (" << perSplit << " U every " << interval << " min).\n";
+    // Whole strokes per split; leftover strokes go to the earliest splits
+    MicroUnits strokes = extendedPart / kStroke;
+    double startTime = request.startTime < 0.0 ? simulatedTime : request.startTime;
+    slot->active = true;
+    slot->baseDose = (strokes / request.splits) * kStroke;
+    slot->extraStrokeSplits = static_cast<int>(strokes % request.splits);
+    slot->splits = request.splits;
+    slot->delivered = 0;
+    slot->startTime = startTime;
+    slot->interval = request.durationMinutes / request.splits;
+    scheduledRemaining += extendedPart;
+
+    std::cout << "[Bolus] Scheduled " << toUnits(extendedPart) << " units across " << request.splits
+              << " splits (" << toUnits(extendedPart) / request.splits << " U every " << slot->interval
+              << " min starting at t=" << startTime << ").\n";
+    return BolusStatus::Scheduled;
 }
 
-// CLI-only: Extended bolus with explicit simulation time for debug output
-void InsulinDeliveryManager::deliverBolus(double totalDose, bool extended, double immediateAmount, double duration, int splits, double currentSimTime) {
-    if (!extended) {
-        deliverBolus(totalDose, false, 0.0);
-        return;
-    }
+// Same request rules as submitBolus(), without logging; cartridge contents are checked on submission
+BolusStatus InsulinDeliveryManager::checkBatchRequest(const BolusRequest& request) const {
+    if (!std::isfinite(request.totalUnits) || request.totalUnits < 0.0 || !std::isfinite(request.startTime))
+        return BolusStatus::InvalidRequest;
+    if (request.kind == BolusRequest::DualWave &&
+        (!std::isfinite(request.immediateUnits) || request.immediateUnits > request.totalUnits))
+        return BolusStatus::InvalidRequest;
+    if (request.kind != BolusRequest::Immediate &&
+        (request.splits <= 0 || !(std::isfinite(request.durationMinutes) && request.durationMinutes >= 0.0)))
+        return BolusStatus::InvalidRequest;
+    if (!cartridge)
+        return BolusStatus::NoCartridge;
+    if (request.totalUnits > cartridge->getCapacity())
+        return BolusStatus::InvalidRequest;
+    return BolusStatus::Queued;
+}
 
-    if (!cartridge) {
-        std::cout << "[Error] No cartridge present.\n";
+// Merges requests already sorted by (resolved) start time into the pending queue
+void InsulinDeliveryManager::queueSortedBoluses(const BolusRequest* sorted, std::size_t count) {
+    if (count == 0)
         return;
+    if (pendingHead > 0) {   // Drop submitted requests before growing the queue
+        pendingBoluses.erase(pendingBoluses.begin(), pendingBoluses.begin() + pendingHead);
+        pendingHead = 0;
     }
+    std::size_t middle = pendingBoluses.size();
+    pendingBoluses.insert(pendingBoluses.end(), sorted, sorted + count);
+    std::inplace_merge(pendingBoluses.begin(), pendingBoluses.begin() + middle, pendingBoluses.end(),
+                       [](const BolusRequest& a, const BolusRequest& b) { return a.startTime < b.startTime; });
+}
 
-    if (immediateAmount > totalDose) {
-        std::cout << "[Error] Immediate portion exceeds total dose.\n";
-        return;
+void InsulinDeliveryManager::submitBolusBatch(const BolusRequest* requests, std::size_t count, BolusStatus* statuses) {
+    std::vector<PatientBolusRequest> batch(count);
+    for (std::size_t i = 0; i < count; ++i)
+        batch[i] = { this, requests[i] };
+    submitBolusBatch(batch.data(), count, statuses);
+}
+
+// One pass over the batch: validate, resolve start times, stable-sort by (pump, start time) and
+// hand each pump its run of requests
+void InsulinDeliveryManager::submitBolusBatch(const PatientBolusRequest* requests, std::size_t count,
+                                              BolusStatus* statuses) {
+    std::vector<PatientBolusRequest> accepted;
+    accepted.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const PatientBolusRequest& entry = requests[i];
+        if (!entry.patient) {
+            statuses[i] = BolusStatus::InvalidRequest;
+            continue;
+        }
+        BolusRequest request = entry.request;
+        if (request.startTime < 0.0)
+            request.startTime = entry.patient->simulatedTime;
+        statuses[i] = entry.patient->checkBatchRequest(request);
+        if (statuses[i] == BolusStatus::Queued)
+            accepted.push_back({ entry.patient, request });
     }
 
-    if (splits <= 0) {
-        std::cout << "[Error] Invalid split count.\n";
-        return;
+    std::stable_sort(accepted.begin(), accepted.end(), [](const PatientBolusRequest& a, const PatientBolusRequest& b) {
+        if (a.patient != b.patient)
+            return std::less<InsulinDeliveryManager*>()(a.patient, b.patient);
+        return a.request.startTime < b.request.startTime;
+    });
+
+    std::vector<BolusRequest> run;
+    for (std::size_t begin = 0; begin < accepted.size(); ) {
+        std::size_t end = begin;
+        run.clear();
+        while (end < accepted.size() && accepted[end].patient == accepted[begin].patient)
+            run.push_back(accepted[end++].request);
+        accepted[begin].patient->queueSortedBoluses(run.data(), run.size());
+        begin = end;
     }
+}
 
-    if (!cartridge->useInsulin(immediateAmount)) {
-        std::cout << "[Error] Failed to deliver immediate portion.\n";
-        return;
+// Submits queued boluses whose start time has come, in start-time order, recording each outcome
+void InsulinDeliveryManager::processPendingBoluses(double currentSimTime) {
+    while (pendingHead < pendingBoluses.size() && pendingBoluses[pendingHead].startTime <= currentSimTime) {
+        const BolusRequest& request = pendingBoluses[pendingHead++];
+        BolusStatus status = submitBolus(request);
+        BolusOutcome& outcome = bolusOutcomes.push();
+        outcome.tag = request.tag;
+        outcome.startTime = request.startTime;
+        outcome.status = status;
+        if (!bolusSucceeded(status))
+            ++failedBolusOutcomes;
     }
+    if (pendingHead == pendingBoluses.size()) {
+        pendingBoluses.clear();
+        pendingHead = 0;
+    }
+}
 
-    insulinOnBoard += immediateAmount;
-    std::cout << "[Bolus] Delivered immediate portion of " << immediateAmount << " units.\n";
+std::size_t InsulinDeliveryManager::getPendingBolusCount() const {
+    return pendingBoluses.size() - pendingHead;
+}
 
-    double remainingDose = totalDose - immediateAmount;
-    double perSplit = remainingDose / splits;
-    double interval = duration / splits;
+const FixedRing<BolusOutcome, InsulinDeliveryManager::kMaxBolusOutcomes>& InsulinDeliveryManager::getBolusOutcomes() const {
+    return bolusOutcomes;
+}
 
-    for (int i = 1; i <= splits; ++i) {
-        double scheduled = currentSimTime + i * interval;
-        extendedSchedule.push_back({ perSplit, scheduled });
-    }
+std::uint64_t InsulinDeliveryManager::getFailedBolusOutcomeCount() const {
+    return failedBolusOutcomes;
+}
 
-    std::cout << "[Bolus] Scheduled " << remainingDose << " units across " << splits
-              << " splits (" << perSplit << " U every " << interval << " min starting at t=" << currentSimTime << ").\n";
+void InsulinDeliveryManager::clearBolusOutcomes() {
+    bolusOutcomes.clear();
+    failedBolusOutcomes = 0;
 }
 
-// Executes scheduled bolus segments based on simulation time
+// Executes scheduled bolus splits that are due at this simulation time
 void InsulinDeliveryManager::processScheduledExtendedDoses(double currentSimTime) {
-    for (auto it = extendedSchedule.begin(); it != extendedSchedule.end(); ) {
-        if (currentSimTime >= it->scheduledTime) {
-            if (!cartridge) {
-                std::cout << "[Error] No cartridge during scheduled delivery.\n";
-                it = extendedSchedule.erase(it);
+    for (ExtendedBolusSlot& slot : extendedSlots) {
+        while (slot.active && currentSimTime >= slot.startTime + (slot.delivered + 1) * slot.interval) {
+            MicroUnits dose = slot.baseDose + (slot.delivered < slot.extraStrokeSplits ? kStroke : 0);
+            ++slot.delivered;
+            scheduledRemaining -= dose;
+            if (slot.delivered == slot.splits)
+                slot.active = false;
+            if (dose == 0)
                 continue;
-            }
 
-            if (cartridge->useInsulin(it->dose)) {
-                insulinOnBoard += it->dose;
+            if (!cartridge) {
+                std::cout << "[Error] No cartridge during scheduled delivery.\n";
+            } else if (deliverFromCartridge(dose, DoseType::Bolus, DoseSource::Extended, true)) {
                 std::cout << "[Bolus] Delivered scheduled extended dose of "
-                          << it->dose << " units at t=" << currentSimTime << " min.\n";
+                          << toUnits(dose) << " units at t=" << currentSimTime << " min.\n";
             } else {
+                cartridge->release(dose);
                 std::cout << "[Error] Failed to deliver scheduled extended dose.\n";
             }
-            it = extendedSchedule.erase(it);
-        } else {
-            ++it;
         }
     }
 }
 
+MicroUnits InsulinDeliveryManager::getScheduledBolusMicroUnits() const {
+    return scheduledRemaining;
+}
+
 // Begins continuous basal delivery
-void InsulinDeliveryManager::startBasalDelivery(double rate) {
+void InsulinDeliveryManager::startBasalDelivery(double rate, DoseSource source) {
     if (!battery || battery->getLevel() < 20) {
         std::cout << "[Error] Battery too low.\n";
         return;
@@ -161,6 +330,10 @@ void InsulinDeliveryManager::startBasalDelivery(double rate) {
         std::cout << "[Error] Invalid basal rate.\n";
         return;
     }
+    if (occlusionDetected) {
+        std::cout << "[Error] Occlusion detected. Basal not started.\n";
+        return;
+    }
 
     if (basalRunning) {
         if (std::abs(currentBasalRate - rate) < 0.0001) {
@@ -171,6 +344,7 @@ void InsulinDeliveryManager::startBasalDelivery(double rate) {
     }    
 
     currentBasalRate = rate;
+    basalSource = source;
     basalRunning = true;
     std::cout << "[Basal] Rate: " << rate << " U/hr.\n";
 }
@@ -185,7 +359,7 @@ void InsulinDeliveryManager::resumeBasalDelivery() {
         std::cout << "[Warning] Basal already running.\n";
         return;
     }
-    if (currentBasalRate <= 0.0 || !battery || !cartridge || cartridge->getCurrentVolume() < 1.0) {
+    if (currentBasalRate <= 0.0 || !battery || !cartridge || cartridge->getCurrentVolume() < 1.0 || occlusionDetected) {
         std::cout << "[Error] Cannot resume basal — invalid state.\n";
         return;
     }
@@ -196,17 +370,17 @@ void InsulinDeliveryManager::resumeBasalDelivery() {
 
 // Simulates IOB decay based on elapsed time
 void InsulinDeliveryManager::updateIOB(double elapsedTime) {
-    double decayRate = 0.05; // 3U/hour
-    double decay = decayRate * elapsedTime;
+    MicroUnits decay = static_cast<MicroUnits>(std::llround(kIOBDecayPerMinute * elapsedTime));
 
-    insulinOnBoard = std::max(0.0, insulinOnBoard - decay);
+    insulinOnBoard = std::max<MicroUnits>(0, insulinOnBoard - decay);
+    publishIOBIfChanged();
 
-    std::cout << "[IOB] Current insulin on board: " << insulinOnBoard << " units.\n";
+    std::cout << "[IOB] Current insulin on board: " << toUnits(insulinOnBoard) << " units.\n";
 }
 
 // Returns true if cartridge has enough insulin
 bool InsulinDeliveryManager::hasSufficientInsulin(double requiredUnits) {
-    return cartridge && (cartridge->getCurrentVolume() >= requiredUnits);
+    return cartridge && (cartridge->getAvailableMicroUnits() >= fromUnits(requiredUnits));
 }
 
 // Called every tick: handles basal dose and IOB update
@@ -219,10 +393,21 @@ void InsulinDeliveryManager::onTick(double elapsedTime) {
     }
 
     if (basalRunning) {
-        double dose = currentBasalRate * (elapsedTime / 60.0); // U per tick
-        if (cartridge->useInsulin(dose)) {
-            insulinOnBoard += dose;
-            std::cout << "[Basal] Delivered " << dose << " units.\n";
+        // Exact accrual: rate (uU/hr) * elapsed (ms), with the sub-microunit remainder carried
+        std::int64_t elapsedMs = std::llround(elapsedTime * 60000.0);
+        basalAccrualRem += fromUnits(currentBasalRate) * elapsedMs;
+        basalPending += basalAccrualRem / kMsPerHour;
+        basalAccrualRem %= kMsPerHour;
+
+        MicroUnits dose = floorToStroke(basalPending);
+        if (dose == 0) {
+            std::cout << "[Basal] Accrued " << toUnits(basalPending) << " units (below one stroke).\n";
+            return;
+        }
+        // Missed strokes are not made up later; only the sub-stroke carry survives a failure
+        basalPending -= dose;
+        if (deliverFromCartridge(dose, DoseType::Basal, basalSource)) {
+            std::cout << "[Basal] Delivered " << toUnits(dose) << " units.\n";
         } else {
             std::cout << "[Error] Failed basal delivery.\n";
         }
@@ -233,12 +418,66 @@ void InsulinDeliveryManager::onTick(double elapsedTime) {
 double InsulinDeliveryManager::getCurrentBasalRate() const { return currentBasalRate; }
 void InsulinDeliveryManager::setCurrentBasalRate(double rate) { currentBasalRate = rate; }
 
-double InsulinDeliveryManager::getInsulinOnBoard() const { return insulinOnBoard; }
-void InsulinDeliveryManager::setInsulinOnBoard(double iob) { insulinOnBoard = iob; }
+double InsulinDeliveryManager::getInsulinOnBoard() const { return toUnits(insulinOnBoard); }
+double InsulinDeliveryManager::getTotalDelivered() const { return toUnits(totalDelivered); }
+MicroUnits InsulinDeliveryManager::getTotalDeliveredMicroUnits() const { return totalDelivered; }
+const DoseLedger& InsulinDeliveryManager::getDoseLedger() const { return doseLedger; }
+std::uint64_t InsulinDeliveryManager::getStrokeCount() const { return strokeCount; }
+void InsulinDeliveryManager::setSimulatedTime(double minutes) { simulatedTime = minutes; }
+void InsulinDeliveryManager::setOccluded(bool blocked) {
+    occluded = blocked;
+    if (!blocked) {
+        bool wasDetected = occlusionDetected;
+        occlusionDetected = false;
+        blockedSinceOcclusion = 0;
+        if (wasDetected && eventBus)
+            eventBus->publish(OcclusionEvent{ false });
+    }
+}
+
+bool InsulinDeliveryManager::isOcclusionDetected() const { return occlusionDetected; }
+void InsulinDeliveryManager::setInsulinOnBoard(double iob) {
+    insulinOnBoard = fromUnits(iob);
+    publishIOBIfChanged();
+}
 
 bool InsulinDeliveryManager::isBasalRunning() const { return basalRunning; }
 void InsulinDeliveryManager::setBasalRunning(bool running) { basalRunning = running; }
 
-void InsulinDeliveryManager::setCartridge(Cartridge* cart) { cartridge = cart; }
+// Moves the split reservations to the new cartridge; splits it cannot cover are cancelled
+void InsulinDeliveryManager::setCartridge(Cartridge* cart) {
+    if (cart == cartridge)
+        return;
+    if (cartridge)
+        cartridge->release(scheduledRemaining);
+    cartridge = cart;
+    if (scheduledRemaining > 0 && !(cartridge && cartridge->reserve(scheduledRemaining))) {
+        std::cout << "[Error] Cartridge cannot cover scheduled extended doses. Extended bolus canceled.\n";
+        for (ExtendedBolusSlot& slot : extendedSlots)
+            slot.active = false;
+        scheduledRemaining = 0;
+    }
+}
 void InsulinDeliveryManager::setBolusCalculator(BolusCalculator* bc) { bolusCalculator = bc; }
 void InsulinDeliveryManager::setBattery(Battery* bat) { battery = bat; }
+
+void InsulinDeliveryManager::setEventBus(PumpEventBus* bus) {
+    eventBus = bus;
+    publishedIOB = -1;
+}
+
+// Sends IOB and occlusion state even if unchanged (e.g. when a simulation starts)
+void InsulinDeliveryManager::publishState() {
+    if (!eventBus)
+        return;
+    publishedIOB = -1;
+    publishIOBIfChanged();
+    eventBus->publish(OcclusionEvent{ occlusionDetected });
+}
+
+void InsulinDeliveryManager::publishIOBIfChanged() {
+    if (eventBus && insulinOnBoard != publishedIOB) {
+        publishedIOB = insulinOnBoard;
+        eventBus->publish(IOBChangedEvent{ insulinOnBoard });
+    }
+}
@@ -17,14 +17,32 @@
 #include "Cartridge.h"
 #include "ControlIQController.h"
 #include "AlertManager.h"
+#include "SimulationWorker.h"
 
 #include <QListWidget>
 #include <QFormLayout>
 #include <QDoubleSpinBox>
+#include <QComboBox>
+#include <QHBoxLayout>
 
 #include <QtCharts/QValueAxis>
 QT_CHARTS_USE_NAMESPACE
 
+#include <algorithm>
+
+namespace {
+// BG graph zoom levels in simulated minutes (0 = whole history)
+const int kBGZoomWindows[] = { 30, 120, 360, 1440, 4320, 10080, 0 };
+const int kBGZoomCount = sizeof(kBGZoomWindows) / sizeof(kBGZoomWindows[0]);
+const std::size_t kBGChartMaxPoints = 600;  // Roughly one point per horizontal pixel
+
+// Time-warp multipliers offered in the speed box (0 = as fast as the simulation can run)
+const int kSimSpeeds[] = { 1, 2, 5, 10, 30, 60, 300, 0 };
+const int kSimSpeedCount = sizeof(kSimSpeeds) / sizeof(kSimSpeeds[0]);
+
+const int kAlarmSnoozeMinutes = 15;
+const std::size_t kHistoryAlertCount = 32;   // Newest alert history entries on the history page
+}
 
 
 MergedMainWindow::MergedMainWindow(PumpSimulator* simulator, ProfileManager* mgr, QWidget* parent)
@@ -72,6 +90,7 @@ MergedMainWindow::MergedMainWindow(PumpSimulator* simulator, ProfileManager* mgr
     QWidget* container = new QWidget(this);
     QVBoxLayout* layout = new QVBoxLayout(container);
     layout->addWidget(simTimeLabel);
+    layout->addWidget(setupTimeWarpControls());
     layout->addWidget(stackedWidget);
     container->setLayout(layout);
     setCentralWidget(container);
@@ -80,20 +99,30 @@ MergedMainWindow::MergedMainWindow(PumpSimulator* simulator, ProfileManager* mgr
     setWindowTitle("Insulin Pump Simulator");
     resize(480, 320);
 
-    // Timer for simulation tick
-    simulationTimer = new QTimer(this);
-    connect(simulationTimer, &QTimer::timeout, this, &MergedMainWindow::onSimulationTick);
-    simulationTimer->start(2000);  // 1 simulated minute = 2 real seconds
-
-    // Start backend simulation
+    // Start backend simulation on its own thread: 1 simulated minute = 2 real seconds
     if (pumpSimulator) {
         pumpSimulator->startSimulation();
+        simulationWorker = new SimulationWorker(pumpSimulator);
+        simulationWorker->start(2000);
+
+        // Navigating wakes the pump screen, which the battery model charges for
+        connect(stackedWidget, &QStackedWidget::currentChanged, this, [this]() {
+            simulationWorker->post([this]() { if (battery) battery->wakeScreen(); });
+        });
     }
+
+    // Repaint from the latest published snapshot at ~30 fps, independent of the tick rate
+    frameTimer = new QTimer(this);
+    connect(frameTimer, &QTimer::timeout, this, &MergedMainWindow::onFrameTick);
+    frameTimer->start(33);
 }
 
 
 MergedMainWindow::~MergedMainWindow() 
 {
+    // Stop the simulation thread before anything it touches is deleted
+    delete simulationWorker;
+
     delete dataLogger;
     delete crudController;
     delete bolusManager;
@@ -104,42 +133,135 @@ MergedMainWindow::~MergedMainWindow()
 }
 
 
-void MergedMainWindow::onSimulationTick()
+QWidget* MergedMainWindow::setupTimeWarpControls()
+{
+    QWidget* row = new QWidget(this);
+    QHBoxLayout* rowLayout = new QHBoxLayout(row);
+    rowLayout->setContentsMargins(0, 0, 0, 0);
+
+    pauseButton = new QPushButton("Pause", row);
+    stepButton = new QPushButton("Step", row);
+    stepButton->setEnabled(false);  // Only meaningful while paused
+
+    speedCombo = new QComboBox(row);
+    for (int i = 0; i < kSimSpeedCount; ++i)
+        speedCombo->addItem(kSimSpeeds[i] ? QString::number(kSimSpeeds[i]) + "x" : QString("Max"));
+
+    rowLayout->addWidget(pauseButton);
+    rowLayout->addWidget(stepButton);
+    rowLayout->addWidget(new QLabel("Speed:", row));
+    rowLayout->addWidget(speedCombo);
+
+    connect(pauseButton, &QPushButton::clicked, this, &MergedMainWindow::togglePause);
+    connect(stepButton, &QPushButton::clicked, this, [this]() {
+        if (simulationWorker)
+            simulationWorker->step();
+    });
+    connect(speedCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MergedMainWindow::setSimulationSpeed);
+
+    return row;
+}
+
+void MergedMainWindow::setSimulationSpeed(int index)
+{
+    if (simulationWorker && index >= 0 && index < kSimSpeedCount)
+        simulationWorker->setSpeed(kSimSpeeds[index]);
+}
+
+void MergedMainWindow::togglePause()
 {
-    // Advance simulation time by 1 simulated minute (every 2 real seconds)
-    simulationTime = simulationTime.addSecs(60);
-    simTimeLabel->setText(simulationTime.toString("hh:mm"));
+    if (!simulationWorker)
+        return;
+
+    bool pausing = !simulationWorker->isPaused();
+    if (pausing)
+        simulationWorker->pause();
+    else
+        simulationWorker->resume();
 
-    // Update backend with GUI time
-    static int tickCount = 0;
-    ++tickCount;
+    pauseButton->setText(pausing ? "Resume" : "Pause");
+    stepButton->setEnabled(pausing);
+}
 
-    pumpSimulator->setGUISimTime(tickCount);
-    pumpSimulator->updateSimulationState();
+void MergedMainWindow::onFrameTick()
+{
+    if (!simulationWorker)
+        return;
+
+    // Every tick's BG reading, however many ticks ran since the last frame
+    drainBGSamples();
+
+    // Labels only need the newest state; intermediate snapshots are skipped at high speed
+    if (simulationWorker->pollSnapshot()) {
+        SimulationSnapshot previous = lastSnapshot;
+        lastSnapshot = simulationWorker->latestSnapshot();
+        applySnapshot(lastSnapshot, snapshotApplied ? &previous : nullptr);
+        snapshotApplied = true;
+    }
+
+    // Chart is rebuilt from bounded history only while the graph is on screen
+    if (bgChartDirty && bgGraphPage && stackedWidget->currentWidget() == bgGraphPage)
+        refreshBGChart();
+}
+
+void MergedMainWindow::drainBGSamples()
+{
+    std::size_t drained = simulationWorker->drainBGSamples([this](const BGPoint& sample) {
+        bgHistory.append(sample.minute, sample.bg);
+    });
+    if (drained > 0)
+        bgChartDirty = true;
+}
+
+// Labels are only rewritten for values that changed since the previous snapshot (all on the first)
+void MergedMainWindow::applySnapshot(const SimulationSnapshot& snapshot, const SimulationSnapshot* previous)
+{
+    // Simulation clock (1 tick = 1 simulated minute)
+    simulationTime = QTime(0, 0, 0).addSecs(60 * (snapshot.simMinute % (24 * 60)));
+    int day = snapshot.simMinute / (24 * 60);
+    simTimeLabel->setText(day > 0 ? "Day " + QString::number(day + 1) + "  " + simulationTime.toString("hh:mm")
+                                  : simulationTime.toString("hh:mm"));
 
     // Refresh labels
-    if (iobLabel)
-        iobLabel->setText("IOB: " + QString::number(insulinDeliveryMgr->getInsulinOnBoard(), 'f', 2) + " U");
+    if (iobLabel && (!previous || snapshot.iob != previous->iob))
+        iobLabel->setText("IOB: " + QString::number(snapshot.iob, 'f', 2) + " U");
 
-    if (bgLabel)
-        bgLabel->setText("BG: " + QString::number(cgmInterface->getCurrentBG(), 'f', 1) + " mmol/L");
+    if (bgLabel && (!previous || snapshot.bg != previous->bg || snapshot.bgTrend != previous->bgTrend))
+        bgLabel->setText("BG: " + QString::number(snapshot.bg, 'f', 1) + " mmol/L "
+                         + QString::fromUtf8(CGMTrend::arrowSymbol(snapshot.bgTrend)));
 
-    if (batteryLabel && pumpSimulator->getBattery())
-        batteryLabel->setText("Battery: " + QString::number(pumpSimulator->getBattery()->getLevel()) + "%");
+    if (batteryLabel && (!previous || snapshot.batteryLevel != previous->batteryLevel))
+        batteryLabel->setText("Battery: " + QString::number(snapshot.batteryLevel) + "%");
 
-    if (cartridgeLabel && pumpSimulator->getCartridge())
-        cartridgeLabel->setText("Cartridge: " + QString::number(pumpSimulator->getCartridge()->getCurrentVolume()) + " IU");
+    if (cartridgeLabel && (!previous || snapshot.cartridgeVolume != previous->cartridgeVolume))
+        cartridgeLabel->setText("Cartridge: " + QString::number(snapshot.cartridgeVolume) + " IU");
 
-    if (bgSeries && pumpSimulator) {
-        int time = pumpSimulator->getCurrentSimTime();
-        double bg = cgmInterface->getCurrentBG();
-        bgSeries->append(time, bg);
-    
-        QChart* chart = chartView->chart();
-        QValueAxis* axisX = static_cast<QValueAxis*>(chart->axisX());
-        if (axisX && time > 30)
-            axisX->setRange(time - 30, time); // show last 30 minutes
-    }             
+    if (pumpPage && stackedWidget->currentWidget() == pumpPage)
+        updatePumpStatusLabels();
+
+    if (bgMetricsLabel && stackedWidget->currentWidget() == bgGraphPage)
+        bgMetricsLabel->setText("TIR " + QString::number(snapshot.timeInRangePct, 'f', 0) + "%"
+                                + "  Low " + QString::number(snapshot.timeBelowPct, 'f', 0) + "%"
+                                + "  Mean " + QString::number(snapshot.meanBG, 'f', 1)
+                                + "  CV " + QString::number(snapshot.cvPct, 'f', 0) + "%"
+                                + "  GMI " + QString::number(snapshot.gmiPct, 'f', 1) + "%");
+
+    // Alarms are raised on the simulation thread; notify the user here
+    if (snapshot.alarmSequence > lastAlarmSequence && !alarmPopupOpen) {
+        lastAlarmSequence = snapshot.alarmSequence;
+        alarmPopupOpen = true;
+        const std::string alarmId = snapshot.alarmId;
+        QMessageBox popup(QMessageBox::Warning, "Pump Alert", QString::fromUtf8(snapshot.alarmMessage),
+                          QMessageBox::Ok, this);
+        QPushButton* snoozeBtn = popup.addButton(QString("Snooze %1 min").arg(kAlarmSnoozeMinutes),
+                                                 QMessageBox::ActionRole);
+        popup.exec();
+        if (popup.clickedButton() == snoozeBtn && alertManager) {
+            simulationWorker->post([this, alarmId]() { alertManager->snoozeAlarm(alarmId, kAlarmSnoozeMinutes); });
+        }
+        alarmPopupOpen = false;
+    }
 }
 
 void MergedMainWindow::setupHomePage()
@@ -211,15 +333,17 @@ void MergedMainWindow::setupPumpPage() {
     layout->addWidget(backBtn);
 
     connect(chargeBtn, &QPushButton::clicked, [=]() {
-        Battery* battery = pumpSimulator->getBattery();
-        if (battery) battery->setLevel(100);
-        updatePumpStatusLabels();
+        simulationWorker->post([=]() {
+            Battery* battery = pumpSimulator->getBattery();
+            if (battery) battery->setLevel(100);
+        });
     });
 
     connect(refillBtn, &QPushButton::clicked, [=]() {
-        Cartridge* cart = pumpSimulator->getCartridge();
-        if (cart) cart->refill();  // Assumes you have a refill() method
-        updatePumpStatusLabels();
+        simulationWorker->post([=]() {
+            Cartridge* cart = pumpSimulator->getCartridge();
+            if (cart) cart->refill();  // Assumes you have a refill() method
+        });
     });
 
     connect(backBtn, &QPushButton::clicked, this, &MergedMainWindow::showOptionsPage);
@@ -229,14 +353,14 @@ void MergedMainWindow::setupPumpPage() {
 }
 
 void MergedMainWindow::updatePumpStatusLabels() {
-    if (batteryStatusLabel && pumpSimulator->getBattery()) {
+    if (batteryStatusLabel) {
         batteryStatusLabel->setText("Battery: " +
-            QString::number(pumpSimulator->getBattery()->getLevel()) + "%");
+            QString::number(lastSnapshot.batteryLevel) + "%");
     }
 
-    if (cartridgeStatusLabel && pumpSimulator->getCartridge()) {
+    if (cartridgeStatusLabel) {
         cartridgeStatusLabel->setText("Cartridge: " +
-            QString::number(pumpSimulator->getCartridge()->getCurrentVolume(), 'f', 1) + " IU");
+            QString::number(lastSnapshot.cartridgeVolume, 'f', 1) + " IU");
     }
 }
 
@@ -266,7 +390,44 @@ void MergedMainWindow::updateHistoryList()
     historyList->clear();
     auto events = dataLogger->getEvents();
 
-    if (events.empty()) {
+    // The alert history lives on the simulation thread; copy the newest entries between ticks
+    std::vector<AlertRecord> alertRecords;
+    unsigned long long suppressedAlerts = 0;
+    if (alertManager) {
+        simulationWorker->invoke([&]() {
+            const AlertHistory& history = alertManager->getHistory();
+            std::size_t count = std::min(history.size(), kHistoryAlertCount);
+            for (std::size_t i = history.size() - count; i < history.size(); ++i)
+                alertRecords.push_back(history.at(i));
+            suppressedAlerts = alertManager->getSuppressedCount();
+        });
+    }
+
+    // Newest alerts first
+    for (auto it = alertRecords.rbegin(); it != alertRecords.rend(); ++it) {
+        QString item = QString("t=%1 min  Alert %2 %3 (%4)")
+            .arg(it->minute)
+            .arg(AlertHistory::actionName(it->action))
+            .arg(it->alarmId)
+            .arg(it->severity);
+        if (it->message[0] != '\0')
+            item += QString("  %1").arg(QString::fromUtf8(it->message));
+        historyList->addItem(item);
+    }
+    if (suppressedAlerts > 0)
+        historyList->addItem(QString("%1 repeated alert(s) suppressed").arg(suppressedAlerts));
+
+    // Newest deliveries first, from the dose ledger carried in the latest snapshot
+    for (int i = lastSnapshot.recentDoseCount - 1; i >= 0; --i) {
+        const DoseRecord& dose = lastSnapshot.recentDoses[i];
+        historyList->addItem(QString("t=%1 min  %2 %3 U (%4)")
+            .arg(static_cast<int>(dose.time))
+            .arg(DoseLedger::typeName(dose.type))
+            .arg(InsulinUnits::toUnits(dose.amount), 0, 'f', 2)
+            .arg(DoseLedger::sourceName(dose.source)));
+    }
+
+    if (events.empty() && lastSnapshot.recentDoseCount == 0 && alertRecords.empty()) {
         historyList->addItem("No History Available");
     } else {
         for (const auto& e : events)
@@ -303,11 +464,11 @@ void MergedMainWindow::refreshProfilesList()
     if (!profileList)
         return;
     profileList->clear();
-    auto profiles = profileManager->getAllProfiles();
+    auto names = profileManager->getProfileNames();  // Avoids decoding stored profiles just to list them
     Profile* activeProfile = profileManager->getActiveProfile();
-    for (const auto* profile : profiles) {
-        QListWidgetItem* item = new QListWidgetItem(QString::fromStdString(profile->getName()));
-        if (activeProfile && activeProfile->getName() == profile->getName()) {
+    for (const auto& name : names) {
+        QListWidgetItem* item = new QListWidgetItem(QString::fromStdString(name));
+        if (activeProfile && activeProfile->getName() == name) {
             QPixmap pixmap(10, 10);
             pixmap.fill(Qt::green);
             item->setIcon(QIcon(pixmap));
@@ -356,7 +517,7 @@ void MergedMainWindow::setupProfilesPage()
         if (selected) {
             QString name = selected->text();
             if (QMessageBox::question(this, "Confirm Delete", "Delete profile '" + name + "'?") == QMessageBox::Yes) {
-                profileManager->deleteProfile(name.toStdString());
+                crudController->deleteProfile(name.toStdString());
                 dataLogger->logEvent("ProfileDelete", "Profile " + name.toStdString() + " deleted.");
                 refreshProfilesList();
             }
@@ -553,7 +714,7 @@ void MergedMainWindow::setupBolusInputPage()
     // --- Connections ---
     connect(manualBGButton, &QPushButton::clicked, [=]() {
         bgLineEdit->setReadOnly(false);
-        double currentBG = cgmInterface->getCurrentBG();
+        double currentBG = lastSnapshot.bg;
         bgLineEdit->setText(QString::number(currentBG));
     });
 
@@ -575,11 +736,15 @@ void MergedMainWindow::setupBolusInputPage()
             return;
         }
 
-        double recommendedDose = bolusManager->computeRecommendedDose(bg, carbs);
+        // Runs on the simulation thread so IOB is read between ticks
+        double recommendedDose = 0.0;
+        simulationWorker->invoke([&]() {
+            recommendedDose = bolusManager->computeRecommendedDose(bg, carbs);
+            cgmInterface->addCarbs(carbs);
+        });
         qDebug() << "[Bolus Input] Recommended dose:" << recommendedDose << "units";
         dataLogger->logEvent("BolusCalc", "Recommended bolus: " + std::to_string(recommendedDose));
 
-        cgmInterface->addCarbs(carbs);
         showBolusConfirmationPage(recommendedDose);
     });
 
@@ -623,7 +788,12 @@ void MergedMainWindow::showBolusConfirmationPage(double dose)
                 QString("Deliver immediate bolus of %1 units?").arg(finalDose),
                 QMessageBox::Ok | QMessageBox::Cancel);
             if (ret == QMessageBox::Ok) {
-                bolusManager->deliverBolus(finalDose, false, 0.0);
+                BolusStatus status = BolusStatus::DeliveryFailed;
+                simulationWorker->invoke([&]() { status = bolusManager->submitBolus(BolusRequest::immediate(finalDose)); });
+                if (status != BolusStatus::Delivered) {
+                    QMessageBox::warning(bolusConfirmationPage, "Bolus Not Delivered", bolusStatusName(status));
+                    return;
+                }
                 dataLogger->logEvent("BolusDelivery", "Immediate bolus delivered: " + std::to_string(finalDose));
                 stackedWidget->setCurrentWidget(homePage);
             }
@@ -698,7 +868,15 @@ void MergedMainWindow::showExtendedBolusConfigPage(double dose)
                                 .arg(immediate).arg(remaining).arg(splits).arg(perSplit).arg(duration);
 
             QMessageBox::information(extendedBolusPage, "Extended Bolus", summary);
-            bolusManager->deliverBolus(dose, true, immediate, duration, splits, pumpSimulator->getCurrentSimTime());
+            BolusStatus status = BolusStatus::DeliveryFailed;
+            simulationWorker->invoke([&]() {
+                status = bolusManager->submitBolus(BolusRequest::dualWave(dose, immediate, duration, splits,
+                                                                          pumpSimulator->getCurrentSimTime()));
+            });
+            if (status != BolusStatus::Delivered && status != BolusStatus::Scheduled) {
+                QMessageBox::warning(extendedBolusPage, "Bolus Not Delivered", bolusStatusName(status));
+                return;
+            }
             dataLogger->logEvent("BolusDelivery", "Extended bolus delivered: " + std::to_string(dose));
             stackedWidget->setCurrentWidget(homePage);
         });
@@ -742,7 +920,7 @@ void MergedMainWindow::setupBasalControlPage()
     connect(startBasalBtn, &QPushButton::clicked, [=]() {
         double rate = basalRateSpin->value();
         if (insulinDeliveryMgr) {
-            insulinDeliveryMgr->startBasalDelivery(rate);
+            simulationWorker->post([=]() { insulinDeliveryMgr->startBasalDelivery(rate); });
             QMessageBox::information(basalControlPage, "Basal Control", QString("Basal started at %1 U/hr.").arg(rate));
             dataLogger->logEvent("BasalStart", "Basal started at " + std::to_string(rate) + " U/hr");
             showHomePage();  // optional: auto return
@@ -786,12 +964,75 @@ void MergedMainWindow::setupBGGraphPage() {
     chartView->setRenderHint(QPainter::Antialiasing);
     layout->addWidget(chartView);
 
+    // Outcome so far, filled from each snapshot
+    bgMetricsLabel = new QLabel(bgGraphPage);
+    bgMetricsLabel->setAlignment(Qt::AlignCenter);
+    layout->addWidget(bgMetricsLabel);
+
+    // Zoom controls: step through window sizes up to the whole session
+    QHBoxLayout* zoomLayout = new QHBoxLayout();
+    QPushButton* zoomInBtn = new QPushButton("Zoom In", bgGraphPage);
+    QPushButton* zoomOutBtn = new QPushButton("Zoom Out", bgGraphPage);
+    bgZoomLabel = new QLabel(bgGraphPage);
+    bgZoomLabel->setAlignment(Qt::AlignCenter);
+    zoomLayout->addWidget(zoomInBtn);
+    zoomLayout->addWidget(bgZoomLabel);
+    zoomLayout->addWidget(zoomOutBtn);
+    layout->addLayout(zoomLayout);
+
+    connect(zoomInBtn, &QPushButton::clicked, [=]() { changeBGZoom(-1); });
+    connect(zoomOutBtn, &QPushButton::clicked, [=]() { changeBGZoom(1); });
+
     QPushButton* backBtn = new QPushButton("Back", bgGraphPage);
     layout->addWidget(backBtn);
     connect(backBtn, &QPushButton::clicked, this, &MergedMainWindow::showHomePage);
 
     bgGraphPage->setLayout(layout);
     stackedWidget->addWidget(bgGraphPage);
+    refreshBGChart();
+}
+
+void MergedMainWindow::changeBGZoom(int step)
+{
+    bgZoomIndex = qBound(0, bgZoomIndex + step, kBGZoomCount - 1);
+    refreshBGChart();
+}
+
+// Replaces the series with at most kBGChartMaxPoints points for the current window,
+// so repaint cost stays constant however long the session runs
+void MergedMainWindow::refreshBGChart()
+{
+    if (!bgSeries || !chartView) return;
+    bgChartDirty = false;
+
+    int window = kBGZoomWindows[bgZoomIndex];
+    if (bgZoomLabel)
+        bgZoomLabel->setText(window ? QString("Last %1 h").arg(window / 60.0, 0, 'g', 3) : QString("All"));
+
+    double last = bgHistory.lastMinute();
+    double from = window ? qMax(0.0, last - window) : bgHistory.firstMinute();
+    double to = qMax(last, from + (window ? window : 60));
+
+    std::vector<BGPoint> points;
+    bgHistory.query(from, to, kBGChartMaxPoints, points);
+
+    QVector<QPointF> data;
+    data.reserve(static_cast<int>(points.size()));
+    double minBG = 3.0, maxBG = 10.0;
+    for (const BGPoint& p : points) {
+        data.append(QPointF(p.minute, p.bg));
+        minBG = qMin(minBG, p.bg - 0.5);
+        maxBG = qMax(maxBG, p.bg + 0.5);
+    }
+    bgSeries->replace(data);
+
+    QChart* chart = chartView->chart();
+    QValueAxis* axisX = static_cast<QValueAxis*>(chart->axisX());
+    QValueAxis* axisY = static_cast<QValueAxis*>(chart->axisY());
+    if (axisX)
+        axisX->setRange(from, to);
+    if (axisY)
+        axisY->setRange(minBG, maxBG);
 }
 
 //--------------
@@ -851,8 +1092,8 @@ void MergedMainWindow::showViewProfilePage(Profile* profile)
 }
 void MergedMainWindow::showBolusPage() {
     setupBolusInputPage();  // One-time setup
-    if (bgLineEdit && cgmInterface)
-        bgLineEdit->setText(QString::number(cgmInterface->getCurrentBG()));
+    if (bgLineEdit)
+        bgLineEdit->setText(QString::number(lastSnapshot.bg));
     stackedWidget->setCurrentWidget(bolusInputPage);
 }
 
@@ -866,4 +1107,5 @@ void MergedMainWindow::showBGGraphPage() {
     if (!bgGraphPage)
         setupBGGraphPage();
     stackedWidget->setCurrentWidget(bgGraphPage);
+    refreshBGChart();
 }
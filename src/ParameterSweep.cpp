@@ -0,0 +1,172 @@
+#include "ParameterSweep.h"
+#include "ScenarioRunner.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <numeric>
+#include <ostream>
+#include <random>
+
+namespace {
+const double kSevereHypo = 3.0;
+const int kMaxAxisSteps = 1000;
+
+double& pointValue(SweepPoint& point, SweepAxis::Parameter parameter) {
+    switch (parameter) {
+        case SweepAxis::InsulinToCarbRatio: return point.insulinToCarbRatio;
+        case SweepAxis::CorrectionFactor:   return point.correctionFactor;
+        case SweepAxis::TargetBG:           return point.targetBG;
+        case SweepAxis::BasalScale:         break;
+    }
+    return point.basalScale;
+}
+
+Scenario scenarioFor(const Scenario& base, const SweepPoint& point, unsigned int seed) {
+    Scenario scenario = base;
+    scenario.insulinToCarbRatio = point.insulinToCarbRatio;
+    scenario.correctionFactor = point.correctionFactor;
+    scenario.targetBG = point.targetBG;
+    if (scenario.basalSegments.empty())
+        scenario.basalSegments.push_back({ 0.0, 24.0, 0.8 });
+    for (ScenarioSegment& segment : scenario.basalSegments)
+        segment.unitsPerHour *= point.basalScale;
+    scenario.seed = seed;
+    return scenario;
+}
+}
+
+bool SweepAxis::parse(const std::string& spec, SweepAxis& out) {
+    std::size_t eq = spec.find('=');
+    if (eq == std::string::npos)
+        return false;
+
+    std::string name = spec.substr(0, eq);
+    if (name == "icr")
+        out.parameter = InsulinToCarbRatio;
+    else if (name == "cf")
+        out.parameter = CorrectionFactor;
+    else if (name == "target")
+        out.parameter = TargetBG;
+    else if (name == "basal")
+        out.parameter = BasalScale;
+    else
+        return false;
+
+    const char* p = spec.c_str() + eq + 1;
+    char* end = nullptr;
+    out.min = std::strtod(p, &end);
+    if (end == p || *end != ':')
+        return false;
+    p = end + 1;
+    out.max = std::strtod(p, &end);
+    if (end == p || !std::isfinite(out.min) || !std::isfinite(out.max) || out.max < out.min)
+        return false;
+    // Every parameter divides or scales a dose (ICR, CF), sets a target or scales basal: all must be positive
+    if (out.min <= 0.0)
+        return false;
+    out.steps = 1;
+    if (*end == ':') {
+        p = end + 1;
+        long steps = std::strtol(p, &end, 10);
+        if (end == p || steps < 1 || steps > kMaxAxisSteps)
+            return false;
+        out.steps = static_cast<int>(steps);
+    }
+    return *end == '\0';
+}
+
+std::vector<SweepPoint> ParameterSweep::makePoints(const SweepConfig& config) {
+    const SweepPoint basePoint = { config.base.insulinToCarbRatio, config.base.correctionFactor,
+                                   config.base.targetBG, 1.0 };
+    std::vector<SweepPoint> points;
+
+    if (config.latinHypercube) {
+        const int n = std::max(1, config.samples);
+        points.assign(static_cast<std::size_t>(n), basePoint);
+        std::mt19937 rng(config.designSeed);
+        std::uniform_real_distribution<double> jitter(0.0, 1.0);
+        std::vector<int> strata(static_cast<std::size_t>(n));
+        for (const SweepAxis& axis : config.axes) {
+            std::iota(strata.begin(), strata.end(), 0);
+            std::shuffle(strata.begin(), strata.end(), rng);
+            for (int i = 0; i < n; ++i) {
+                double u = (strata[static_cast<std::size_t>(i)] + jitter(rng)) / n;
+                pointValue(points[static_cast<std::size_t>(i)], axis.parameter) = axis.min + u * (axis.max - axis.min);
+            }
+        }
+        return points;
+    }
+
+    // Full grid, first axis varying slowest
+    points.push_back(basePoint);
+    for (const SweepAxis& axis : config.axes) {
+        std::vector<SweepPoint> expanded;
+        expanded.reserve(points.size() * static_cast<std::size_t>(axis.steps));
+        for (const SweepPoint& point : points) {
+            for (int s = 0; s < axis.steps; ++s) {
+                SweepPoint next = point;
+                pointValue(next, axis.parameter) = axis.steps == 1
+                    ? axis.min : axis.min + s * (axis.max - axis.min) / (axis.steps - 1);
+                expanded.push_back(next);
+            }
+        }
+        points.swap(expanded);
+    }
+    return points;
+}
+
+std::vector<SweepPointResult> ParameterSweep::run(const SweepConfig& config) {
+    const std::vector<SweepPoint> points = makePoints(config);
+    const int seeds = std::max(1, config.seedsPerPoint);
+
+    // Same seed list for every point (common random numbers)
+    std::vector<Scenario> runs;
+    runs.reserve(points.size() * static_cast<std::size_t>(seeds));
+    for (const SweepPoint& point : points) {
+        for (int k = 0; k < seeds; ++k)
+            runs.push_back(scenarioFor(config.base, point, config.base.seed + static_cast<unsigned int>(k)));
+    }
+    const std::vector<ScenarioResult> outcomes = ScenarioRunner::runAll(runs, config.jobs);
+
+    std::vector<SweepPointResult> results;
+    results.reserve(points.size());
+    for (std::size_t p = 0; p < points.size(); ++p) {
+        SweepPointResult r;
+        r.point = points[p];
+        r.runs = seeds;
+        r.lowestBG = outcomes[p * seeds].minBG;
+
+        double tirSum = 0.0, tirSq = 0.0;
+        int severe = 0;
+        for (int k = 0; k < seeds; ++k) {
+            const ScenarioResult& o = outcomes[p * seeds + static_cast<std::size_t>(k)];
+            tirSum += o.timeInRangePct;
+            tirSq += o.timeInRangePct * o.timeInRangePct;
+            r.timeBelowMean += o.timeBelowPct;
+            r.timeAboveMean += o.timeAbovePct;
+            r.meanBG += o.meanBG;
+            r.lowestBG = std::min(r.lowestBG, o.minBG);
+            if (o.minBG < kSevereHypo)
+                ++severe;
+        }
+        r.timeInRangeMean = tirSum / seeds;
+        r.timeInRangeSD = seeds > 1
+            ? std::sqrt(std::max(0.0, (tirSq - tirSum * tirSum / seeds) / (seeds - 1))) : 0.0;
+        r.timeBelowMean /= seeds;
+        r.timeAboveMean /= seeds;
+        r.meanBG /= seeds;
+        r.severeHypoPct = 100.0 * severe / seeds;
+        results.push_back(r);
+    }
+    return results;
+}
+
+void ParameterSweep::writeCsv(std::ostream& out, const std::vector<SweepPointResult>& results) {
+    out << "icr,cf,target,basal_scale,runs,tir_mean,tir_sd,below_mean,above_mean,mean_bg,lowest_bg,severe_hypo_pct\n";
+    for (const SweepPointResult& r : results) {
+        out << r.point.insulinToCarbRatio << ',' << r.point.correctionFactor << ','
+            << r.point.targetBG << ',' << r.point.basalScale << ',' << r.runs << ','
+            << r.timeInRangeMean << ',' << r.timeInRangeSD << ',' << r.timeBelowMean << ','
+            << r.timeAboveMean << ',' << r.meanBG << ',' << r.lowestBG << ',' << r.severeHypoPct << '\n';
+    }
+}
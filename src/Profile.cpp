@@ -15,6 +15,8 @@ Profile::~Profile() {
 bool Profile::isValid() const {
     if (name.empty() || insulinToCarbRatio <= 0 || correctionFactor <= 0 || targetBG <= 0)
         return false;
+    if (!alertSettings.isValid())
+        return false;
 
     // Each basal segment must have valid timing and non-negative insulin rate
     for (const auto& seg : basalSegments) {
@@ -48,5 +50,8 @@ void Profile::setCorrectionFactor(double factor) { correctionFactor = factor; }
 double Profile::getTargetBG() const { return targetBG; }
 void Profile::setTargetBG(double bg) { targetBG = bg; }
 
+const AlertSettings& Profile::getAlertSettings() const { return alertSettings; }
+void Profile::setAlertSettings(const AlertSettings& settings) { alertSettings = settings; }
+
 const std::vector<BasalSegment*>& Profile::getBasalSegments() const { return basalSegments; }
 void Profile::addBasalSegment(BasalSegment* segment) { basalSegments.push_back(segment); }
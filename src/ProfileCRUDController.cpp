@@ -32,6 +32,9 @@ void ProfileCRUDController::updateProfile(const std::string& oldName, const std:
         profile->setTargetBG(tbg);
 
         // NOTE: Basal segments are not updated here – might need a separate method or GUI control
+
+        // Persist only this profile's change (appended to the store, no full rewrite)
+        profileManager->commitProfileEdit(profile, oldName);
     }
 }
 
@@ -1,10 +1,16 @@
 #include "ProfileManager.h"
 #include "Profile.h"
+#include "ProfileStore.h"
+#include "ProfileSnapshot.h"
 #include <iostream>
 #include <algorithm>
 
 // Constructor – start with no active profile
-ProfileManager::ProfileManager() : activeProfile(nullptr) {}
+ProfileManager::ProfileManager()
+    : activeProfile(nullptr),
+      profileStore(nullptr),
+      snapshotVersion(0),
+      publishAtTickBoundary(false) {}
 
 // Destructor – delete all dynamically allocated profiles
 ProfileManager::~ProfileManager() {
@@ -16,7 +22,10 @@ ProfileManager::~ProfileManager() {
 // Adds a new profile to the list if it's valid
 void ProfileManager::createProfile(Profile* newProfile) {
     if (newProfile && newProfile->isValid()) {
+        dropPendingName(newProfile->getName());
         profiles.push_back(newProfile);
+        if (profileStore)
+            profileStore->appendProfile(newProfile);
         std::cout << "Profile '" << newProfile->getName() << "' created.\n";
     } else {
         std::cout << "Invalid profile. Not created.\n";
@@ -28,15 +37,24 @@ Profile* ProfileManager::getProfileByName(const std::string& name) {
     for (auto* profile : profiles)
         if (profile->getName() == name)
             return profile;
-    return nullptr;
+    return loadPendingProfile(name);
 }
 
 // Updates an existing profile by name – replaces and deletes the old one
 void ProfileManager::updateProfile(Profile* updatedProfile) {
+    getProfileByName(updatedProfile->getName()); // Make sure a stored copy is loaded first
+
     for (size_t i = 0; i < profiles.size(); ++i) {
         if (profiles[i]->getName() == updatedProfile->getName()) {
+            bool wasActive = (activeProfile == profiles[i]);
+            if (wasActive)
+                activeProfile = updatedProfile;
             delete profiles[i]; // Delete old profile to avoid memory leak
             profiles[i] = updatedProfile;
+            if (profileStore)
+                profileStore->appendProfile(updatedProfile);
+            if (wasActive)
+                restageActiveSnapshot();
             std::cout << "Profile '" << updatedProfile->getName() << "' updated.\n";
             return;
         }
@@ -44,12 +62,32 @@ void ProfileManager::updateProfile(Profile* updatedProfile) {
     std::cout << "Profile not found for update.\n";
 }
 
+// Persists a profile that was modified in place (e.g. by ProfileCRUDController)
+void ProfileManager::commitProfileEdit(Profile* profile, const std::string& previousName) {
+    if (!profile) return;
+
+    if (profile == activeProfile)
+        restageActiveSnapshot();
+
+    if (!profileStore) return;
+
+    if (previousName != profile->getName()) {
+        profileStore->appendDelete(previousName);
+        if (activeProfile == profile)
+            profileStore->appendActive(profile->getName());
+    }
+    profileStore->appendProfile(profile);
+}
+
 // Deletes a profile by name, resets activeProfile if needed
 void ProfileManager::deleteProfile(const std::string& name) {
+    bool removedActive = false;
     auto it = std::remove_if(profiles.begin(), profiles.end(), [&](Profile* p) {
         if (p->getName() == name) {
-            if (activeProfile == p)
+            if (activeProfile == p) {
                 activeProfile = nullptr;
+                removedActive = true;
+            }
             delete p;
             std::cout << "Profile '" << name << "' deleted.\n";
             return true;
@@ -57,6 +95,13 @@ void ProfileManager::deleteProfile(const std::string& name) {
         return false;
     });
     profiles.erase(it, profiles.end());
+
+    if (removedActive)
+        restageActiveSnapshot();
+
+    dropPendingName(name);
+    if (profileStore)
+        profileStore->appendDelete(name);
 }
 
 // Returns the currently selected profile
@@ -69,13 +114,106 @@ void ProfileManager::setActiveProfile(const std::string& profileName) {
     Profile* found = getProfileByName(profileName);
     if (found) {
         activeProfile = found;
+        restageActiveSnapshot();
+        if (profileStore)
+            profileStore->appendActive(profileName);
         std::cout << "Active profile set to '" << profileName << "'.\n";
     } else {
         std::cout << "Profile not found.\n";
     }
 }
 
-// Returns all profiles (const reference might be better in future)
-std::vector<Profile*> ProfileManager::getAllProfiles() const {
+// Returns all profiles, decoding any that are still pending in the store
+std::vector<Profile*> ProfileManager::getAllProfiles() {
+    while (!pendingNames.empty())
+        loadPendingProfile(pendingNames.front());
     return profiles;
 }
+
+// Returns profile names without forcing stored profiles to be decoded
+std::vector<std::string> ProfileManager::getProfileNames() const {
+    std::vector<std::string> names;
+    names.reserve(profiles.size() + pendingNames.size());
+    for (const auto* profile : profiles)
+        names.push_back(profile->getName());
+    names.insert(names.end(), pendingNames.begin(), pendingNames.end());
+    return names;
+}
+
+// Attaches persistent storage; stored profiles stay encoded until first lookup
+void ProfileManager::setProfileStore(ProfileStore* store) {
+    profileStore = store;
+    pendingNames.clear();
+    if (!profileStore) return;
+
+    for (const std::string& name : profileStore->getProfileNames()) {
+        bool inMemory = std::any_of(profiles.begin(), profiles.end(),
+                                    [&](Profile* p) { return p->getName() == name; });
+        if (!inMemory)
+            pendingNames.push_back(name);
+    }
+
+    std::string storedActive = profileStore->getActiveProfileName();
+    if (!activeProfile && !storedActive.empty()) {
+        activeProfile = getProfileByName(storedActive);
+        if (activeProfile) {
+            restageActiveSnapshot();
+            std::cout << "Active profile restored to '" << storedActive << "'.\n";
+        }
+    }
+}
+
+ProfileStore* ProfileManager::getProfileStore() const {
+    return profileStore;
+}
+
+// Decodes a stored profile on first use; corrupt entries are dropped from the pending list
+Profile* ProfileManager::loadPendingProfile(const std::string& name) {
+    auto it = std::find(pendingNames.begin(), pendingNames.end(), name);
+    if (it == pendingNames.end() || !profileStore)
+        return nullptr;
+    pendingNames.erase(it);
+
+    Profile* loaded = profileStore->loadProfile(name);
+    if (loaded)
+        profiles.push_back(loaded);
+    return loaded;
+}
+
+void ProfileManager::dropPendingName(const std::string& name) {
+    auto it = std::find(pendingNames.begin(), pendingNames.end(), name);
+    if (it != pendingNames.end())
+        pendingNames.erase(it);
+}
+
+// Returns the snapshot readers should use; never blocks on writers
+std::shared_ptr<const ProfileSnapshot> ProfileManager::getActiveSnapshot() const {
+    return std::atomic_load(&publishedSnapshot);
+}
+
+// Swaps the staged snapshot in; the simulator calls this at the start of every tick
+bool ProfileManager::publishStagedSnapshot() {
+    std::shared_ptr<const ProfileSnapshot> staged = std::atomic_load(&stagedSnapshot);
+    if (staged == std::atomic_load(&publishedSnapshot))
+        return false;
+    std::atomic_store(&publishedSnapshot, staged);
+    return true;
+}
+
+// While a simulation is running, edits wait for the next tick; otherwise they apply at once
+void ProfileManager::setPublishAtTickBoundary(bool deferred) {
+    publishAtTickBoundary = deferred;
+    if (!deferred)
+        publishStagedSnapshot();
+}
+
+// Copy-on-write: build a fresh immutable snapshot of the active profile and stage it
+void ProfileManager::restageActiveSnapshot() {
+    std::shared_ptr<const ProfileSnapshot> snapshot;
+    if (activeProfile)
+        snapshot = ProfileSnapshot::fromProfile(*activeProfile, ++snapshotVersion);
+
+    std::atomic_store(&stagedSnapshot, snapshot);
+    if (!publishAtTickBoundary)
+        publishStagedSnapshot();
+}
@@ -0,0 +1,39 @@
+#include "ProfileSnapshot.h"
+#include "Profile.h"
+
+ProfileSnapshot::ProfileSnapshot()
+    : insulinToCarbRatio(0.0), correctionFactor(0.0), targetBG(0.0), version(0) {}
+
+// Deep-copies the profile (including basal segments) into a new immutable snapshot
+std::shared_ptr<const ProfileSnapshot> ProfileSnapshot::fromProfile(const Profile& profile, std::uint64_t version) {
+    std::shared_ptr<ProfileSnapshot> snapshot(new ProfileSnapshot());
+    snapshot->name = profile.getName();
+    snapshot->insulinToCarbRatio = profile.getInsulinToCarbRatio();
+    snapshot->correctionFactor = profile.getCorrectionFactor();
+    snapshot->targetBG = profile.getTargetBG();
+    snapshot->alertSettings = profile.getAlertSettings();
+    snapshot->version = version;
+
+    snapshot->basalSegments.reserve(profile.getBasalSegments().size());
+    for (const BasalSegment* seg : profile.getBasalSegments())
+        snapshot->basalSegments.push_back(*seg);
+
+    return snapshot;
+}
+
+// Same lookup as Profile::getBasalRateForTime, over the copied segments
+double ProfileSnapshot::getBasalRateForTime(double hour) const {
+    for (const auto& segment : basalSegments)
+        if (segment.timeInSegment(hour))
+            return segment.getUnitsPerHour();
+    return 0.0;
+}
+
+// Getters
+const std::string& ProfileSnapshot::getName() const { return name; }
+double ProfileSnapshot::getInsulinToCarbRatio() const { return insulinToCarbRatio; }
+double ProfileSnapshot::getCorrectionFactor() const { return correctionFactor; }
+double ProfileSnapshot::getTargetBG() const { return targetBG; }
+const AlertSettings& ProfileSnapshot::getAlertSettings() const { return alertSettings; }
+const std::vector<BasalSegment>& ProfileSnapshot::getBasalSegments() const { return basalSegments; }
+std::uint64_t ProfileSnapshot::getVersion() const { return version; }
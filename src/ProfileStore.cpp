@@ -0,0 +1,781 @@
+#include "ProfileStore.h"
+#include "Profile.h"
+#include "BasalSegment.h"
+
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char kMagic[4] = { 'I', 'P', 'P', 'S' };
+const std::size_t kFileHeaderSize = 8;      // magic[4] + version(u16) + reserved(u16)
+const std::size_t kRecordHeaderSize = 12;   // kind(u8) + reserved(u8) + nameLen(u16) + payloadLen(u32) + checksum(u32)
+const std::size_t kCompactMinDeadRecords = 64;
+
+enum RecordKind : std::uint8_t {
+    RecordUpsert = 1,
+    RecordDelete = 2,
+    RecordActive = 3
+};
+
+template <typename T>
+void appendPod(std::string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+T readPod(const unsigned char* src) {
+    T value;
+    std::memcpy(&value, src, sizeof(T));
+    return value;
+}
+
+// FNV-1a over name and payload bytes
+std::uint32_t checksum(const unsigned char* data, std::size_t len, std::uint32_t hash = 2166136261u) {
+    for (std::size_t i = 0; i < len; ++i) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Alert thresholds, in AlertSettings field order (format version 2)
+const std::size_t kAlertBlockSize = 7 * sizeof(double);
+
+std::string encodeProfile(const Profile* profile) {
+    std::string payload;
+    appendPod(payload, profile->getInsulinToCarbRatio());
+    appendPod(payload, profile->getCorrectionFactor());
+    appendPod(payload, profile->getTargetBG());
+
+    const auto& segments = profile->getBasalSegments();
+    appendPod(payload, static_cast<std::uint32_t>(segments.size()));
+    for (const BasalSegment* seg : segments) {
+        appendPod(payload, seg->getStartTime());
+        appendPod(payload, seg->getEndTime());
+        appendPod(payload, seg->getUnitsPerHour());
+    }
+
+    const AlertSettings& alerts = profile->getAlertSettings();
+    appendPod(payload, alerts.batteryLowPct);
+    appendPod(payload, alerts.cartridgeLowUnits);
+    appendPod(payload, alerts.bgLow);
+    appendPod(payload, alerts.bgHigh);
+    appendPod(payload, alerts.bgFallRate);
+    appendPod(payload, alerts.bgRiseRate);
+    appendPod(payload, alerts.cgmStaleMinutes);
+    return payload;
+}
+
+bool writeAll(int fd, const char* data, std::size_t len, off_t offset) {
+    while (len > 0) {
+        ssize_t written = ::pwrite(fd, data, len, offset);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        offset += written;
+        len -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+std::string fileHeader() {
+    std::string header(kMagic, sizeof(kMagic));
+    appendPod(header, ProfileStore::kFormatVersion);
+    appendPod(header, static_cast<std::uint16_t>(0));
+    return header;
+}
+
+// --- Minimal JSON reader used by importJson() ---
+
+struct JsonValue {
+    enum Type { Null, Bool, Number, String, Array, Object };
+    Type type = Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string text;
+    std::vector<JsonValue> items;
+    std::vector<std::pair<std::string, JsonValue>> members;
+
+    const JsonValue* find(const std::string& key) const {
+        for (const auto& m : members)
+            if (m.first == key)
+                return &m.second;
+        return nullptr;
+    }
+};
+
+class JsonParser {
+public:
+    explicit JsonParser(const std::string& text) : src(text), pos(0) {}
+
+    bool parse(JsonValue& out) {
+        if (!parseValue(out)) return false;
+        skipWhitespace();
+        return pos == src.size();
+    }
+
+private:
+    void skipWhitespace() {
+        while (pos < src.size() && std::isspace(static_cast<unsigned char>(src[pos])))
+            ++pos;
+    }
+
+    bool consume(char c) {
+        skipWhitespace();
+        if (pos < src.size() && src[pos] == c) {
+            ++pos;
+            return true;
+        }
+        return false;
+    }
+
+    bool parseLiteral(const char* word) {
+        std::size_t len = std::strlen(word);
+        if (src.compare(pos, len, word) != 0) return false;
+        pos += len;
+        return true;
+    }
+
+    bool parseValue(JsonValue& out) {
+        skipWhitespace();
+        if (pos >= src.size()) return false;
+
+        char c = src[pos];
+        if (c == '{') return parseObject(out);
+        if (c == '[') return parseArray(out);
+        if (c == '"') {
+            out.type = JsonValue::String;
+            return parseString(out.text);
+        }
+        if (c == 't' || c == 'f') {
+            out.type = JsonValue::Bool;
+            out.boolean = (c == 't');
+            return parseLiteral(out.boolean ? "true" : "false");
+        }
+        if (c == 'n') {
+            out.type = JsonValue::Null;
+            return parseLiteral("null");
+        }
+
+        const char* begin = src.c_str() + pos;
+        char* end = nullptr;
+        out.number = std::strtod(begin, &end);
+        if (end == begin) return false;
+        out.type = JsonValue::Number;
+        pos += static_cast<std::size_t>(end - begin);
+        return true;
+    }
+
+    bool parseString(std::string& out) {
+        if (src[pos] != '"') return false;
+        ++pos;
+        while (pos < src.size()) {
+            char c = src[pos++];
+            if (c == '"') return true;
+            if (c != '\\') {
+                out.push_back(c);
+                continue;
+            }
+            if (pos >= src.size()) return false;
+            char esc = src[pos++];
+            switch (esc) {
+                case '"':  out.push_back('"'); break;
+                case '\\': out.push_back('\\'); break;
+                case '/':  out.push_back('/'); break;
+                case 'b':  out.push_back('\b'); break;
+                case 'f':  out.push_back('\f'); break;
+                case 'n':  out.push_back('\n'); break;
+                case 'r':  out.push_back('\r'); break;
+                case 't':  out.push_back('\t'); break;
+                case 'u': {
+                    if (pos + 4 > src.size()) return false;
+                    unsigned long code = std::strtoul(src.substr(pos, 4).c_str(), nullptr, 16);
+                    pos += 4;
+                    // Encode BMP code points as UTF-8 (surrogate pairs are not expected in profile names)
+                    if (code < 0x80) {
+                        out.push_back(static_cast<char>(code));
+                    } else if (code < 0x800) {
+                        out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+                        out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+                    } else {
+                        out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+                        out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+                        out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+                    }
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+        return false;
+    }
+
+    bool parseArray(JsonValue& out) {
+        out.type = JsonValue::Array;
+        ++pos;
+        if (consume(']')) return true;
+        do {
+            out.items.emplace_back();
+            if (!parseValue(out.items.back())) return false;
+        } while (consume(','));
+        return consume(']');
+    }
+
+    bool parseObject(JsonValue& out) {
+        out.type = JsonValue::Object;
+        ++pos;
+        if (consume('}')) return true;
+        do {
+            skipWhitespace();
+            std::string key;
+            if (pos >= src.size() || !parseString(key)) return false;
+            if (!consume(':')) return false;
+            out.members.emplace_back(key, JsonValue());
+            if (!parseValue(out.members.back().second)) return false;
+        } while (consume(','));
+        return consume('}');
+    }
+
+    const std::string& src;
+    std::size_t pos;
+};
+
+double numberOr(const JsonValue& obj, const char* key, double fallback) {
+    const JsonValue* v = obj.find(key);
+    return (v && v->type == JsonValue::Number) ? v->number : fallback;
+}
+
+std::string escapeJson(const std::string& in) {
+    std::ostringstream out;
+    for (unsigned char c : in) {
+        switch (c) {
+            case '"':  out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\r': out << "\\r"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if (c < 0x20)
+                    out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+                else
+                    out << c;
+        }
+    }
+    return out.str();
+}
+
+} // namespace
+
+const std::uint16_t ProfileStore::kFormatVersion;
+
+ProfileStore::ProfileStore()
+    : fd(-1), mapped(nullptr), mappedSize(0), fileSize(0), deadRecords(0) {}
+
+ProfileStore::~ProfileStore() {
+    close();
+}
+
+// Opens (or creates) the store file and indexes its records without decoding profiles
+bool ProfileStore::open(const std::string& storePath) {
+    close();
+    path = storePath;
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        std::cout << "[ProfileStore] Cannot open " << path << ": " << std::strerror(errno) << "\n";
+        return false;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        close();
+        return false;
+    }
+    fileSize = static_cast<std::size_t>(st.st_size);
+
+    if (fileSize == 0) {
+        std::string header = fileHeader();
+        if (!writeAll(fd, header.data(), header.size(), 0)) {
+            close();
+            return false;
+        }
+        fileSize = header.size();
+        std::cout << "[ProfileStore] Created empty store at " << path << ".\n";
+        return true;
+    }
+
+    if (!ensureMapped(fileSize) || fileSize < kFileHeaderSize || std::memcmp(mapped, kMagic, sizeof(kMagic)) != 0) {
+        std::cout << "[ProfileStore] " << path << " is not a profile store. Not loaded.\n";
+        close();
+        return false;
+    }
+
+    std::uint16_t version = readPod<std::uint16_t>(mapped + 4);
+    if (version > kFormatVersion) {
+        std::cout << "[ProfileStore] Store version " << version << " is newer than supported ("
+                  << kFormatVersion << "). Not loaded.\n";
+        close();
+        return false;
+    }
+
+    if (!indexRecords()) {
+        close();
+        return false;
+    }
+
+    // Older stores are upgraded in place: their records stay readable, new records use this format
+    if (version < kFormatVersion) {
+        std::string header = fileHeader();
+        if (!writeAll(fd, header.data(), header.size(), 0)) {
+            close();
+            return false;
+        }
+        std::cout << "[ProfileStore] Upgraded " << path << " from format " << version << " to "
+                  << kFormatVersion << ".\n";
+    }
+
+    if (deadRecords > kCompactMinDeadRecords && deadRecords > index.size())
+        compact();
+
+    std::cout << "[ProfileStore] Indexed " << index.size() << " profile(s) from " << path << ".\n";
+    return true;
+}
+
+void ProfileStore::close() {
+    unmap();
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    fileSize = 0;
+    index.clear();
+    order.clear();
+    activeName.clear();
+    deadRecords = 0;
+}
+
+bool ProfileStore::isOpen() const { return fd >= 0; }
+
+// Length of the intact record at offset, or 0 if it is cut short or fails its checksum
+std::size_t ProfileStore::recordLengthAt(std::size_t offset) const {
+    if (offset + kRecordHeaderSize > fileSize) return 0;
+
+    const unsigned char* rec = mapped + offset;
+    std::uint8_t kind = rec[0];
+    std::uint16_t nameLength = readPod<std::uint16_t>(rec + 2);
+    std::uint32_t payloadLength = readPod<std::uint32_t>(rec + 4);
+    std::size_t length = kRecordHeaderSize + nameLength + static_cast<std::size_t>(payloadLength);
+
+    if (kind < RecordUpsert || kind > RecordActive || length > fileSize - offset)
+        return 0;
+    if (checksum(rec + kRecordHeaderSize, length - kRecordHeaderSize) != readPod<std::uint32_t>(rec + 8))
+        return 0;
+    return length;
+}
+
+// Verifies every record; a torn tail (e.g. crash mid-append) is truncated away, but damage
+// with intact records after it leaves the file untouched and the store unopened
+bool ProfileStore::indexRecords() {
+    index.clear();
+    order.clear();
+    activeName.clear();
+    deadRecords = 0;
+
+    std::size_t offset = kFileHeaderSize;
+    bool sawActive = false;
+
+    while (offset < fileSize) {
+        std::size_t length = recordLengthAt(offset);
+        if (length == 0)
+            break;
+
+        const unsigned char* rec = mapped + offset;
+        std::uint8_t kind = rec[0];
+        std::uint16_t nameLength = readPod<std::uint16_t>(rec + 2);
+        std::string name(reinterpret_cast<const char*>(rec + kRecordHeaderSize), nameLength);
+
+        if (kind == RecordUpsert) {
+            auto it = index.find(name);
+            if (it != index.end()) {
+                ++deadRecords;
+                it->second = { offset, length };
+            } else {
+                index[name] = { offset, length };
+                order.push_back(name);
+            }
+        } else if (kind == RecordDelete) {
+            ++deadRecords;
+            if (index.erase(name)) {
+                ++deadRecords;
+                for (auto it = order.begin(); it != order.end(); ++it) {
+                    if (*it == name) {
+                        order.erase(it);
+                        break;
+                    }
+                }
+            }
+        } else {
+            if (sawActive) ++deadRecords;
+            sawActive = true;
+            activeName = name;
+        }
+
+        offset += length;
+    }
+
+    if (offset != fileSize) {
+        // An append is a single write, so a torn one leaves nothing intact behind it
+        for (std::size_t later = offset + 1; later + kRecordHeaderSize <= fileSize; ++later) {
+            if (recordLengthAt(later) != 0) {
+                std::cout << "[ProfileStore] Corrupt record at byte " << offset << " of " << path
+                          << " is followed by intact records. Not loaded.\n";
+                return false;
+            }
+        }
+        std::cout << "[ProfileStore] Discarding " << (fileSize - offset) << " byte(s) of incomplete records.\n";
+        if (::ftruncate(fd, static_cast<off_t>(offset)) != 0)
+            return false;
+        // Remap at the new length; the old mapping must be released with its original size
+        unmap();
+        fileSize = offset;
+        if (!ensureMapped(fileSize))
+            return false;
+    }
+
+    if (!activeName.empty() && index.find(activeName) == index.end())
+        activeName.clear();
+
+    return true;
+}
+
+// Rewrites the store with only the latest live records, copied raw from the mapping
+bool ProfileStore::compact() {
+    std::string tmpPath = path + ".tmp";
+    int tmpFd = ::open(tmpPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (tmpFd < 0) return false;
+
+    std::string buffer = fileHeader();
+    for (const std::string& name : order) {
+        const RecordRef& ref = index[name];
+        buffer.append(reinterpret_cast<const char*>(mapped + ref.offset), ref.length);
+    }
+
+    bool ok = writeAll(tmpFd, buffer.data(), buffer.size(), 0) && ::fsync(tmpFd) == 0;
+    ::close(tmpFd);
+    if (!ok || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+
+    std::string keepActive = activeName;
+    std::size_t dropped = deadRecords;
+    if (!open(path)) return false;
+    if (!keepActive.empty())
+        appendActive(keepActive);
+
+    std::cout << "[ProfileStore] Compacted store, dropped " << dropped << " stale record(s).\n";
+    return true;
+}
+
+bool ProfileStore::ensureMapped(std::size_t endOffset) {
+    if (mapped && endOffset <= mappedSize) return true;
+    if (endOffset > fileSize || fileSize == 0) return false;
+
+    unmap();
+    void* addr = ::mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        std::cout << "[ProfileStore] mmap failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    mapped = static_cast<const unsigned char*>(addr);
+    mappedSize = fileSize;
+    return true;
+}
+
+void ProfileStore::unmap() {
+    if (mapped) {
+        ::munmap(const_cast<unsigned char*>(mapped), mappedSize);
+        mapped = nullptr;
+        mappedSize = 0;
+    }
+}
+
+std::vector<std::string> ProfileStore::getProfileNames() const {
+    return order;
+}
+
+bool ProfileStore::hasProfile(const std::string& name) const {
+    return index.find(name) != index.end();
+}
+
+std::string ProfileStore::getActiveProfileName() const {
+    return activeName;
+}
+
+// Decodes a single profile on demand. The record's checksum was verified by open() (or it was
+// appended by this store), so only the payload layout and profile fields are checked here.
+Profile* ProfileStore::loadProfile(const std::string& name) {
+    auto it = index.find(name);
+    if (it == index.end()) return nullptr;
+
+    const RecordRef ref = it->second;
+    if (!ensureMapped(ref.offset + ref.length)) return nullptr;
+
+    const unsigned char* rec = mapped + ref.offset;
+    std::uint16_t nameLength = readPod<std::uint16_t>(rec + 2);
+    std::uint32_t payloadLength = readPod<std::uint32_t>(rec + 4);
+    const unsigned char* payload = rec + kRecordHeaderSize + nameLength;
+    const std::size_t fixedSize = 3 * sizeof(double) + sizeof(std::uint32_t);
+    const std::size_t segmentSize = 3 * sizeof(double);
+    if (payloadLength < fixedSize) return nullptr;
+
+    std::uint32_t segmentCount = readPod<std::uint32_t>(payload + 3 * sizeof(double));
+    const std::size_t segmentsEnd = fixedSize + static_cast<std::size_t>(segmentCount) * segmentSize;
+    const bool hasAlerts = payloadLength == segmentsEnd + kAlertBlockSize;   // Version 2 record
+    if (payloadLength != segmentsEnd && !hasAlerts) {
+        std::cout << "[ProfileStore] Profile '" << name << "' has a malformed payload. Skipped.\n";
+        return nullptr;
+    }
+
+    Profile* profile = new Profile();
+    profile->setName(name);
+    profile->setInsulinToCarbRatio(readPod<double>(payload));
+    profile->setCorrectionFactor(readPod<double>(payload + sizeof(double)));
+    profile->setTargetBG(readPod<double>(payload + 2 * sizeof(double)));
+
+    const unsigned char* seg = payload + fixedSize;
+    for (std::uint32_t i = 0; i < segmentCount; ++i, seg += segmentSize) {
+        profile->addBasalSegment(new BasalSegment(readPod<double>(seg),
+                                                  readPod<double>(seg + sizeof(double)),
+                                                  readPod<double>(seg + 2 * sizeof(double))));
+    }
+
+    if (hasAlerts) {
+        const unsigned char* block = payload + segmentsEnd;
+        AlertSettings alerts;
+        alerts.batteryLowPct = readPod<double>(block);
+        alerts.cartridgeLowUnits = readPod<double>(block + sizeof(double));
+        alerts.bgLow = readPod<double>(block + 2 * sizeof(double));
+        alerts.bgHigh = readPod<double>(block + 3 * sizeof(double));
+        alerts.bgFallRate = readPod<double>(block + 4 * sizeof(double));
+        alerts.bgRiseRate = readPod<double>(block + 5 * sizeof(double));
+        alerts.cgmStaleMinutes = readPod<double>(block + 6 * sizeof(double));
+        profile->setAlertSettings(alerts);
+    }
+
+    if (!profile->isValid()) {
+        std::cout << "[ProfileStore] Profile '" << name << "' is invalid. Skipped.\n";
+        delete profile;
+        return nullptr;
+    }
+    return profile;
+}
+
+bool ProfileStore::appendRecord(std::uint8_t kind, const std::string& name, const std::string& payload,
+                                std::size_t* recordOffset) {
+    if (fd < 0 || name.size() > 0xFFFF) return false;
+
+    std::string body = name + payload;
+    std::string record;
+    record.reserve(kRecordHeaderSize + body.size());
+    appendPod(record, kind);
+    appendPod(record, static_cast<std::uint8_t>(0));
+    appendPod(record, static_cast<std::uint16_t>(name.size()));
+    appendPod(record, static_cast<std::uint32_t>(payload.size()));
+    appendPod(record, checksum(reinterpret_cast<const unsigned char*>(body.data()), body.size()));
+    record += body;
+
+    if (!writeAll(fd, record.data(), record.size(), static_cast<off_t>(fileSize)) || ::fdatasync(fd) != 0) {
+        std::cout << "[ProfileStore] Failed to persist change for '" << name << "'.\n";
+        return false;
+    }
+
+    if (recordOffset) *recordOffset = fileSize;
+    fileSize += record.size();
+    return true;
+}
+
+// Appends an upsert record for the profile; earlier records for the same name become stale
+bool ProfileStore::appendProfile(const Profile* profile) {
+    if (!profile) return false;
+
+    std::string name = profile->getName();
+    std::string payload = encodeProfile(profile);
+    std::size_t offset = 0;
+    if (!appendRecord(RecordUpsert, name, payload, &offset))
+        return false;
+
+    auto it = index.find(name);
+    if (it != index.end()) {
+        ++deadRecords;
+    } else {
+        order.push_back(name);
+    }
+    index[name] = { offset, kRecordHeaderSize + name.size() + payload.size() };
+    return true;
+}
+
+bool ProfileStore::appendDelete(const std::string& name) {
+    if (!hasProfile(name)) return true;
+    if (!appendRecord(RecordDelete, name, std::string()))
+        return false;
+
+    index.erase(name);
+    for (auto it = order.begin(); it != order.end(); ++it) {
+        if (*it == name) {
+            order.erase(it);
+            break;
+        }
+    }
+    if (activeName == name)
+        activeName.clear();
+    deadRecords += 2;
+    return true;
+}
+
+bool ProfileStore::appendActive(const std::string& name) {
+    if (name == activeName) return true;
+    if (!appendRecord(RecordActive, name, std::string()))
+        return false;
+
+    if (!activeName.empty())
+        ++deadRecords;
+    activeName = name;
+    return true;
+}
+
+// Writes profiles as JSON (full double precision so values round-trip exactly)
+bool ProfileStore::exportJson(const std::string& jsonPath, const std::vector<Profile*>& profiles,
+                              const std::string& active) {
+    std::ofstream out(jsonPath);
+    if (!out) {
+        std::cout << "[ProfileStore] Cannot write " << jsonPath << ".\n";
+        return false;
+    }
+
+    out << std::setprecision(17);
+    out << "{\n  \"version\": " << kFormatVersion << ",\n";
+    out << "  \"active\": \"" << escapeJson(active) << "\",\n";
+    out << "  \"profiles\": [";
+    for (std::size_t i = 0; i < profiles.size(); ++i) {
+        const Profile* p = profiles[i];
+        out << (i ? ",\n" : "\n");
+        out << "    {\n"
+            << "      \"name\": \"" << escapeJson(p->getName()) << "\",\n"
+            << "      \"insulinToCarbRatio\": " << p->getInsulinToCarbRatio() << ",\n"
+            << "      \"correctionFactor\": " << p->getCorrectionFactor() << ",\n"
+            << "      \"targetBG\": " << p->getTargetBG() << ",\n";
+        const AlertSettings& alerts = p->getAlertSettings();
+        out << "      \"alerts\": { \"batteryLowPct\": " << alerts.batteryLowPct
+            << ", \"cartridgeLowUnits\": " << alerts.cartridgeLowUnits
+            << ", \"bgLow\": " << alerts.bgLow
+            << ", \"bgHigh\": " << alerts.bgHigh
+            << ", \"bgFallRate\": " << alerts.bgFallRate
+            << ", \"bgRiseRate\": " << alerts.bgRiseRate
+            << ", \"cgmStaleMinutes\": " << alerts.cgmStaleMinutes << " },\n"
+            << "      \"basalSegments\": [";
+        const auto& segments = p->getBasalSegments();
+        for (std::size_t s = 0; s < segments.size(); ++s) {
+            out << (s ? ", " : "")
+                << "{ \"start\": " << segments[s]->getStartTime()
+                << ", \"end\": " << segments[s]->getEndTime()
+                << ", \"unitsPerHour\": " << segments[s]->getUnitsPerHour() << " }";
+        }
+        out << "]\n    }";
+    }
+    out << "\n  ]\n}\n";
+
+    std::cout << "[ProfileStore] Exported " << profiles.size() << " profile(s) to " << jsonPath << ".\n";
+    return static_cast<bool>(out);
+}
+
+// Reads profiles from JSON; invalid entries are skipped. Caller owns the returned profiles.
+std::vector<Profile*> ProfileStore::importJson(const std::string& jsonPath, std::string* activeOut) {
+    std::vector<Profile*> result;
+
+    std::ifstream in(jsonPath);
+    if (!in) {
+        std::cout << "[ProfileStore] Cannot read " << jsonPath << ".\n";
+        return result;
+    }
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    std::string text = buffer.str();
+
+    JsonValue root;
+    JsonParser parser(text);
+    if (!parser.parse(root) || root.type != JsonValue::Object) {
+        std::cout << "[ProfileStore] " << jsonPath << " is not valid JSON.\n";
+        return result;
+    }
+
+    const JsonValue* active = root.find("active");
+    if (activeOut && active && active->type == JsonValue::String)
+        *activeOut = active->text;
+
+    const JsonValue* list = root.find("profiles");
+    if (!list || list->type != JsonValue::Array)
+        return result;
+
+    for (const JsonValue& entry : list->items) {
+        if (entry.type != JsonValue::Object) continue;
+        const JsonValue* name = entry.find("name");
+        if (!name || name->type != JsonValue::String) continue;
+
+        Profile* p = new Profile();
+        p->setName(name->text);
+        p->setInsulinToCarbRatio(numberOr(entry, "insulinToCarbRatio", 0.0));
+        p->setCorrectionFactor(numberOr(entry, "correctionFactor", 0.0));
+        p->setTargetBG(numberOr(entry, "targetBG", 0.0));
+
+        // Files exported before version 2 have no "alerts"; missing fields keep their defaults
+        const JsonValue* alertsEntry = entry.find("alerts");
+        if (alertsEntry && alertsEntry->type == JsonValue::Object) {
+            AlertSettings alerts;
+            alerts.batteryLowPct = numberOr(*alertsEntry, "batteryLowPct", alerts.batteryLowPct);
+            alerts.cartridgeLowUnits = numberOr(*alertsEntry, "cartridgeLowUnits", alerts.cartridgeLowUnits);
+            alerts.bgLow = numberOr(*alertsEntry, "bgLow", alerts.bgLow);
+            alerts.bgHigh = numberOr(*alertsEntry, "bgHigh", alerts.bgHigh);
+            alerts.bgFallRate = numberOr(*alertsEntry, "bgFallRate", alerts.bgFallRate);
+            alerts.bgRiseRate = numberOr(*alertsEntry, "bgRiseRate", alerts.bgRiseRate);
+            alerts.cgmStaleMinutes = numberOr(*alertsEntry, "cgmStaleMinutes", alerts.cgmStaleMinutes);
+            p->setAlertSettings(alerts);
+        }
+
+        const JsonValue* segments = entry.find("basalSegments");
+        if (segments && segments->type == JsonValue::Array) {
+            for (const JsonValue& seg : segments->items) {
+                if (seg.type != JsonValue::Object) continue;
+                p->addBasalSegment(new BasalSegment(numberOr(seg, "start", 0.0),
+                                                    numberOr(seg, "end", 0.0),
+                                                    numberOr(seg, "unitsPerHour", 0.0)));
+            }
+        }
+
+        if (p->isValid()) {
+            result.push_back(p);
+        } else {
+            std::cout << "[ProfileStore] Skipping invalid profile '" << name->text << "' in " << jsonPath << ".\n";
+            delete p;
+        }
+    }
+
+    std::cout << "[ProfileStore] Imported " << result.size() << " profile(s) from " << jsonPath << ".\n";
+    return result;
+}
@@ -1,5 +1,6 @@
 #include "PumpSimulator.h"
 #include "ProfileManager.h"
+#include "ProfileSnapshot.h"
 #include "BolusCalculator.h"
 #include "InsulinDeliveryManager.h"
 #include "CGMSensorInterface.h"
@@ -7,6 +8,11 @@
 #include "AlertManager.h"
 #include "Battery.h"
 #include "Cartridge.h"
+#include "SimulationSnapshot.h"
+#include "TraceRecorder.h"
+#include "FaultInjector.h"
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 
 PumpSimulator::PumpSimulator()
@@ -18,62 +24,170 @@ PumpSimulator::PumpSimulator()
       controlIQ(nullptr),
       alertManager(nullptr),
       battery(nullptr),
-      cartridge(nullptr) {}
-
-PumpSimulator::~PumpSimulator() {}
+      cartridge(nullptr) {
+    eventBus.subscribe<BGReadingEvent>(this);
+    eventBus.subscribe<IOBChangedEvent>(this);
+    eventBus.subscribe<BatteryLevelEvent>(this);
+    eventBus.subscribe<CartridgeVolumeEvent>(this);
+}
 
 void PumpSimulator::startSimulation() {
     isRunning = true;
+    glycemicMetrics.reset();
+    lastDeliveredTotal = deliveryManager ? deliveryManager->getTotalDeliveredMicroUnits() : 0;
+    if (profileManager) {
+        profileManager->setPublishAtTickBoundary(true);
+        distributeProfileSnapshot();
+    }
+    // Bring every subscriber up to date before the first tick
+    if (battery)
+        battery->publishState();
+    if (cartridge)
+        cartridge->publishState();
+    if (cgmSensor)
+        cgmSensor->publishState();
+    if (deliveryManager)
+        deliveryManager->publishState();
+    scheduleControllerWake(getCurrentSimTime());
     std::cout << "[PumpSimulator] Simulation started.\n";
 }
 
 void PumpSimulator::stopSimulation() {
     isRunning = false;
+    if (profileManager)
+        profileManager->setPublishAtTickBoundary(false);
     std::cout << "[PumpSimulator] Simulation stopped.\n";
 }
 
 void PumpSimulator::updateSimulationState() {
     if (!isRunning) return;
 
+    // Tick boundary: profile edits made since the last tick become visible now, all at once
+    if (profileManager && profileManager->publishStagedSnapshot())
+        distributeProfileSnapshot();
+
     // Wait until active profile is set
-    if (!profileManager || !profileManager->getActiveProfile()) {
+    if (!profileManager || !profileManager->getActiveSnapshot()) {
         std::cout << "[PumpSimulator] Waiting for active profile...\n";
         return;
     }
 
-    int currentSimTime = getCurrentSimTime();
-    if (cgmSensor)
-        cgmSensor->setSimulatedTime(currentSimTime);
-    std::cout << "\n[Time = " << currentSimTime << " min]\n";
-
-    if (battery) {
-        battery->drain(1);
+    const bool tracing = traceRecorder && traceRecorder->isEnabled();
+    const std::uint64_t traceStart = tracing ? traceRecorder->nowNs() : 0;
+    const int tickMinute = getCurrentSimTime();
+
+    {
+        PUMP_TICK_SCOPE(tickProfiler, Total);
+
+        int currentSimTime = getCurrentSimTime();
+        if (cgmSensor)
+            cgmSensor->setSimulatedTime(currentSimTime);
+        if (deliveryManager)
+            deliveryManager->setSimulatedTime(currentSimTime);
+        std::cout << "\n[Time = " << currentSimTime << " min]\n";
+        {
+            PUMP_TICK_SCOPE(tickProfiler, Timers);
+            scheduler.runDue(currentSimTime);
+        }
+        if (deliveryManager)
+            deliveryManager->processPendingBoluses(currentSimTime);
+
+        if (faultInjector) {
+            PUMP_TICK_SCOPE(tickProfiler, Faults);
+            PUMP_TRACE_SPAN(traceRecorder, "Faults");
+            faultInjector->onTick(currentSimTime);
+        }
+
+        if (battery) {
+            PUMP_TICK_SCOPE(tickProfiler, Battery);
+            PUMP_TRACE_SPAN(traceRecorder, "Battery");
+            battery->accountActivity(1.0,
+                                     deliveryManager ? deliveryManager->getStrokeCount() : 0,
+                                     cgmSensor ? cgmSensor->getReadingCount() : 0);
+        }
+
+        if (deliveryManager) {
+            PUMP_TICK_SCOPE(tickProfiler, DeliveryTick);
+            PUMP_TRACE_SPAN(traceRecorder, "DeliveryTick");
+            deliveryManager->onTick(1.0);
+        }
+
+        if (cgmSensor) {
+            PUMP_TICK_SCOPE(tickProfiler, CGMReading);
+            PUMP_TRACE_SPAN(traceRecorder, "CGMReading");
+            cgmSensor->simulateNextReading();
+        }
+
+        if (controllerDue) {
+            controllerDue = false;
+            if (controlIQ) {
+                PUMP_TICK_SCOPE(tickProfiler, ControlIQ);
+                PUMP_TRACE_SPAN(traceRecorder, "ControlIQ");
+                controlIQ->predictBGTrend();
+                controlIQ->applyAutomaticAdjustments();
+                ++controllerRuns;
+            }
+            scheduleControllerWake(cgmSensor ? cgmSensor->getNextReadingMinute() : currentSimTime + 1);
+        }
+
+        if (deliveryManager) {
+            PUMP_TICK_SCOPE(tickProfiler, ExtendedDoses);
+            PUMP_TRACE_SPAN(traceRecorder, "ExtendedDoses");
+            deliveryManager->processScheduledExtendedDoses(currentSimTime);
+        }
+
+        // Score the tick: one minute at the new reading (sensor gaps are skipped), plus whatever
+        // was delivered during it (every tick counts towards elapsed time for TDD)
+        if (!cgmSensor || cgmSensor->isReadingAvailable())
+            glycemicMetrics.addReading(getCurrentBG());
+        if (deliveryManager) {
+            MicroUnits delivered = deliveryManager->getTotalDeliveredMicroUnits();
+            glycemicMetrics.addInsulin(InsulinUnits::toUnits(delivered - lastDeliveredTotal));
+            lastDeliveredTotal = delivered;
+        }
+
+        std::cout << "[PumpSimulator] Tick complete.\n";
+
+        if (cliMode)
+            simulatedMinutes += 1.0;
     }
 
-    if (deliveryManager)
-        deliveryManager->onTick(1.0);
+    // After the Total scope has recorded, so a periodic dump includes this tick
+    tickProfiler.endTick();
 
-    if (cgmSensor)
-        cgmSensor->simulateNextReading();
-
-    if (controlIQ) {
-        controlIQ->predictBGTrend();
-        controlIQ->applyAutomaticAdjustments();
+    if (tracing) {
+        traceRecorder->recordSpan("Tick", traceStart, traceRecorder->nowNs() - traceStart, tickMinute);
+        recordTraceCounters();
     }
+}
 
-    if (alertManager && battery)
-        alertManager->checkBattery(battery);
+void PumpSimulator::scheduleControllerWake(int minute) {
+    scheduler.cancel(controllerTimer);
+    controllerTimer = scheduler.schedule(minute, this, 0);
+}
 
-    if (alertManager && cartridge)
-        alertManager->checkCartridge(cartridge);
+void PumpSimulator::onTimer(int) {
+    controllerTimer = SimScheduler::kNoTimer;
+    controllerDue = true;
+}
 
+// Counter tracks sampled once per tick
+void PumpSimulator::recordTraceCounters() {
+    traceRecorder->recordCounter("BG (mmol/L)", getCurrentBG());
+    traceRecorder->recordCounter("IOB (U)", getIOB());
     if (deliveryManager)
-        deliveryManager->processScheduledExtendedDoses(currentSimTime);
-
-    std::cout << "[PumpSimulator] Tick complete.\n";
+        traceRecorder->recordCounter("Basal rate (U/hr)", deliveryManager->getCurrentBasalRate());
+    if (cartridge)
+        traceRecorder->recordCounter("Cartridge (U)", cartridge->getCurrentVolume());
+}
 
-    if (cliMode)
-        simulatedMinutes += 1.0;
+// Hands the currently published profile snapshot to the subsystems that hold one
+void PumpSimulator::distributeProfileSnapshot() {
+    std::shared_ptr<const ProfileSnapshot> snapshot = profileManager->getActiveSnapshot();
+    if (controlIQ)
+        controlIQ->setProfileSnapshot(snapshot);
+    if (alertManager)
+        alertManager->setProfileSnapshot(snapshot);
 }
 
 void PumpSimulator::shutdown() {
@@ -91,10 +205,26 @@ ProfileManager* PumpSimulator::getProfileManager() { return profileManager; }
 void PumpSimulator::setBolusCalculator(BolusCalculator* bc) { bolusCalculator = bc; }
 BolusCalculator* PumpSimulator::getBolusCalculator() const { return bolusCalculator; }
 
-void PumpSimulator::setInsulinDeliveryManager(InsulinDeliveryManager* idm) { deliveryManager = idm; }
+void PumpSimulator::setInsulinDeliveryManager(InsulinDeliveryManager* idm) {
+    if (deliveryManager)
+        deliveryManager->setEventBus(nullptr);
+    deliveryManager = idm;
+    if (deliveryManager) {
+        deliveryManager->setEventBus(&eventBus);
+        deliveryManager->publishState();
+    }
+}
 InsulinDeliveryManager* PumpSimulator::getInsulinDeliveryManager() const { return deliveryManager; }
 
-void PumpSimulator::setCGMSensorInterface(CGMSensorInterface* cgm) { cgmSensor = cgm; }
+void PumpSimulator::setCGMSensorInterface(CGMSensorInterface* cgm) {
+    if (cgmSensor)
+        cgmSensor->setEventBus(nullptr);
+    cgmSensor = cgm;
+    if (cgmSensor) {
+        cgmSensor->setEventBus(&eventBus);
+        cgmSensor->publishState();
+    }
+}
 CGMSensorInterface* PumpSimulator::getCGMSensorInterface() const { return cgmSensor; }
 
 ControlIQController* PumpSimulator::getControlIQController() const {
@@ -114,9 +244,38 @@ Cartridge* PumpSimulator::getCartridge() const {
 }
 
 void PumpSimulator::setControlIQController(ControlIQController* ctrl) { controlIQ = ctrl; }
-void PumpSimulator::setAlertManager(AlertManager* a) { alertManager = a; }
-void PumpSimulator::setBattery(Battery* b) { battery = b; }
-void PumpSimulator::setCartridge(Cartridge* c) { cartridge = c; }
+void PumpSimulator::setAlertManager(AlertManager* a) {
+    if (alertManager) {
+        eventBus.unsubscribeAll(alertManager);
+        alertManager->setScheduler(nullptr);
+    }
+    alertManager = a;
+    if (alertManager) {
+        if (!alertManager->subscribeTo(eventBus))
+            std::cout << "[PumpSimulator] Alert manager is not receiving events.\n";
+        alertManager->setScheduler(&scheduler);
+    }
+}
+
+void PumpSimulator::setBattery(Battery* b) {
+    if (battery)
+        battery->setEventBus(nullptr);
+    battery = b;
+    if (battery) {
+        battery->setEventBus(&eventBus);
+        battery->publishState();
+    }
+}
+
+void PumpSimulator::setCartridge(Cartridge* c) {
+    if (cartridge)
+        cartridge->setEventBus(nullptr);
+    cartridge = c;
+    if (cartridge) {
+        cartridge->setEventBus(&eventBus);
+        cartridge->publishState();
+    }
+}
 
 // --- CLI Simulation Utilities ---
 void PumpSimulator::incrementSimTime(double minutes) {
@@ -142,3 +301,45 @@ double PumpSimulator::getCurrentBG() const {
 double PumpSimulator::getIOB() const {
     return deliveryManager ? deliveryManager->getInsulinOnBoard() : 0.0;
 }
+
+// Fills a plain-data snapshot of the state shown by the GUI
+void PumpSimulator::captureSnapshot(SimulationSnapshot& out) const {
+    out.simMinute = getCurrentSimTime();
+    out.bg = observedBG;
+    out.bgSlope = observedSlope;
+    out.bgTrend = observedTrend;
+    out.iob = InsulinUnits::toUnits(observedIOB);
+    out.basalRate = deliveryManager ? deliveryManager->getCurrentBasalRate() : 0.0;
+    out.basalRunning = deliveryManager && deliveryManager->isBasalRunning();
+    out.batteryLevel = battery ? observedBatteryLevel : 0;
+    out.cartridgeVolume = cartridge ? InsulinUnits::toUnits(observedCartridgeVolume) : 0.0;
+
+    out.timeInRangePct = glycemicMetrics.getTimeInRangePct();
+    out.timeBelowPct = glycemicMetrics.getTimeBelowPct();
+    out.meanBG = glycemicMetrics.getMean();
+    out.cvPct = glycemicMetrics.getCV();
+    out.gmiPct = glycemicMetrics.getGMI();
+
+    out.recentDoseCount = 0;
+    if (deliveryManager) {
+        const DoseLedger& ledger = deliveryManager->getDoseLedger();
+        std::size_t count = std::min<std::size_t>(ledger.size(), SimulationSnapshot::kRecentDoses);
+        for (std::size_t i = 0; i < count; ++i)
+            out.recentDoses[i] = ledger.at(ledger.size() - count + i);
+        out.recentDoseCount = static_cast<int>(count);
+    }
+
+    if (alertManager) {
+        out.activeAlarmCount = alertManager->getActiveAlarmCount();
+        out.alarmSequence = alertManager->getRaisedCount();
+        std::strncpy(out.alarmMessage, alertManager->getLastRaisedMessage().c_str(), sizeof(out.alarmMessage) - 1);
+        out.alarmMessage[sizeof(out.alarmMessage) - 1] = '\0';
+        std::strncpy(out.alarmId, alertManager->getLastRaisedId().c_str(), sizeof(out.alarmId) - 1);
+        out.alarmId[sizeof(out.alarmId) - 1] = '\0';
+    } else {
+        out.activeAlarmCount = 0;
+        out.alarmSequence = 0;
+        out.alarmMessage[0] = '\0';
+        out.alarmId[0] = '\0';
+    }
+}
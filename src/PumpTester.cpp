@@ -3,6 +3,13 @@
 #include "PumpSimulator.h"
 #include "ProfileManager.h"
 #include "Profile.h"
+#include "ProfileStore.h"
+#include "ProfileSnapshot.h"
+#include "AlertRuleTable.h"
+#include "Scenario.h"
+#include "ScenarioRunner.h"
+#include "ParameterSweep.h"
+#include "BasalSegment.h"
 #include "BolusCalculator.h"
 #include "InsulinDeliveryManager.h"
 #include "Cartridge.h"
@@ -10,12 +17,322 @@
 #include "CGMSensorInterface.h"
 #include "ControlIQController.h"
 #include "AlertManager.h"
+#include "CGMTrend.h"
+#include "Alarm.h"
+#include "PumpEvents.h"
+#include "SimScheduler.h"
+#include "TickProfiler.h"
+#include "GlycemicMetrics.h"
+#include "BGHistory.h"
+#include "TraceRecorder.h"
+#include "DoseLedger.h"
 
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
 #include <iostream>
 #include <iomanip>
+#include <random>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <vector>
 
-PumpTester::PumpTester() {
+namespace {
+// Discards everything without keeping state, so simulator threads can share it
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return traits_type::not_eof(c); }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+// Records the order its timers fire in. Tag kReentrantTag reschedules and cancels from inside
+// its own callback.
+struct TimerProbe {
+    static constexpr int kReentrantTag = 1000;
+
+    SimScheduler* scheduler = nullptr;
+    SimScheduler::TimerId victim = SimScheduler::kNoTimer;
+    std::vector<int> fired;
+
+    void onTimer(int tag) {
+        fired.push_back(tag);
+        if (tag == kReentrantTag) {
+            scheduler->schedule(scheduler->now(), this, kReentrantTag + 1);       // Same pass
+            scheduler->schedule(scheduler->now() - 1, this, kReentrantTag + 2);   // Already overdue
+            scheduler->cancel(victim);
+        }
+    }
+};
+
+// Counts deliveries per event type and records the order listeners were called in
+struct EventProbe {
+    int id = 0;
+    std::vector<int>* order = nullptr;
+    int batteryEvents = 0;
+    int occlusionEvents = 0;
+
+    void onEvent(const BatteryLevelEvent&) {
+        ++batteryEvents;
+        if (order)
+            order->push_back(id);
+    }
+    void onEvent(const OcclusionEvent&) { ++occlusionEvents; }
+};
+
+struct TrendSample {
+    int minute;
+    double bg;
+};
+
+// Direct least-squares fits over the samples, with times centred on their mean
+double fitSlope(const std::vector<TrendSample>& window) {
+    double meanT = 0.0, meanY = 0.0;
+    for (const TrendSample& s : window) {
+        meanT += s.minute;
+        meanY += s.bg;
+    }
+    meanT /= window.size();
+    meanY /= window.size();
+    double stt = 0.0, sty = 0.0;
+    for (const TrendSample& s : window) {
+        stt += (s.minute - meanT) * (s.minute - meanT);
+        sty += (s.minute - meanT) * (s.bg - meanY);
+    }
+    return sty / stt;
+}
+
+// Second derivative of the fitted parabola, from the normal equations by Gaussian elimination
+double fitAcceleration(const std::vector<TrendSample>& window) {
+    double meanT = 0.0;
+    for (const TrendSample& s : window)
+        meanT += s.minute;
+    meanT /= window.size();
+    double m[3][4] = {};
+    for (const TrendSample& s : window) {
+        double basis[3] = { 1.0, s.minute - meanT, (s.minute - meanT) * (s.minute - meanT) };
+        for (int row = 0; row < 3; ++row) {
+            for (int col = 0; col < 3; ++col)
+                m[row][col] += basis[row] * basis[col];
+            m[row][3] += basis[row] * s.bg;
+        }
+    }
+    for (int pivot = 0; pivot < 3; ++pivot)
+        for (int row = pivot + 1; row < 3; ++row) {
+            double factor = m[row][pivot] / m[pivot][pivot];
+            for (int col = pivot; col < 4; ++col)
+                m[row][col] -= factor * m[pivot][col];
+        }
+    return 2.0 * m[2][3] / m[2][2];
+}
+
+std::string readFileBytes(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream bytes;
+    bytes << in.rdbuf();
+    return bytes.str();
+}
+
+// Strict recursive-descent JSON syntax check (RFC 8259 grammar, no semantic limits)
+class JsonChecker {
+public:
+    explicit JsonChecker(const std::string& t) : text(t) {}
+
+    bool valid() {
+        pos = 0;
+        return value() && (skipSpace(), pos == text.size());
+    }
+
+private:
+    const std::string& text;
+    std::size_t pos = 0;
+
+    void skipSpace() {
+        while (pos < text.size() && std::strchr(" \t\r\n", text[pos]))
+            ++pos;
+    }
+    bool eat(char c) {
+        skipSpace();
+        if (pos < text.size() && text[pos] == c) {
+            ++pos;
+            return true;
+        }
+        return false;
+    }
+    bool literal(const char* word) {
+        std::size_t n = std::strlen(word);
+        if (text.compare(pos, n, word) != 0)
+            return false;
+        pos += n;
+        return true;
+    }
+    bool digits() {
+        std::size_t start = pos;
+        while (pos < text.size() && std::isdigit(static_cast<unsigned char>(text[pos])))
+            ++pos;
+        return pos > start;
+    }
+    bool number() {
+        if (pos < text.size() && text[pos] == '-')
+            ++pos;
+        if (pos < text.size() && text[pos] == '0')
+            ++pos;
+        else if (!digits())
+            return false;
+        if (pos < text.size() && text[pos] == '.' && (++pos, !digits()))
+            return false;
+        if (pos < text.size() && (text[pos] == 'e' || text[pos] == 'E')) {
+            ++pos;
+            if (pos < text.size() && (text[pos] == '+' || text[pos] == '-'))
+                ++pos;
+            return digits();
+        }
+        return true;
+    }
+    bool string() {
+        if (!eat('"'))
+            return false;
+        while (pos < text.size() && text[pos] != '"') {
+            unsigned char c = static_cast<unsigned char>(text[pos++]);
+            if (c < 0x20)
+                return false;
+            if (c != '\\')
+                continue;
+            if (pos >= text.size())
+                return false;
+            char e = text[pos++];
+            if (e == 'u') {
+                for (int i = 0; i < 4; ++i, ++pos)
+                    if (pos >= text.size() || !std::isxdigit(static_cast<unsigned char>(text[pos])))
+                        return false;
+            } else if (!std::strchr("\"\\/bfnrt", e)) {
+                return false;
+            }
+        }
+        return eat('"');
+    }
+    bool value() {
+        skipSpace();
+        if (pos >= text.size())
+            return false;
+        char c = text[pos];
+        if (c == '{') {
+            ++pos;
+            if (eat('}'))
+                return true;
+            do {
+                if (!string() || !eat(':') || !value())
+                    return false;
+            } while (eat(','));
+            return eat('}');
+        }
+        if (c == '[') {
+            ++pos;
+            if (eat(']'))
+                return true;
+            do {
+                if (!value())
+                    return false;
+            } while (eat(','));
+            return eat(']');
+        }
+        if (c == '"')
+            return string();
+        if (c == 't' || c == 'f' || c == 'n')
+            return literal("true") || literal("false") || literal("null");
+        return number();
+    }
+};
+
+std::size_t countOccurrences(const std::string& text, const std::string& needle) {
+    std::size_t n = 0;
+    for (std::size_t at = text.find(needle); at != std::string::npos; at = text.find(needle, at + 1))
+        ++n;
+    return n;
+}
+
+void writeFileBytes(const std::string& path, const std::string& bytes) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+template <typename T>
+void appendBytes(std::string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// A format-1 store holding one upsert (no alert block), built byte by byte
+std::string formatOneStore(const std::string& name, double icr, double cf, double target) {
+    std::string payload;
+    appendBytes(payload, icr);
+    appendBytes(payload, cf);
+    appendBytes(payload, target);
+    appendBytes(payload, static_cast<std::uint32_t>(1));
+    appendBytes(payload, 0.0);
+    appendBytes(payload, 24.0);
+    appendBytes(payload, 0.9);
+
+    std::string body = name + payload;
+    std::uint32_t hash = 2166136261u;                // FNV-1a, as the store uses
+    for (unsigned char c : body) {
+        hash ^= c;
+        hash *= 16777619u;
+    }
+
+    std::string file("IPPS", 4);
+    appendBytes(file, static_cast<std::uint16_t>(1));
+    appendBytes(file, static_cast<std::uint16_t>(0));
+    appendBytes(file, static_cast<std::uint8_t>(1));   // Upsert
+    appendBytes(file, static_cast<std::uint8_t>(0));
+    appendBytes(file, static_cast<std::uint16_t>(name.size()));
+    appendBytes(file, static_cast<std::uint32_t>(payload.size()));
+    appendBytes(file, hash);
+    return file + body;
+}
+
+Profile* makeStoreProfile(const std::string& name, double icr) {
+    Profile* profile = new Profile();
+    profile->setName(name);
+    profile->setInsulinToCarbRatio(icr);
+    profile->setCorrectionFactor(2.5);
+    profile->setTargetBG(5.8);
+    profile->addBasalSegment(new BasalSegment(0.0, 6.0, 0.7));
+    profile->addBasalSegment(new BasalSegment(6.0, 24.0, 0.95));
+    AlertSettings alerts;
+    alerts.bgLow = 4.2;
+    alerts.cgmStaleMinutes = 0.0;
+    profile->setAlertSettings(alerts);
+    return profile;
+}
+
+bool sameProfile(const Profile* a, const Profile* b) {
+    if (!a || !b || a->getName() != b->getName() || a->getInsulinToCarbRatio() != b->getInsulinToCarbRatio() ||
+        a->getCorrectionFactor() != b->getCorrectionFactor() || a->getTargetBG() != b->getTargetBG())
+        return false;
+    const AlertSettings& x = a->getAlertSettings();
+    const AlertSettings& y = b->getAlertSettings();
+    if (x.batteryLowPct != y.batteryLowPct || x.cartridgeLowUnits != y.cartridgeLowUnits || x.bgLow != y.bgLow ||
+        x.bgHigh != y.bgHigh || x.bgFallRate != y.bgFallRate || x.bgRiseRate != y.bgRiseRate ||
+        x.cgmStaleMinutes != y.cgmStaleMinutes)
+        return false;
+    const auto& s = a->getBasalSegments();
+    const auto& t = b->getBasalSegments();
+    if (s.size() != t.size())
+        return false;
+    for (std::size_t i = 0; i < s.size(); ++i)
+        if (s[i]->getStartTime() != t[i]->getStartTime() || s[i]->getEndTime() != t[i]->getEndTime() ||
+            s[i]->getUnitsPerHour() != t[i]->getUnitsPerHour())
+            return false;
+    return true;
+}
+}
+
+PumpTester::PumpTester() : failures(0) {
     simulator = new PumpSimulator();
 
     // Create all subsystems
@@ -81,17 +398,41 @@ PumpTester::~PumpTester() {
     delete cgmSensor;
     delete controlIQ;
     delete alertManager;
-    delete activeProfile;
+    // activeProfile is owned (and deleted) by profileManager
 }
 
-void PumpTester::runAllTests() {
+bool PumpTester::runAllTests() {
     simulator->setCLIMode(true);
+    failures = 0;
     testManualBolus();
+    testBatchBolusCalculator();
+    testLatencyHistogram();
+    testGlycemicMetrics();
+    testBatteryActivity();
+    testBolusValidation();
+    testBatchBolusOutcomes();
+    testCartridgeReservations();
+    testDoseLedger();
+    testSimScheduler();
+    testEventBus();
+    testAlertTiming();
+    testAlertRules();
+    testCGMTrend();
+    testCGMSensorModel();
+    testBGHistory();
+    testTraceRecorder();
+    testProfileStore();
+    testScenarios();
+    testParameterSweep();
     // testExtendedBolus();
     // testBasalControl();
     // testControlIQ();
     // testAlerts();
     // testIOBDecayWithExtendedBolus();
+
+    std::cout << "\n==== Self-test " << (failures == 0 ? "passed" : "FAILED") << " ("
+              << failures << " failure(s)) ====\n";
+    return failures == 0;
 }
 
 void PumpTester::testManualBolus() {
@@ -109,7 +450,7 @@ void PumpTester::testManualBolus() {
     std::cout << "Recommended Dose: " << recommendedDose << " U\n";
 
     std::cout << "\nDelivering bolus...\n";
-    deliveryManager->deliverBolus(recommendedDose, false);
+    deliveryManager->submitBolus(BolusRequest::immediate(recommendedDose));
 
     simulateTime(20);  // Trigger simulation loop for 5 minutes
 }
@@ -135,7 +476,8 @@ void PumpTester::testExtendedBolus() {
     int splits = 4;          // 1U every 1 min if 4U remaining
 
     std::cout << "\nDelivering extended bolus...\n";
-    deliveryManager->deliverBolus(totalDose, true, immediate, duration, splits, simulator->getSimulatedMinutes());
+    deliveryManager->submitBolus(BolusRequest::dualWave(totalDose, immediate, duration, splits,
+                                                         simulator->getSimulatedMinutes()));
 
     simulateTime(5);  // Should deliver the remaining 4U over 4 minutes
 }
@@ -189,12 +531,1149 @@ void PumpTester::testIOBDecayWithExtendedBolus() {
     int splits = 4;
 
     std::cout << "\nDelivering extended bolus...\n";
-    deliveryManager->deliverBolus(totalDose, true, immediate, duration, splits, simulator->getSimulatedMinutes());
+    deliveryManager->submitBolus(BolusRequest::dualWave(totalDose, immediate, duration, splits,
+                                                         simulator->getSimulatedMinutes()));
 
     // Simulate time passing
     simulateTime(8); // Watch as IOB increases and then starts to decay
 }
 
+// Batch doses must match calculateBolus() bit for bit, including halves, negatives and -0.0
+void PumpTester::testBatchBolusCalculator() {
+    printHeader("Batch Bolus Calculator Test");
+
+    const std::size_t count = 4099;   // Odd, so the scalar tail runs too
+    std::vector<double> bg(count), carbs(count), iob(count), icr(count), cf(count), target(count);
+    std::mt19937 rng(2024);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    for (std::size_t i = 0; i < count; ++i) {
+        bg[i] = 2.0 + 20.0 * unit(rng);
+        carbs[i] = (i % 4 == 0) ? 0.0 : 120.0 * unit(rng);
+        iob[i] = 8.0 * unit(rng);
+        icr[i] = 5.0 + 15.0 * unit(rng);
+        cf[i] = 1.0 + 3.0 * unit(rng);
+        target[i] = 5.0 + 2.0 * unit(rng);
+        if (i % 7 == 0) {
+            // Land exactly on a half-unit boundary (x.5 and -x.5) after rounding
+            carbs[i] = 0.0;
+            bg[i] = target[i];
+            iob[i] = (i % 14 == 0) ? -2.5 : 0.5;
+        }
+    }
+
+    BolusBatchInput input;
+    input.currentBG = bg.data();
+    input.carbIntake = carbs.data();
+    input.iob = iob.data();
+    input.icr = icr.data();
+    input.correctionFactor = cf.data();
+    input.targetBG = target.data();
+    input.count = count;
+
+    std::vector<double> batch(count);
+    BolusCalculator::calculateBolusBatch(input, batch.data());
+
+    // The scalar path logs its parameters on every call; keep that out of the test output
+    std::ostringstream discard;
+    std::streambuf* previous = std::cout.rdbuf(discard.rdbuf());
+    Profile patient;
+    std::size_t mismatches = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        patient.setInsulinToCarbRatio(icr[i]);
+        patient.setCorrectionFactor(cf[i]);
+        patient.setTargetBG(target[i]);
+        double scalar = bolusCalculator->calculateBolus(bg[i], carbs[i], iob[i], &patient);
+        if (std::memcmp(&scalar, &batch[i], sizeof(double)) != 0)
+            ++mismatches;
+    }
+    std::cout.rdbuf(previous);
+
+    std::ostringstream what;
+    what << "Batch of " << count << " doses bit-identical to calculateBolus (" << mismatches << " differences)";
+    check(mismatches == 0, what.str());
+}
+
+// Every value maps to a bucket inside the table; values past kMaxValueBits clamp to the top bucket
+void PumpTester::testLatencyHistogram() {
+    printHeader("Latency Histogram Test");
+
+    const std::uint64_t top = (std::uint64_t(1) << LatencyHistogram::kMaxValueBits) - 1;
+    bool withinPrecision = true;
+    for (std::uint64_t value = 1; value <= top; value = value * 3 + 1) {
+        LatencyHistogram single;
+        single.record(value);
+        std::uint64_t bound = single.percentile(50.0);
+        if (bound < value || bound - value > value / LatencyHistogram::kSubBucketCount)
+            withinPrecision = false;
+    }
+    check(withinPrecision, "Single values report within one sub-bucket (~3%) of themselves");
+
+    LatencyHistogram histogram;
+    histogram.record(top);
+    histogram.record(top + 1);
+    histogram.record(std::uint64_t(1) << (LatencyHistogram::kMaxValueBits + 1));
+    histogram.record(UINT64_MAX);
+    check(histogram.getCount() == 4 && histogram.getMax() == UINT64_MAX,
+          "Out-of-range values (up to UINT64_MAX) are counted");
+    check(histogram.percentile(0.0) == top && histogram.percentile(100.0) == top,
+          "Out-of-range values clamp to the top bucket");
+}
+
+// Out-of-range requests are rejected before any insulin moves
+void PumpTester::testBolusValidation() {
+    printHeader("Bolus Validation Test");
+
+    const double volume = cartridge->getCurrentVolume();
+    const double iob = deliveryManager->getInsulinOnBoard();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+
+    check(deliveryManager->submitBolus(BolusRequest::immediate(1e13)) == BolusStatus::InvalidRequest,
+          "1e13 U immediate bolus is rejected");
+    check(deliveryManager->submitBolus(BolusRequest::immediate(cartridge->getCapacity() + 0.05)) ==
+              BolusStatus::InvalidRequest,
+          "Bolus above cartridge capacity is rejected");
+    check(deliveryManager->submitBolus(BolusRequest::extended(1e300, 60.0, 4)) == BolusStatus::InvalidRequest,
+          "1e300 U extended bolus is rejected");
+    check(deliveryManager->submitBolus(BolusRequest::dualWave(2.0, nan, 60.0, 4)) == BolusStatus::InvalidRequest,
+          "NaN immediate portion is rejected");
+    check(deliveryManager->submitBolus(BolusRequest::immediate(-1.0)) == BolusStatus::InvalidRequest,
+          "Negative bolus is rejected");
+    const double inf = std::numeric_limits<double>::infinity();
+    BolusRequest endless = BolusRequest::extended(2.0, inf, 4);
+    BolusStatus batchStatus = BolusStatus::Queued;
+    deliveryManager->submitBolusBatch(&endless, 1, &batchStatus);
+    check(deliveryManager->submitBolus(endless) == BolusStatus::InvalidRequest &&
+              batchStatus == BolusStatus::InvalidRequest &&
+              deliveryManager->submitBolus(BolusRequest::dualWave(2.0, 1.0, nan, 4)) == BolusStatus::InvalidRequest,
+          "Infinite or NaN extended duration is rejected, directly and in a batch");
+    check(cartridge->getCurrentVolume() == volume && deliveryManager->getInsulinOnBoard() == iob &&
+              cartridge->getReservedMicroUnits() == 0,
+          "Rejected requests leave cartridge, reservations and IOB unchanged");
+    check(InsulinUnits::fromUnits(1e300) == InsulinUnits::fromUnits(InsulinUnits::kMaxUnits) &&
+              InsulinUnits::fromUnits(-1e300) == -InsulinUnits::fromUnits(InsulinUnits::kMaxUnits) &&
+              InsulinUnits::fromUnits(nan) == 0,
+          "fromUnits saturates out-of-range input");
+}
+
+// Streaming statistics against direct computation, range boundaries, risk split and TDD over a gap
+void PumpTester::testGlycemicMetrics() {
+    printHeader("Glycemic Metrics Test");
+
+    GlycemicMetrics metrics;
+    std::vector<double> readings;
+    std::mt19937 rng(36);
+    std::normal_distribution<double> glucose(8.0, 2.5);
+    for (int i = 0; i < 5000; ++i) {
+        readings.push_back(std::max(1.5, glucose(rng)));
+        metrics.addReading(readings.back());
+    }
+    double sum = 0.0;
+    for (double bg : readings)
+        sum += bg;
+    double mean = sum / readings.size();
+    double squares = 0.0;
+    for (double bg : readings)
+        squares += (bg - mean) * (bg - mean);
+    double sd = std::sqrt(squares / (readings.size() - 1));
+    check(std::fabs(metrics.getMean() - mean) < 1e-12 * mean && std::fabs(metrics.getSD() - sd) < 1e-10 * sd &&
+              metrics.getMin() == *std::min_element(readings.begin(), readings.end()) &&
+              metrics.getMax() == *std::max_element(readings.begin(), readings.end()),
+          "Welford mean and SD match a two-pass computation over 5000 readings");
+
+    // Boundaries count as in range; 3.0 is low but not very low
+    metrics.reset();
+    const double boundaries[] = { 3.9, 10.0, 3.89, 10.01, 3.0, 2.99 };
+    for (double bg : boundaries)
+        metrics.addReading(bg, 10.0);
+    check(metrics.getMinutes() == 60.0 && std::fabs(metrics.getTimeInRangePct() - 100.0 * 2 / 6) < 1e-12 &&
+              std::fabs(metrics.getTimeBelowPct() - 50.0) < 1e-12 &&
+              std::fabs(metrics.getTimeVeryLowPct() - 100.0 / 6) < 1e-12 &&
+              std::fabs(metrics.getTimeAbovePct() - 100.0 / 6) < 1e-12,
+          "Time in range includes 3.9 and 10.0; below, very low and above are time-weighted");
+
+    // Kovatchev: f < 0 below about 6.2 mmol/L (112.5 mg/dL) feeds LBGI only, above it HBGI only
+    auto risk = [](double bg) {
+        double f = 1.509 * (std::pow(std::log(bg * 18.0182), 1.084) - 5.381);
+        return 10.0 * f * f;
+    };
+    metrics.reset();
+    metrics.addReading(3.0);
+    metrics.addReading(4.0);
+    bool lowOnly = metrics.getHBGI() == 0.0 && std::fabs(metrics.getLBGI() - (risk(3.0) + risk(4.0)) / 2) < 1e-9;
+    metrics.addReading(15.0);
+    metrics.addReading(20.0);
+    bool split = std::fabs(metrics.getLBGI() - (risk(3.0) + risk(4.0)) / 4) < 1e-9 &&
+                 std::fabs(metrics.getHBGI() - (risk(15.0) + risk(20.0)) / 4) < 1e-9;
+    check(lowOnly && split, "LBGI and HBGI split the risk by its sign and average over all readings");
+
+    // One day: insulin every minute, readings for only half of them (CGM gap)
+    metrics.reset();
+    for (int minute = 0; minute < 24 * 60; ++minute) {
+        metrics.addInsulin(0.02);
+        if (minute < 12 * 60)
+            metrics.addReading(7.0);
+    }
+    check(metrics.getMinutes() == 720.0 && metrics.getElapsedMinutes() == 1440.0 &&
+              std::fabs(metrics.getTotalDailyInsulin() - 28.8) < 1e-9,
+          "Total daily insulin is normalised by elapsed time, not by minutes with readings");
+}
+
+// Activity-driven discharge: deltas of the running totals, counter restarts, screen timeout
+void PumpTester::testBatteryActivity() {
+    printHeader("Battery Activity Test");
+
+    Battery pack;
+    std::int64_t before = pack.getCharge();
+    pack.accountActivity(1.0, 10, 1);
+    std::int64_t first = before - pack.getCharge();
+    before = pack.getCharge();
+    pack.accountActivity(1.0, 10, 1);
+    std::int64_t idleOnly = before - pack.getCharge();
+    check(first == Battery::kIdleCostPerMinute + 10 * Battery::kStrokeCost + Battery::kReadingCost &&
+              idleOnly == Battery::kIdleCostPerMinute,
+          "Only strokes and readings since the last call are charged");
+
+    before = pack.getCharge();
+    pack.accountActivity(0.5, 10, 1);
+    bool halfFree = pack.getCharge() == before;
+    pack.accountActivity(0.5, 10, 1);
+    check(halfFree && before - pack.getCharge() == Battery::kIdleCostPerMinute,
+          "Fractional minutes carry over until a whole idle minute is due");
+
+    before = pack.getCharge();
+    pack.accountActivity(0.0, 3, 0);
+    check(before - pack.getCharge() == 3 * Battery::kStrokeCost,
+          "Totals that restart below the last value are charged from the new baseline");
+
+    pack.wakeScreen();
+    before = pack.getCharge();
+    pack.accountActivity(1.0, 3, 0);
+    std::int64_t withScreen = before - pack.getCharge();
+    before = pack.getCharge();
+    pack.accountActivity(1.0, 3, 0);
+    check(withScreen == Battery::kIdleCostPerMinute +
+                            std::llround(Battery::kScreenTimeoutMinutes * Battery::kScreenCostPerMinute) &&
+              before - pack.getCharge() == Battery::kIdleCostPerMinute,
+          "The screen draws power until its timeout, then stops");
+
+    // The figure in Battery.h: 20 U (400 strokes) and a reading every 5 minutes over one day
+    Battery day;
+    std::uint64_t strokes = 0, readings = 0;
+    for (int minute = 1; minute <= 24 * 60; ++minute) {
+        if (minute % 5 == 0)
+            ++readings;
+        if (minute % 18 == 0 && strokes < 400)
+            strokes += 5;
+        day.accountActivity(1.0, strokes, readings);
+    }
+    double usedPct = 100.0 * (Battery::kCapacity - day.getCharge()) / Battery::kCapacity;
+    std::cout << "Typical day uses " << usedPct << "% of a full charge\n";
+    check(strokes == 400 && usedPct > 10.0 && usedPct < 12.0, "A typical day uses about 11% of a full charge");
+}
+
+// Queued requests report Queued (or a validation error) now and their final status once submitted
+void PumpTester::testBatchBolusOutcomes() {
+    printHeader("Batch Bolus Outcome Test");
+
+    const double now = simulator->getSimulatedMinutes();
+    deliveryManager->setSimulatedTime(now);
+    deliveryManager->clearBolusOutcomes();
+
+    BolusRequest requests[3] = { BolusRequest::immediate(0.5), BolusRequest::immediate(1e13),
+                                 BolusRequest::immediate(0.5) };
+    requests[0].startTime = now;
+    requests[1].startTime = now;
+    requests[2].startTime = now + 1.0;
+    for (int i = 0; i < 3; ++i)
+        requests[i].tag = 100 + i;
+    BolusStatus statuses[3];
+    deliveryManager->submitBolusBatch(requests, 3, statuses);
+    check(statuses[0] == BolusStatus::Queued && statuses[1] == BolusStatus::InvalidRequest &&
+              statuses[2] == BolusStatus::Queued,
+          "Batch statuses are Queued / InvalidRequest / Queued");
+
+    deliveryManager->processPendingBoluses(now);
+    const double volume = cartridge->getCurrentVolume();
+    cartridge->setCurrentVolume(0.0);
+    deliveryManager->processPendingBoluses(now + 1.0);
+    cartridge->setCurrentVolume(volume);
+
+    const auto& outcomes = deliveryManager->getBolusOutcomes();
+    check(outcomes.size() == 2 && outcomes.at(0).tag == 100 && outcomes.at(0).status == BolusStatus::Delivered &&
+              outcomes.at(1).tag == 102 && outcomes.at(1).status == BolusStatus::InsufficientInsulin &&
+              deliveryManager->getFailedBolusOutcomeCount() == 1,
+          "Final outcomes are recorded per tag (Delivered, then InsufficientInsulin)");
+    check(deliveryManager->getPendingBolusCount() == 0, "Pending queue is empty afterwards");
+
+    // Many more outcomes than the ring holds: memory stays flat, failures are still all counted
+    const std::size_t many = 3 * InsulinDeliveryManager::kMaxBolusOutcomes;
+    std::vector<BolusRequest> flood(many, BolusRequest::immediate(0.05));
+    std::vector<BolusStatus> floodStatuses(many);
+    for (std::size_t i = 0; i < many; ++i) {
+        flood[i].startTime = now + 2.0;
+        flood[i].tag = static_cast<int>(i);
+    }
+    std::ostringstream discard;
+    std::streambuf* coutBuffer = std::cout.rdbuf(discard.rdbuf());   // One refusal line per request
+    cartridge->setCurrentVolume(0.0);
+    deliveryManager->submitBolusBatch(flood.data(), many, floodStatuses.data());
+    deliveryManager->processPendingBoluses(now + 2.0);
+    cartridge->setCurrentVolume(volume);
+    std::cout.rdbuf(coutBuffer);
+    check(outcomes.size() == InsulinDeliveryManager::kMaxBolusOutcomes &&
+              outcomes.latest().tag == static_cast<int>(many - 1) &&
+              deliveryManager->getFailedBolusOutcomeCount() == 1 + many,
+          "Outcome history is bounded and keeps the newest; the failure count covers them all");
+    deliveryManager->clearBolusOutcomes();
+}
+
+// Reserved insulin always equals what the scheduled splits still owe, through an occluded split,
+// a leak below the reserved amount and cartridge swaps (uses its own pump, not the shared one)
+void PumpTester::testCartridgeReservations() {
+    printHeader("Cartridge Reservation Test");
+
+    using InsulinUnits::fromUnits;
+    Cartridge first;
+    Cartridge second;
+    Cartridge nearlyEmpty;
+    nearlyEmpty.setCurrentVolume(1.0);
+    InsulinDeliveryManager pump;
+    pump.setCartridge(&first);
+    pump.setSimulatedTime(0.0);
+
+    auto consistent = [&pump](const Cartridge& cart) {
+        return cart.getReservedMicroUnits() == pump.getScheduledBolusMicroUnits() &&
+               (cart.getCurrentMicroUnits() < cart.getReservedMicroUnits() ||
+                cart.getAvailableMicroUnits() + cart.getReservedMicroUnits() == cart.getCurrentMicroUnits());
+    };
+
+    check(pump.submitBolus(BolusRequest::extended(4.0, 40.0, 4, 0.0)) == BolusStatus::Scheduled &&
+              first.getReservedMicroUnits() == fromUnits(4.0) && consistent(first),
+          "Extended bolus reserves its splits");
+    check(pump.submitBolus(BolusRequest::immediate(196.05)) == BolusStatus::InsufficientInsulin,
+          "Unreserved bolus cannot draw reserved insulin");
+
+    pump.setOccluded(true);
+    pump.processScheduledExtendedDoses(10.0);
+    pump.setOccluded(false);
+    check(first.getCurrentMicroUnits() == fromUnits(200.0) && first.getReservedMicroUnits() == fromUnits(3.0) &&
+              consistent(first),
+          "Occluded split releases its share without drawing");
+
+    first.leak(fromUnits(198.5));                      // 1.5 U left, 3 U reserved
+    pump.processScheduledExtendedDoses(20.0);          // 1 U split still fits
+    bool afterFirstSplit = first.getCurrentMicroUnits() == fromUnits(0.5) && consistent(first);
+    pump.processScheduledExtendedDoses(30.0);          // 1 U split no longer does
+    check(afterFirstSplit && first.getCurrentMicroUnits() == fromUnits(0.5) &&
+              first.getReservedMicroUnits() == fromUnits(1.0) && consistent(first),
+          "Leak below the reserved amount fails only the uncovered split");
+
+    pump.setCartridge(&second);
+    check(first.getReservedMicroUnits() == 0 && second.getReservedMicroUnits() == fromUnits(1.0) &&
+              consistent(second),
+          "Cartridge swap moves the reservation");
+    pump.processScheduledExtendedDoses(40.0);
+    check(second.getCurrentMicroUnits() == fromUnits(199.0) && second.getReservedMicroUnits() == 0 &&
+              consistent(second) && pump.getTotalDeliveredMicroUnits() == fromUnits(2.0),
+          "Last split commits from the new cartridge");
+
+    pump.submitBolus(BolusRequest::extended(2.0, 20.0, 2, 40.0));
+    pump.setCartridge(&nearlyEmpty);
+    check(pump.getScheduledBolusMicroUnits() == 0 && second.getReservedMicroUnits() == 0 &&
+              nearlyEmpty.getReservedMicroUnits() == 0,
+          "Swap to a cartridge that cannot cover the splits cancels them");
+}
+
+// Window queries across the ring's wrap-around, inclusive window starts and the lifetime count
+void PumpTester::testDoseLedger() {
+    printHeader("Dose Ledger Test");
+
+    const std::size_t overflow = 100;
+    const std::size_t written = DoseLedger::kCapacity + overflow;
+    DoseLedger ledger;
+    for (std::size_t i = 0; i < written; ++i)
+        ledger.record(static_cast<double>(i), static_cast<MicroUnits>(i + 1),
+                      i % 10 == 0 ? DoseType::Bolus : DoseType::Basal, DoseSource::Manual);
+    check(ledger.size() == DoseLedger::kCapacity && ledger.getTotalRecorded() == written &&
+              ledger.at(0).time == static_cast<double>(overflow) && ledger.latest().time == written - 1.0,
+          "A full ledger drops its oldest records and counts every record ever written");
+
+    const double since = 1000.0;
+    std::vector<double> times;
+    ledger.forEachSince(since, [&](const DoseRecord& dose) { times.push_back(dose.time); });
+    bool window = times.size() == written - 1000;
+    for (std::size_t i = 0; window && i < times.size(); ++i)
+        window = times[i] == since + static_cast<double>(i);
+    MicroUnits expected = 0;
+    for (std::size_t i = 1000; i < written; ++i)
+        expected += static_cast<MicroUnits>(i + 1);
+    check(window && ledger.sumSince(since) == expected,
+          "forEachSince visits the window oldest first, starting at its first minute");
+
+    std::size_t all = 0, none = 0;
+    ledger.forEachSince(0.0, [&](const DoseRecord&) { ++all; });
+    ledger.forEachSince(static_cast<double>(written), [&](const DoseRecord&) { ++none; });
+    check(all == DoseLedger::kCapacity && none == 0, "A window older than the ring yields only retained records");
+
+    ledger.clear();
+    check(ledger.empty() && ledger.sumSince(0.0) == 0, "clear() empties the ledger");
+}
+
+// Timers fire in (due, scheduling order); cancels anywhere in the heap and from callbacks stick
+void PumpTester::testSimScheduler() {
+    printHeader("SimScheduler Test");
+
+    SimScheduler scheduler;
+    TimerProbe probe;
+    probe.scheduler = &scheduler;
+
+    // 48 timers over 12 distinct minutes, scheduled out of order; every fifth one is cancelled
+    const int count = 48;
+    std::vector<SimScheduler::TimerId> ids(count);
+    std::vector<int> due(count);
+    for (int i = 0; i < count; ++i) {
+        due[i] = 10 + (i * 7) % 12;
+        ids[i] = scheduler.schedule(due[i], &probe, i);
+    }
+    std::vector<char> cancelled(count, 0);
+    bool cancelsFound = true;
+    for (int i = 2; i < count; i += 5) {
+        cancelsFound = scheduler.cancel(ids[i]) && cancelsFound;
+        cancelled[i] = 1;
+    }
+    check(cancelsFound && scheduler.getPendingCount() == static_cast<std::size_t>(count - 10),
+          "Cancel removes timers from the middle of the heap");
+
+    scheduler.runDue(15);
+    std::vector<int> expected;
+    for (int minute = 10; minute <= 15; ++minute)
+        for (int i = 0; i < count; ++i)
+            if (due[i] == minute && !cancelled[i])
+                expected.push_back(i);
+    check(probe.fired == expected, "Due timers fire by minute, then in scheduling order");
+
+    scheduler.runDue(30);
+    std::size_t fired = probe.fired.size();
+    check(fired == static_cast<std::size_t>(count - 10) && scheduler.getPendingCount() == 0 &&
+              !scheduler.cancel(ids[0]),
+          "Every timer fires exactly once; cancelling a fired timer is a no-op");
+
+    probe.fired.clear();
+    scheduler.schedule(40, &probe, TimerProbe::kReentrantTag);
+    scheduler.schedule(40, &probe, 1);
+    probe.victim = scheduler.schedule(40, &probe, 2);
+    scheduler.schedule(41, &probe, 3);
+    scheduler.runDue(40);
+    // The overdue timer (due 39) goes ahead of those due at 40; the cancelled one never fires
+    std::vector<int> reentrant = { TimerProbe::kReentrantTag, TimerProbe::kReentrantTag + 2, 1,
+                                   TimerProbe::kReentrantTag + 1 };
+    check(probe.fired == reentrant && scheduler.getPendingCount() == 1,
+          "A callback can schedule timers due in the same pass and cancel pending ones");
+    scheduler.runDue(41);
+
+    for (std::size_t i = 0; i < SimScheduler::kMaxTimers; ++i)
+        scheduler.schedule(50, &probe, 0);
+    check(scheduler.schedule(50, &probe, 0) == SimScheduler::kNoTimer &&
+              scheduler.getPendingCount() == SimScheduler::kMaxTimers,
+          "A full timer table refuses new timers");
+    scheduler.cancelAll(&probe);
+    check(scheduler.getPendingCount() == 0, "cancelAll removes every timer of an owner");
+
+    // Removing an entry can pull a later-scanned one up the heap; cancelAll must still find it
+    std::mt19937 rng(48);
+    TimerProbe other;
+    bool ownerSilenced = true;
+    for (int trial = 0; trial < 200; ++trial) {
+        SimScheduler mixed;
+        probe.fired.clear();
+        other.fired.clear();
+        std::size_t kept = 0;
+        for (int i = 0; i < 8; ++i) {
+            bool mine = rng() % 4 == 0;
+            mixed.schedule(static_cast<int>(rng() % 50), mine ? &other : &probe, i);
+            kept += mine ? 0 : 1;
+        }
+        mixed.cancelAll(&other);
+        bool countOk = mixed.getPendingCount() == kept;
+        mixed.runDue(100);
+        ownerSilenced = ownerSilenced && countOk && other.fired.empty() && probe.fired.size() == kept;
+    }
+    check(ownerSilenced, "cancelAll leaves no timer of the owner behind, wherever it sits in the heap");
+}
+
+// Subscription order, duplicates, unsubscribe per channel and everywhere, and full channels
+void PumpTester::testEventBus() {
+    printHeader("Event Bus Test");
+
+    const std::size_t capacity = EventChannel<BatteryLevelEvent>::kMaxSubscribers;
+    PumpEventBus bus;
+    std::vector<int> order;
+    EventProbe first, second;
+    first.id = 1;
+    second.id = 2;
+    first.order = second.order = &order;
+
+    bool subscribed = bus.subscribe<BatteryLevelEvent>(&second) && bus.subscribe<BatteryLevelEvent>(&first) &&
+                      bus.subscribe<BatteryLevelEvent>(&second) && bus.subscribe<OcclusionEvent>(&first);
+    bus.publish(BatteryLevelEvent{ 50 });
+    check(subscribed && bus.getSubscriberCount<BatteryLevelEvent>() == 2 && order == std::vector<int>{ 2, 1 } &&
+              second.batteryEvents == 1,
+          "Subscribers run once each, in subscription order; a duplicate subscribe is a no-op");
+
+    bus.unsubscribe<BatteryLevelEvent>(&first);
+    bus.publish(BatteryLevelEvent{ 40 });
+    bus.publish(OcclusionEvent{ true });
+    check(first.batteryEvents == 1 && second.batteryEvents == 2 && first.occlusionEvents == 1,
+          "unsubscribe() only leaves the named channel");
+
+    bus.unsubscribeAll(&first);
+    bus.unsubscribeAll(&second);
+    bus.publish(BatteryLevelEvent{ 30 });
+    bus.publish(OcclusionEvent{ false });
+    check(bus.getSubscriberCount<BatteryLevelEvent>() == 0 && bus.getSubscriberCount<OcclusionEvent>() == 0 &&
+              second.batteryEvents == 2 && first.occlusionEvents == 1,
+          "unsubscribeAll() leaves every channel");
+
+    std::vector<EventProbe> crowd(capacity + 1);
+    bool fits = true;
+    for (std::size_t i = 0; i < capacity; ++i)
+        fits = bus.subscribe<OcclusionEvent>(&crowd[i]) && fits;
+    check(fits && !bus.subscribe<OcclusionEvent>(&crowd[capacity]) &&
+              bus.getSubscriberCount<OcclusionEvent>() == capacity,
+          "A full channel refuses the next subscriber");
+
+    // AlertManager must not end up listening to some of its events and missing others
+    AlertManager alerts;
+    NullBuffer discard;
+    std::streambuf* coutBuffer = std::cout.rdbuf(&discard);
+    bool refused = !alerts.subscribeTo(bus);
+    std::cout.rdbuf(coutBuffer);
+    bus.publish(BatteryLevelEvent{ 5 });
+    check(refused && bus.getSubscriberCount<BatteryLevelEvent>() == 0 && alerts.getRaisedCount() == 0,
+          "AlertManager reports a full channel and backs out of the bus");
+
+    bus.unsubscribe<OcclusionEvent>(&crowd[0]);
+    bool accepted = alerts.subscribeTo(bus);
+    bus.publish(BatteryLevelEvent{ 5 });
+    check(accepted && alerts.getRaisedCount() == 1, "AlertManager subscribes once there is room");
+}
+
+// Deduplication, escalation and snooze on the simulated clock (CARTRIDGE_EMPTY: 60 min dedup
+// window, 60 min escalation delay)
+void PumpTester::testAlertTiming() {
+    printHeader("Alert Timing Test");
+
+    using InsulinUnits::fromUnits;
+    SimScheduler scheduler;
+    AlertManager alerts;
+    alerts.setScheduler(&scheduler);
+    const std::string id = "CARTRIDGE_EMPTY";
+    auto at = [&](int minute) { scheduler.runDue(minute); };
+    auto volume = [&](double units) { alerts.onEvent(CartridgeVolumeEvent{ fromUnits(units) }); };
+    auto severity = [&]() { return alerts.findAlarm(id)->getSeverity(); };
+
+    at(0);
+    volume(10.0);
+    check(alerts.getRaisedCount() == 1 && alerts.getActiveAlarmCount() == 1, "Crossing raises the alarm");
+
+    at(30);
+    volume(50.0);
+    volume(10.0);
+    check(alerts.getRaisedCount() == 1 && alerts.getSuppressedCount() == 1 && alerts.getActiveAlarmCount() == 1,
+          "Re-raise inside the dedup window is active but not announced");
+
+    at(89);
+    bool notYet = severity() == "warning";
+    at(90);
+    check(notYet && severity() == "critical" && alerts.getRaisedCount() == 2 &&
+              alerts.getHistory().latest().action == AlertAction::Escalated,
+          "Unacknowledged alarm escalates 60 min after its last raise");
+
+    at(100);
+    check(alerts.snoozeAlarm(id, 20) && !alerts.snoozeAlarm("NO_SUCH_ALARM", 20), "Snooze accepts active alarms only");
+    at(119);
+    bool quiet = alerts.getRaisedCount() == 2;
+    at(120);
+    check(quiet && alerts.getRaisedCount() == 3 && alerts.getHistory().latest().action == AlertAction::Reminded,
+          "Snooze reminds when it runs out");
+
+    alerts.clearAlarm(id);
+    check(alerts.getActiveAlarmCount() == 0 && scheduler.getPendingCount() == 0,
+          "Acknowledging cancels the alarm's timers");
+
+    at(200);
+    volume(50.0);
+    volume(10.0);
+    check(alerts.getRaisedCount() == 4 && alerts.getSuppressedCount() == 1,
+          "Re-raise after the dedup window is announced");
+
+    const AlertHistory& history = alerts.getHistory();
+    std::vector<AlertAction> actions;
+    for (std::size_t i = 0; i < history.size(); ++i)
+        actions.push_back(history.at(i).action);
+    std::vector<AlertAction> expected = { AlertAction::Raised, AlertAction::Resolved, AlertAction::Escalated,
+                                          AlertAction::Snoozed, AlertAction::Reminded, AlertAction::Acknowledged,
+                                          AlertAction::Raised };
+    check(actions == expected, "History records each step (suppressed re-raise excluded)");
+    alerts.setScheduler(nullptr);
+}
+
+// Rule hysteresis, disabled thresholds, nextThreshold, and recompiling under live alarms
+void PumpTester::testAlertRules() {
+    printHeader("Alert Rule Test");
+
+    AlertRuleTable table;
+    std::vector<std::string> transitions;
+    auto feed = [&](AlertSignal signal, double value) {
+        table.evaluate(signal, value, [&](const AlertRule& rule, bool raised, double) {
+            transitions.push_back(std::string(raised ? "+" : "-") + rule.id);
+        });
+    };
+
+    // BAT_LOW: raise at or below 20 %, clear above 22 %
+    feed(AlertSignal::BatteryLevel, 25.0);
+    feed(AlertSignal::BatteryLevel, 20.0);
+    feed(AlertSignal::BatteryLevel, 18.0);
+    feed(AlertSignal::BatteryLevel, 21.5);
+    feed(AlertSignal::BatteryLevel, 19.5);
+    bool held = table.isActive("BAT_LOW");
+    feed(AlertSignal::BatteryLevel, 22.5);
+    check(held && transitions == std::vector<std::string>{ "+BAT_LOW", "-BAT_LOW" } && !table.isActive("BAT_LOW"),
+          "A rule raises once, holds inside the hysteresis band and clears past it");
+
+    double threshold = 0.0;
+    bool silenceAhead = table.nextThreshold(AlertSignal::CGMSilence, threshold) && threshold == 20.0;
+    feed(AlertSignal::CGMSilence, 25.0);
+    double ignored = 0.0;
+    check(silenceAhead && !table.nextThreshold(AlertSignal::CGMSilence, ignored) &&
+              !table.nextThreshold(AlertSignal::BatteryLevel, ignored) &&
+              table.nextThreshold(AlertSignal::BGRate, threshold) && threshold == AlertSettings().bgRiseRate,
+          "nextThreshold reports the lowest inactive at-or-above threshold only");
+
+    AlertSettings quiet;
+    quiet.bgLow = 0.0;
+    quiet.bgRiseRate = 0.0;
+    quiet.cgmStaleMinutes = 0.0;
+    std::size_t fullCount = table.getRuleCount();
+    table.compile(quiet);
+    transitions.clear();
+    feed(AlertSignal::BG, 2.0);
+    feed(AlertSignal::BGRate, 1.0);
+    check(fullCount == 7 && table.getRuleCount() == 4 && transitions.empty() &&
+              !table.nextThreshold(AlertSignal::CGMSilence, ignored),
+          "A threshold of 0 leaves its rule out of the table");
+
+    feed(AlertSignal::BG, 15.0);
+    table.compile(AlertSettings());
+    check(table.isActive("BG_HIGH") && !table.isActive("BG_LOW"), "Recompiling keeps the state of surviving rules");
+
+    // AlertManager applies a new snapshot to the last reading straight away
+    AlertManager alerts;
+    Profile profile;
+    profile.setName("Thresholds");
+    profile.setInsulinToCarbRatio(10.0);
+    profile.setCorrectionFactor(2.0);
+    profile.setTargetBG(6.0);
+    std::uint64_t version = 0;
+    auto applyHigh = [&](double bgHigh) {
+        AlertSettings settings;
+        settings.bgHigh = bgHigh;
+        profile.setAlertSettings(settings);
+        alerts.setProfileSnapshot(ProfileSnapshot::fromProfile(profile, ++version));
+        const Alarm* alarm = alerts.findAlarm("BG_HIGH");
+        return alarm && alarm->getIsActive();
+    };
+    alerts.onEvent(BGReadingEvent{ 12.0, 0, 0.0, TrendArrow::None });
+    bool quietAtDefault = alerts.getActiveAlarmCount() == 0;
+    bool raisedByLowerThreshold = applyHigh(11.0);
+    bool resolvedByHigherThreshold = !applyHigh(15.0);
+    bool raisedAgain = applyHigh(11.0);
+    bool resolvedWhenDisabled = !applyHigh(0.0);
+    check(quietAtDefault && raisedByLowerThreshold && resolvedByHigherThreshold,
+          "A new threshold applies to the last reading without waiting for the next one");
+    check(raisedAgain && resolvedWhenDisabled && alerts.getActiveAlarmCount() == 0,
+          "Turning a rule off resolves its alarm");
+}
+
+// Running-sum slope and acceleration match a direct fit through adds, evictions, same-minute
+// replacements and origin rebases
+void PumpTester::testCGMTrend() {
+    printHeader("CGM Trend Test");
+
+    CGMTrend trend;
+    std::vector<TrendSample> window;
+    std::mt19937 rng(49);
+    std::uniform_int_distribution<int> gap(1, 5);
+    std::uniform_real_distribution<double> noise(-0.3, 0.3);
+
+    double worstSlope = 0.0, worstAcceleration = 0.0;
+    bool countsMatch = true;
+    int replacements = 0;
+    int minute = 0;
+    while (minute < 600) {                          // Spans a dozen rebases
+        bool replace = !window.empty() && rng() % 6 == 0;
+        if (!replace)
+            minute += gap(rng);
+        double bg = 8.0 + 4.0 * std::sin(minute / 40.0) + noise(rng);
+        trend.addReading(minute, bg);
+
+        if (replace) {
+            window.back().bg = bg;
+            ++replacements;
+        } else {
+            window.push_back(TrendSample{ minute, bg });
+            window.erase(window.begin(), std::find_if(window.begin(), window.end(), [&](const TrendSample& s) {
+                return s.minute >= minute - CGMTrend::kWindowMinutes;
+            }));
+        }
+
+        countsMatch = countsMatch && trend.getSampleCount() == window.size();
+        if (window.size() >= 2) {
+            double expected = fitSlope(window);
+            worstSlope = std::max(worstSlope, std::fabs(trend.getSlope() - expected) / std::max(1.0, std::fabs(expected)));
+        }
+        if (window.size() >= 3) {
+            double expected = fitAcceleration(window);
+            worstAcceleration = std::max(worstAcceleration,
+                                         std::fabs(trend.getAcceleration() - expected) / std::max(1.0, std::fabs(expected)));
+        }
+    }
+
+    std::cout << "Replacements: " << replacements << ", worst slope error: " << worstSlope
+              << ", worst acceleration error: " << worstAcceleration << "\n";
+    check(countsMatch && replacements > 0, "Window holds the same samples as the reference");
+    check(worstSlope < 1e-9, "Slope matches a direct linear fit");
+    check(worstAcceleration < 1e-9, "Acceleration matches a direct quadratic fit");
+}
+
+// Readings on a fixed cadence, interstitial latency from the delay line, and calibration drift
+void PumpTester::testCGMSensorModel() {
+    printHeader("CGM Sensor Model Test");
+
+    CGMSensorInterface sensor;
+    sensor.setSeed(7);
+    sensor.setBG(8.0);
+    sensor.setLatencyMinutes(10);
+    std::vector<double> trueBG;
+    bool onCadence = true, heldBetween = true, lagged = true;
+    int minute = 0;
+    for (; minute < 60; ++minute) {
+        std::uint64_t readingsBefore = sensor.getReadingCount();
+        double shownBefore = sensor.getCurrentBG();
+        sensor.setSimulatedTime(minute);
+        sensor.simulateNextReading();
+        trueBG.push_back(sensor.getTrueBG());
+        bool took = sensor.getReadingCount() != readingsBefore;
+        onCadence = onCadence && took == (minute % 5 == 0) && sensor.getNextReadingMinute() == (minute / 5 + 1) * 5;
+        if (!took)
+            heldBetween = heldBetween && sensor.getCurrentBG() == shownBefore;
+        else if (minute >= 10)
+            lagged = lagged && sensor.getCurrentBG() == trueBG[minute - 10];
+    }
+    check(onCadence && sensor.getReadingCount() == 12, "Readings come every 5 minutes on a fixed phase");
+    check(heldBetween, "The reported value holds between readings");
+    check(lagged && sensor.getCurrentBG() == trueBG[45] && trueBG[45] != trueBG[55], "Each reading shows the BG from latencyMinutes earlier");
+
+    // 10% per day of gain drift: a day after calibration the reading is 10% high
+    sensor.setLatencyMinutes(0);
+    sensor.setCalibrationDrift(10.0);
+    for (; minute <= 1440; ++minute) {
+        sensor.setSimulatedTime(minute);
+        sensor.simulateNextReading();
+    }
+    bool drifted = std::fabs(sensor.getCurrentBG() - sensor.getTrueBG() * 1.1) < 1e-9;
+    sensor.calibrate();
+    for (; minute <= 1445; ++minute) {
+        sensor.setSimulatedTime(minute);
+        sensor.simulateNextReading();
+    }
+    double gain = 1.0 + 0.1 * 5.0 / 1440.0;
+    check(drifted && std::fabs(sensor.getCurrentBG() - sensor.getTrueBG() * gain) < 1e-9,
+          "Calibration gain drifts per day and calibrate() restarts it");
+}
+
+// Level selection, stitching of not-yet-aggregated points, min/max excursions and the LTTB cap
+void PumpTester::testBGHistory() {
+    printHeader("BG History Test");
+
+    // Three levels of 64 points, x4: only the coarsest level still reaches back to minute 0
+    BGHistory history(64, 3, 4);
+    for (int minute = 0; minute < 600; ++minute)
+        history.append(minute, minute == 50 ? 20.0 : minute == 120 ? 2.5 : 6.0);
+
+    std::vector<BGPoint> points;
+    history.query(0, 599, 10000, points);
+    bool ordered = !points.empty();
+    double lowest = 100.0, highest = 0.0;
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        ordered = ordered && (i == 0 || points[i].minute > points[i - 1].minute);
+        lowest = std::min(lowest, points[i].bg);
+        highest = std::max(highest, points[i].bg);
+    }
+    check(history.firstMinute() == 0.0 && history.lastMinute() == 599.0 && points.size() < 100,
+          "Old history is served from a coarse level");
+    check(ordered && points.front().minute == 0.0 && points.back().minute == 599.0,
+          "Coarse and fine levels stitch into one time-ordered series up to the newest reading");
+    check(lowest == 2.5 && highest == 20.0, "Decimation keeps the low and the high excursion");
+
+    history.query(560, 599, 100, points);
+    bool raw = points.size() == 40;
+    for (std::size_t i = 0; raw && i < points.size(); ++i)
+        raw = points[i].minute == 560.0 + static_cast<double>(i);
+    check(raw, "A recent window comes from the raw level, one point per reading");
+
+    history.query(0, 599, 20, points);
+    lowest = 100.0;
+    highest = 0.0;
+    for (const BGPoint& p : points) {
+        lowest = std::min(lowest, p.bg);
+        highest = std::max(highest, p.bg);
+    }
+    check(points.size() == 20 && points.front().minute == 0.0 && points.back().minute == 599.0 &&
+              lowest == 2.5 && highest == 20.0,
+          "LTTB caps the point count, keeps both ends and the excursions");
+}
+
+// Per-thread flight-recorder rings, the enable switch, and well-formed Chrome trace JSON
+void PumpTester::testTraceRecorder() {
+    printHeader("Trace Recorder Test");
+
+    static const char* const kSpanNames[] = { "span0", "span1", "span2", "span3", "span4",
+                                              "span5", "span6", "span7", "span8", "span9" };
+    TraceRecorder recorder(4);
+    recorder.recordSpan("disabled", 0, 1);
+    { PUMP_TRACE_SPAN(&recorder, "disabled"); }
+    bool quietWhenOff = recorder.getEventCount() == 0;
+
+    recorder.setEnabled(true);
+    recorder.setThreadName("main");
+    for (int i = 0; i < 10; ++i)
+        recorder.recordSpan(kSpanNames[i], static_cast<std::uint64_t>(i) * 1000, 500, i * 0.5);
+    std::size_t mainOnly = recorder.getEventCount();
+
+    std::thread worker([&recorder]() {
+        recorder.setThreadName("worker \"2\"\n");
+        recorder.recordCounter("BG", 6.5);
+        recorder.recordCounter("IOB", 1.25);
+        { PUMP_TRACE_SPAN(&recorder, "tick"); }
+    });
+    worker.join();
+    recorder.setEnabled(false);
+    check(quietWhenOff && mainOnly == 4 && recorder.getEventCount() == 7,
+          "Each thread keeps its own ring, capped at its size; nothing is recorded while disabled");
+
+    const char* tmp = std::getenv("TMPDIR");
+    const std::string path = std::string(tmp && *tmp ? tmp : "/tmp") + "/pumptester-trace.json";
+    NullBuffer discard;
+    std::streambuf* coutBuffer = std::cout.rdbuf(&discard);
+    bool written = recorder.writeChromeTrace(path);
+    std::cout.rdbuf(coutBuffer);
+    std::string json = readFileBytes(path);
+    std::remove(path.c_str());
+
+    check(written && JsonChecker(json).valid(), "The trace file is valid JSON, thread names escaped");
+    check(countOccurrences(json, "\"ph\":\"X\"") == 5 && countOccurrences(json, "\"ph\":\"C\"") == 2 &&
+              countOccurrences(json, "\"thread_name\"") == 2 && json.find("\"tid\":2") != std::string::npos,
+          "Spans, counters and one named track per thread are exported");
+    check(json.find("\"span5\"") == std::string::npos && json.find("\"span6\"") < json.find("\"span9\""),
+          "A full ring keeps the newest events, oldest first");
+
+    recorder.clear();
+    check(recorder.getEventCount() == 0, "clear() empties every ring");
+}
+
+// Binary layout, torn-tail repair, refusal of mid-file damage, the format 1 upgrade, compaction
+// and the JSON exchange path, on a scratch store file
+void PumpTester::testProfileStore() {
+    printHeader("Profile Store Test");
+
+    const char* tmp = std::getenv("TMPDIR");
+    const std::string base = std::string(tmp && *tmp ? tmp : "/tmp") + "/pumptester-store";
+    const std::string path = base + ".ipps";
+    const std::string jsonPath = base + ".json";
+    std::remove(path.c_str());
+
+    Profile* morning = makeStoreProfile("Morning", 9.0);
+    Profile* evening = makeStoreProfile("Evening", 12.5);
+    std::size_t afterFirst = 0;
+    {
+        ProfileStore store;
+        store.open(path);
+        store.appendProfile(morning);
+        afterFirst = readFileBytes(path).size();
+        store.appendProfile(evening);
+        store.appendActive("Evening");
+    }
+    std::string bytes = readFileBytes(path);
+    std::uint16_t version = 0;
+    std::memcpy(&version, bytes.data() + 4, sizeof(version));
+    check(bytes.compare(0, 4, "IPPS") == 0 && version == ProfileStore::kFormatVersion &&
+              bytes[8] == 1 && bytes[afterFirst] == 1,
+          "Store starts with the IPPS header and appends one upsert record per profile");
+
+    {
+        ProfileStore store;
+        Profile* loaded = store.open(path) ? store.loadProfile("Evening") : nullptr;
+        check(store.getProfileNames() == std::vector<std::string>{ "Morning", "Evening" } &&
+                  store.getActiveProfileName() == "Evening" && sameProfile(loaded, evening),
+              "Reopened store lists profiles in order and decodes fields, segments and alerts exactly");
+        delete loaded;
+    }
+
+    // Tear the active record: the tail goes, the profiles stay
+    writeFileBytes(path, bytes.substr(0, bytes.size() - 3));
+    {
+        ProfileStore store;
+        bool opened = store.open(path);
+        Profile* loaded = opened ? store.loadProfile("Morning") : nullptr;
+        bool activeDropped = store.getActiveProfileName().empty();
+        bool appended = store.appendActive("Morning");
+        check(opened && activeDropped && store.getProfileNames().size() == 2 &&
+                  sameProfile(loaded, morning) && appended,
+              "A torn tail is truncated and the store stays usable");
+        delete loaded;
+    }
+    {
+        ProfileStore store;
+        check(store.open(path) && store.getActiveProfileName() == "Morning",
+              "Records appended after a truncation load on the next open");
+    }
+
+    // Damage the first record's payload: nothing may be loaded or rewritten
+    bytes = readFileBytes(path);
+    std::string damaged = bytes;
+    damaged[8 + 12 + 3] ^= 0x40;
+    writeFileBytes(path, damaged);
+    {
+        ProfileStore store;
+        bool opened = store.open(path);
+        check(!opened && readFileBytes(path) == damaged, "Mid-file corruption refuses the store and leaves the file alone");
+    }
+
+    // Format 1 store: loads with default alert thresholds and is upgraded in place
+    writeFileBytes(path, formatOneStore("Legacy", 11.0, 3.0, 6.2));
+    {
+        ProfileStore store;
+        Profile* legacy = store.open(path) ? store.loadProfile("Legacy") : nullptr;
+        AlertSettings defaults;
+        check(legacy && legacy->getInsulinToCarbRatio() == 11.0 && legacy->getBasalSegments().size() == 1 &&
+                  legacy->getAlertSettings().bgLow == defaults.bgLow &&
+                  legacy->getAlertSettings().cgmStaleMinutes == defaults.cgmStaleMinutes,
+              "Format 1 upserts load with default alert thresholds");
+        store.appendProfile(morning);
+        delete legacy;
+    }
+    bytes = readFileBytes(path);
+    std::memcpy(&version, bytes.data() + 4, sizeof(version));
+    {
+        ProfileStore store;
+        Profile* legacy = store.open(path) ? store.loadProfile("Legacy") : nullptr;
+        Profile* loaded = store.loadProfile("Morning");
+        check(version == ProfileStore::kFormatVersion && legacy && sameProfile(loaded, morning),
+              "Upgraded store mixes format 1 and 2 records");
+        delete legacy;
+        delete loaded;
+    }
+
+    // Enough superseded records trigger compaction on open
+    std::remove(path.c_str());
+    std::size_t grownSize = 0;
+    {
+        ProfileStore store;
+        store.open(path);
+        for (int i = 0; i < 80; ++i) {
+            morning->setInsulinToCarbRatio(5.0 + i * 0.125);
+            store.appendProfile(morning);
+        }
+        store.appendProfile(evening);
+        store.appendActive("Morning");
+        grownSize = readFileBytes(path).size();
+    }
+    {
+        ProfileStore store;
+        bool opened = store.open(path);
+        Profile* loaded = store.loadProfile("Morning");
+        check(opened && readFileBytes(path).size() < grownSize / 10 && sameProfile(loaded, morning) &&
+                  store.getActiveProfileName() == "Morning" && store.getProfileNames().size() == 2,
+              "Compaction keeps only the latest record per profile and the active choice");
+        delete loaded;
+    }
+
+    std::vector<Profile*> exported = { morning, evening };
+    std::string importedActive;
+    bool exportedOk = ProfileStore::exportJson(jsonPath, exported, "Evening");
+    std::vector<Profile*> imported = ProfileStore::importJson(jsonPath, &importedActive);
+    check(exportedOk && imported.size() == 2 && sameProfile(imported[0], morning) &&
+              sameProfile(imported[1], evening) && importedActive == "Evening",
+          "JSON export and import round-trip every field");
+    for (Profile* profile : imported)
+        delete profile;
+
+    delete morning;
+    delete evening;
+    std::remove(path.c_str());
+    std::remove(jsonPath.c_str());
+}
+
+// Scenario parsing (comments, same-minute order, line-numbered errors) and a short headless run
+void PumpTester::testScenarios() {
+    printHeader("Scenario Test");
+
+    const std::string text =
+        "# Inline scenario\n"
+        "name   inline-check   # trailing comment\n"
+        "\n"
+        "duration 180\n"
+        "seed 9\n"
+        "bg 8.5\n"
+        "at 60 bolus 1.5\n"
+        "at 30 meal 40\n"
+        "at 60 fault cartridge 150\n"
+        "at 60 meal 10          # same minute as the two lines above\n"
+        "at 90 bolus 250        # more than the cartridge holds\n";
+    Scenario scenario;
+    std::string error;
+    bool parsed = Scenario::parse(text, scenario, &error);
+    std::vector<ScenarioEvent::Type> types;
+    std::vector<int> minutes;
+    for (const ScenarioEvent& event : scenario.events) {
+        types.push_back(event.type);
+        minutes.push_back(event.minute);
+    }
+    check(parsed && scenario.name == "inline-check" && scenario.durationMinutes == 180 && scenario.seed == 9 &&
+              scenario.initialBG == 8.5,
+          "Header directives parse; comments and blank lines are skipped");
+    check(minutes == std::vector<int>{ 30, 60, 60, 60, 90 } &&
+              types == std::vector<ScenarioEvent::Type>{ ScenarioEvent::Meal, ScenarioEvent::Bolus,
+                                                         ScenarioEvent::FaultCartridge, ScenarioEvent::Meal,
+                                                         ScenarioEvent::Bolus },
+          "Events sort by minute and keep file order within a minute");
+
+    struct BadLine {
+        const char* text;
+        const char* expectedPrefix;
+    };
+    const BadLine badLines[] = {
+        { "name x\nfrobnicate 3\n", "line 2: " },
+        { "duration 1e12\n", "line 1: " },
+        { "# header\nseed -1\n", "line 2: " },
+        { "seed 1.5\n", "line 1: " },
+        { "seed 99999999999\n", "line 1: " },
+        { "cgm-cadence 1e10\n", "line 1: " },
+        { "\n\nat 10 meal\n", "line 3: " },
+        { "at -5 bolus 1\n", "line 1: " },
+        { "at 10 fault battery 150\n", "line 1: " },
+        { "at 10 fault occlusion 1e12\n", "line 1: " },
+        { "at 10 extended 6 2 120 1e12\n", "line 1: " },
+        { "random-faults 1e9\n", "line 1: " },
+    };
+    bool allRejected = true;
+    for (const BadLine& bad : badLines) {
+        Scenario rejected;
+        std::string message;
+        bool ok = !Scenario::parse(bad.text, rejected, &message) && message.rfind(bad.expectedPrefix, 0) == 0;
+        if (!ok)
+            std::cout << "Not rejected as expected: " << bad.text;
+        allRejected = allRejected && ok;
+    }
+    check(allRejected, "Bad or out-of-range lines fail with their line number");
+
+    NullBuffer discard;
+    std::streambuf* coutBuffer = std::cout.rdbuf(&discard);      // runAll logs from several threads
+    ScenarioResult first = ScenarioRunner::run(scenario);
+    ScenarioResult again = ScenarioRunner::run(scenario);
+    std::vector<ScenarioResult> parallel = ScenarioRunner::runAll({ scenario, scenario }, 2);
+    std::cout.rdbuf(coutBuffer);
+
+    std::cout << "Run: " << first.minutes << " min, " << first.insulinDelivered << " U delivered, "
+              << first.failedBoluses << " failed bolus(es), final BG " << first.finalBG << "\n";
+    check(first.name == "inline-check" && first.minutes == 180 && first.failedBoluses == 1 &&
+              first.insulinDelivered >= 1.5,
+          "Runner delivers the scenario and counts the bolus the cartridge cannot hold");
+    check(again.finalBG == first.finalBG && again.meanBG == first.meanBG && parallel.size() == 2 &&
+              parallel[0].finalBG == first.finalBG && parallel[1].insulinDelivered == first.insulinDelivered,
+          "Runs are reproducible, on one thread or several");
+}
+
+// Axis parsing, grid order, Latin-hypercube strata and common random numbers across points
+void PumpTester::testParameterSweep() {
+    printHeader("Parameter Sweep Test");
+
+    SweepAxis axis;
+    bool goodSpec = SweepAxis::parse("icr=5:20:7", axis) && axis.parameter == SweepAxis::InsulinToCarbRatio &&
+                    axis.min == 5.0 && axis.max == 20.0 && axis.steps == 7;
+    const char* badSpecs[] = { "icr=0:10", "cf=-1:2", "basal=0:1.5", "target=-4:6", "icr=5:nan", "icr=5:inf",
+                               "icr=10:5", "icr=5:10:0", "icr=5:10:99999999999", "dose=1:2", "icr=5" };
+    bool badRejected = true;
+    for (const char* spec : badSpecs) {
+        SweepAxis rejected;
+        if (SweepAxis::parse(spec, rejected)) {
+            std::cout << "Accepted bad axis: " << spec << "\n";
+            badRejected = false;
+        }
+    }
+    check(goodSpec && badRejected, "Axis specs need a finite, positive range and 1-1000 steps");
+
+    SweepConfig config;
+    config.base.durationMinutes = 120;
+    config.base.seed = 40;
+    SweepAxis icr, cf;
+    SweepAxis::parse("icr=6:10:3", icr);
+    SweepAxis::parse("cf=1:3:2", cf);
+    config.axes = { icr, cf };
+    std::vector<SweepPoint> grid = ParameterSweep::makePoints(config);
+    std::vector<std::pair<double, double>> gridOrder;
+    for (const SweepPoint& point : grid)
+        gridOrder.push_back({ point.insulinToCarbRatio, point.correctionFactor });
+    std::vector<std::pair<double, double>> expectedOrder = { { 6, 1 }, { 6, 3 }, { 8, 1 }, { 8, 3 }, { 10, 1 }, { 10, 3 } };
+    check(gridOrder == expectedOrder && grid[0].targetBG == config.base.targetBG && grid[0].basalScale == 1.0,
+          "Grid expands with the first axis varying slowest; other parameters keep the base values");
+
+    config.latinHypercube = true;
+    config.samples = 10;
+    std::vector<SweepPoint> design = ParameterSweep::makePoints(config);
+    bool stratified = design.size() == 10;
+    for (const SweepAxis& a : config.axes) {
+        std::vector<int> hits(10, 0);
+        for (SweepPoint& point : design) {
+            double value = a.parameter == SweepAxis::InsulinToCarbRatio ? point.insulinToCarbRatio : point.correctionFactor;
+            int stratum = static_cast<int>((value - a.min) / (a.max - a.min) * 10);
+            if (stratum >= 0 && stratum < 10)
+                ++hits[static_cast<std::size_t>(stratum)];
+        }
+        stratified = stratified && std::all_of(hits.begin(), hits.end(), [](int h) { return h == 1; });
+    }
+    std::vector<SweepPoint> again = ParameterSweep::makePoints(config);
+    bool repeatable = again.size() == design.size() && again[3].insulinToCarbRatio == design[3].insulinToCarbRatio;
+    check(stratified && repeatable, "Latin hypercube puts one sample in each stratum of every axis, repeatably");
+
+    // No meals, so ICR cannot matter: with shared seeds every point must come out identical
+    config.latinHypercube = false;
+    config.axes = { icr };
+    config.seedsPerPoint = 3;
+    config.jobs = 2;
+    NullBuffer discard;
+    std::streambuf* coutBuffer = std::cout.rdbuf(&discard);      // The sweep runs on two threads
+    std::vector<SweepPointResult> results = ParameterSweep::run(config);
+    double directMean = 0.0;
+    std::vector<double> perSeed;
+    for (int k = 0; k < config.seedsPerPoint; ++k) {
+        Scenario single = config.base;
+        single.seed = config.base.seed + static_cast<unsigned int>(k);
+        perSeed.push_back(ScenarioRunner::run(single).meanBG);
+        directMean += perSeed.back();
+    }
+    std::cout.rdbuf(coutBuffer);
+    directMean /= config.seedsPerPoint;
+
+    bool seedsDiffer = perSeed[0] != perSeed[1] || perSeed[1] != perSeed[2];
+    bool shared = results.size() == 3;
+    for (const SweepPointResult& r : results)
+        shared = shared && r.runs == 3 && r.meanBG == results[0].meanBG && r.lowestBG == results[0].lowestBG &&
+                 std::fabs(r.meanBG - directMean) < 1e-12;
+    check(seedsDiffer && shared, "Every point runs the same seeds (base seed + k), so unrelated axes change nothing");
+}
+
 void PumpTester::simulateTime(double minutes) {
     std::cout << "\n[Simulating Time: " << minutes << " minutes]\n";
     for (int i = 0; i < static_cast<int>(minutes); ++i) {
@@ -205,3 +1684,11 @@ void PumpTester::simulateTime(double minutes) {
 void PumpTester::printHeader(const std::string& title) {
     std::cout << "\n==== " << title << " ====\n";
 }
+
+// Reports one expectation and counts it towards the self-test result
+bool PumpTester::check(bool condition, const std::string& what) {
+    std::cout << (condition ? "PASS: " : "FAIL: ") << what << "\n";
+    if (!condition)
+        ++failures;
+    return condition;
+}
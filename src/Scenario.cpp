@@ -0,0 +1,236 @@
+#include "Scenario.h"
+#include "CGMSensorInterface.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace {
+// Bounds for values the runner converts to int; NaN fails every range check
+const double kMaxMinutes = 366.0 * 24 * 60;         // Longest run or fault duration
+const double kMaxCadenceMinutes = 24 * 60;
+const double kMaxMealGrams = 1000.0;
+const double kMaxRandomFaultsPerDay = 24 * 60;      // One a minute; bounds the precomputed schedule
+const double kMaxSeed = 4294967295.0;               // UINT32_MAX
+
+bool inRange(double value, double low, double high) {
+    return value >= low && value <= high;
+}
+
+bool fail(std::string* error, int line, const std::string& message) {
+    if (error)
+        *error = "line " + std::to_string(line) + ": " + message;
+    return false;
+}
+
+// Reads exactly `count` numbers from the rest of the line
+bool readNumbers(std::istringstream& in, double* values, int count) {
+    for (int i = 0; i < count; ++i) {
+        if (!(in >> values[i]))
+            return false;
+    }
+    std::string extra;
+    return !(in >> extra);
+}
+
+bool parseEvent(std::istringstream& in, ScenarioEvent& event, std::string& message) {
+    std::string kind;
+    in >> kind;
+    double v[4] = { 0.0, 0.0, 0.0, 0.0 };
+
+    if (kind == "meal" || kind == "mealbolus") {
+        event.type = kind == "meal" ? ScenarioEvent::Meal : ScenarioEvent::MealBolus;
+        if (!readNumbers(in, v, 1) || !inRange(v[0], 0.0, kMaxMealGrams)) {
+            message = kind + " expects 0-" + std::to_string(static_cast<int>(kMaxMealGrams)) + " grams of carbs";
+            return false;
+        }
+    } else if (kind == "bolus") {
+        event.type = ScenarioEvent::Bolus;
+        if (!readNumbers(in, v, 1) || !(v[0] >= 0.0)) {
+            message = "bolus expects one non-negative amount";
+            return false;
+        }
+    } else if (kind == "correction") {
+        event.type = ScenarioEvent::Correction;
+        if (!readNumbers(in, v, 0)) {
+            message = "correction takes no arguments";
+            return false;
+        }
+    } else if (kind == "calibrate") {
+        event.type = ScenarioEvent::Calibrate;
+        if (!readNumbers(in, v, 0)) {
+            message = "calibrate takes no arguments";
+            return false;
+        }
+    } else if (kind == "extended") {
+        event.type = ScenarioEvent::ExtendedBolus;
+        if (!readNumbers(in, v, 4) || !(v[1] <= v[0]) || !(v[2] > 0.0 && v[2] <= kMaxMinutes) ||
+            !inRange(v[3], 1.0, kMaxMinutes)) {
+            message = "extended expects <total> <immediate <= total> <duration > 0> <splits >= 1>, "
+                      "at most a year of minutes";
+            return false;
+        }
+    } else if (kind == "basal") {
+        std::string arg;
+        in >> arg;
+        if (arg == "stop") {
+            event.type = ScenarioEvent::BasalStop;
+        } else if (arg == "resume") {
+            event.type = ScenarioEvent::BasalResume;
+        } else {
+            event.type = ScenarioEvent::BasalRate;
+            std::istringstream rate(arg);
+            if (!(rate >> v[0]) || v[0] <= 0.0) {
+                message = "basal expects a rate > 0, 'stop' or 'resume'";
+                return false;
+            }
+        }
+    } else if (kind == "fault") {
+        std::string target;
+        in >> target;
+        if (target == "occlusion" || target == "cgm-dropout") {
+            event.type = target == "occlusion" ? ScenarioEvent::FaultOcclusion : ScenarioEvent::FaultCGMDropout;
+            if (!readNumbers(in, v, 1) || !inRange(v[0], 1.0, kMaxMinutes)) {
+                message = "fault " + target + " expects a duration of 1 minute to a year";
+                return false;
+            }
+        } else if (target == "compression" || target == "battery-sag" || target == "leak") {
+            event.type = target == "compression" ? ScenarioEvent::FaultCompression
+                       : target == "battery-sag" ? ScenarioEvent::FaultBatterySag : ScenarioEvent::FaultLeak;
+            if (!readNumbers(in, v, 2) || !inRange(v[0], 1.0, kMaxMinutes) || !(v[1] >= 0.0)) {
+                message = "fault " + target + " expects <duration of 1 minute to a year> <non-negative magnitude>";
+                return false;
+            }
+        } else if (target == "battery" || target == "cartridge" || target == "bg") {
+            event.type = target == "battery" ? ScenarioEvent::FaultBattery
+                       : target == "cartridge" ? ScenarioEvent::FaultCartridge : ScenarioEvent::FaultBG;
+            if (!readNumbers(in, v, 1) || !(v[0] >= 0.0)) {
+                message = "fault " + target + " expects one non-negative value";
+                return false;
+            }
+            if (event.type == ScenarioEvent::FaultBattery && v[0] > 100.0) {
+                message = "fault battery expects a level of 0-100%";
+                return false;
+            }
+        } else {
+            message = "unknown fault '" + target + "' (battery, cartridge, bg, occlusion, cgm-dropout, "
+                      "compression, battery-sag, leak)";
+            return false;
+        }
+    } else {
+        message = "unknown event '" + kind + "'";
+        return false;
+    }
+
+    event.a = v[0];
+    event.b = v[1];
+    event.c = v[2];
+    event.d = v[3];
+    return true;
+}
+}
+
+bool Scenario::parse(const std::string& text, Scenario& out, std::string* error) {
+    out = Scenario();
+    std::istringstream lines(text);
+    std::string line;
+    int lineNumber = 0;
+
+    while (std::getline(lines, line)) {
+        ++lineNumber;
+        std::size_t comment = line.find('#');
+        if (comment != std::string::npos)
+            line.erase(comment);
+
+        std::istringstream in(line);
+        std::string keyword;
+        if (!(in >> keyword))
+            continue;   // Blank or comment-only
+
+        double v[3];
+        if (keyword == "name") {
+            std::getline(in >> std::ws, out.name);
+            while (!out.name.empty() && std::isspace(static_cast<unsigned char>(out.name.back())))
+                out.name.pop_back();
+        } else if (keyword == "duration") {
+            if (!readNumbers(in, v, 1) || !inRange(v[0], 1.0, kMaxMinutes))
+                return fail(error, lineNumber, "duration expects 1-" + std::to_string(static_cast<int>(kMaxMinutes))
+                                               + " minutes");
+            out.durationMinutes = static_cast<int>(v[0]);
+        } else if (keyword == "seed") {
+            if (!readNumbers(in, v, 1) || !inRange(v[0], 0.0, kMaxSeed) || v[0] != std::floor(v[0]))
+                return fail(error, lineNumber, "seed expects an integer from 0 to 4294967295");
+            out.seed = static_cast<unsigned int>(v[0]);
+        } else if (keyword == "bg") {
+            if (!readNumbers(in, v, 1) || v[0] <= 0.0)
+                return fail(error, lineNumber, "bg expects a positive value");
+            out.initialBG = v[0];
+        } else if (keyword == "icr" || keyword == "cf" || keyword == "target") {
+            if (!readNumbers(in, v, 1) || v[0] <= 0.0)
+                return fail(error, lineNumber, keyword + " expects a positive value");
+            if (keyword == "icr")
+                out.insulinToCarbRatio = v[0];
+            else if (keyword == "cf")
+                out.correctionFactor = v[0];
+            else
+                out.targetBG = v[0];
+        } else if (keyword == "segment") {
+            if (!readNumbers(in, v, 3) || v[0] < 0.0 || v[1] > 24.0 || v[0] >= v[1] || v[2] < 0.0)
+                return fail(error, lineNumber, "segment expects <start hour> <end hour> <U/hr> within 0-24");
+            out.basalSegments.push_back({ v[0], v[1], v[2] });
+        } else if (keyword == "random-faults") {
+            if (!readNumbers(in, v, 1) || !inRange(v[0], 0.0, kMaxRandomFaultsPerDay))
+                return fail(error, lineNumber, "random-faults expects 0-1440 faults per day");
+            out.randomFaultsPerDay = v[0];
+        } else if (keyword == "cgm-cadence") {
+            if (!readNumbers(in, v, 1) || !inRange(v[0], 1.0, kMaxCadenceMinutes))
+                return fail(error, lineNumber, "cgm-cadence expects a reading interval of 1-1440 minutes");
+            out.cgmCadenceMinutes = static_cast<int>(v[0]);
+        } else if (keyword == "cgm-latency") {
+            if (!readNumbers(in, v, 1) || !inRange(v[0], 0.0, CGMSensorInterface::kMaxLatencyMinutes))
+                return fail(error, lineNumber, "cgm-latency expects 0-" + std::to_string(CGMSensorInterface::kMaxLatencyMinutes)
+                                               + " minutes");
+            out.cgmLatencyMinutes = static_cast<int>(v[0]);
+        } else if (keyword == "cgm-drift") {
+            if (!readNumbers(in, v, 1))
+                return fail(error, lineNumber, "cgm-drift expects a calibration drift in % per day");
+            out.cgmDriftPctPerDay = v[0];
+        } else if (keyword == "at") {
+            ScenarioEvent event;
+            if (!(in >> event.minute) || event.minute < 0)
+                return fail(error, lineNumber, "at expects a non-negative minute");
+            std::string message;
+            if (!parseEvent(in, event, message))
+                return fail(error, lineNumber, message);
+            out.events.push_back(event);
+        } else {
+            return fail(error, lineNumber, "unknown directive '" + keyword + "'");
+        }
+    }
+
+    std::stable_sort(out.events.begin(), out.events.end(),
+                     [](const ScenarioEvent& x, const ScenarioEvent& y) { return x.minute < y.minute; });
+    return true;
+}
+
+bool Scenario::loadFile(const std::string& path, Scenario& out, std::string* error) {
+    std::ifstream in(path);
+    if (!in) {
+        if (error)
+            *error = "cannot open " + path;
+        return false;
+    }
+    std::ostringstream text;
+    text << in.rdbuf();
+    if (!parse(text.str(), out, error)) {
+        if (error)
+            *error = path + ": " + *error;
+        return false;
+    }
+    if (out.name.empty()) {
+        std::size_t slash = path.find_last_of('/');
+        out.name = slash == std::string::npos ? path : path.substr(slash + 1);
+    }
+    return true;
+}
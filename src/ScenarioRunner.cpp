@@ -0,0 +1,320 @@
+#include "ScenarioRunner.h"
+#include "PumpSimulator.h"
+#include "ProfileManager.h"
+#include "Profile.h"
+#include "ProfileSnapshot.h"
+#include "BasalSegment.h"
+#include "BolusCalculator.h"
+#include "InsulinDeliveryManager.h"
+#include "Battery.h"
+#include "Cartridge.h"
+#include "CGMSensorInterface.h"
+#include "ControlIQController.h"
+#include "AlertManager.h"
+#include "GlycemicMetrics.h"
+#include "FaultInjector.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <ostream>
+#include <thread>
+
+namespace {
+// One self-contained pump, wired like the GUI and CLI entry points
+struct ScenarioRig {
+    PumpSimulator simulator;       // Declared first so it outlives the AlertManager attached to its scheduler
+    ProfileManager profileManager;
+    BolusCalculator bolusCalculator;
+    InsulinDeliveryManager deliveryManager;
+    Battery battery;
+    Cartridge cartridge;
+    CGMSensorInterface cgm;
+    ControlIQController controlIQ;
+    AlertManager alertManager;
+    FaultInjector faultInjector;
+
+    std::vector<char> batched;     // Per scenario event: queued in the up-front batch
+    int failedBoluses = 0;
+
+    explicit ScenarioRig(const Scenario& scenario) {
+        Profile* profile = new Profile();
+        profile->setName(scenario.name.empty() ? "Scenario" : scenario.name);
+        profile->setInsulinToCarbRatio(scenario.insulinToCarbRatio);
+        profile->setCorrectionFactor(scenario.correctionFactor);
+        profile->setTargetBG(scenario.targetBG);
+        if (scenario.basalSegments.empty())
+            profile->addBasalSegment(new BasalSegment(0.0, 24.0, 0.8));
+        for (const ScenarioSegment& segment : scenario.basalSegments)
+            profile->addBasalSegment(new BasalSegment(segment.startHour, segment.endHour, segment.unitsPerHour));
+        profileManager.createProfile(profile);
+        profileManager.setActiveProfile(profile->getName());
+
+        deliveryManager.setBattery(&battery);
+        deliveryManager.setCartridge(&cartridge);
+        cgm.setDeliveryManager(&deliveryManager);
+        cgm.setSeed(scenario.seed);
+        cgm.setCadenceMinutes(scenario.cgmCadenceMinutes);
+        cgm.setLatencyMinutes(scenario.cgmLatencyMinutes);
+        cgm.setCalibrationDrift(scenario.cgmDriftPctPerDay);
+        cgm.setBG(scenario.initialBG);
+        controlIQ.setCGMSensor(&cgm);
+        controlIQ.setInsulinDeliveryManager(&deliveryManager);
+
+        simulator.setProfileManager(&profileManager);
+        simulator.setBolusCalculator(&bolusCalculator);
+        simulator.setInsulinDeliveryManager(&deliveryManager);
+        simulator.setBattery(&battery);
+        simulator.setCartridge(&cartridge);
+        simulator.setCGMSensorInterface(&cgm);
+        simulator.setControlIQController(&controlIQ);
+        simulator.setAlertManager(&alertManager);
+        simulator.setCLIMode(true);
+
+        faultInjector.setBattery(&battery);
+        faultInjector.setCartridge(&cartridge);
+        faultInjector.setCGMSensor(&cgm);
+        faultInjector.setInsulinDeliveryManager(&deliveryManager);
+        for (const ScenarioEvent& event : scenario.events)
+            scheduleFault(event);
+        faultInjector.generateRandom(scenario.seed ^ 0x9e3779b9u, scenario.durationMinutes, scenario.randomFaultsPerDay);
+        simulator.setFaultInjector(&faultInjector);
+
+        queueFixedBoluses(scenario);
+    }
+
+    static bool isFixedBolus(const ScenarioEvent& event) {
+        return event.type == ScenarioEvent::Bolus || event.type == ScenarioEvent::ExtendedBolus;
+    }
+
+    // Events apply() acts on; precomputed faults fire later in the tick either way
+    static bool actsInApply(const ScenarioEvent& event) {
+        switch (event.type) {
+            case ScenarioEvent::FaultOcclusion:
+            case ScenarioEvent::FaultCGMDropout:
+            case ScenarioEvent::FaultCompression:
+            case ScenarioEvent::FaultBatterySag:
+            case ScenarioEvent::FaultLeak:
+                return false;
+            default:
+                return true;
+        }
+    }
+
+    static BolusRequest fixedBolusRequest(const ScenarioEvent& event) {
+        if (event.type == ScenarioEvent::Bolus) {
+            BolusRequest request = BolusRequest::immediate(event.a);
+            request.startTime = event.minute;
+            return request;
+        }
+        return BolusRequest::dualWave(event.a, event.b, event.c, static_cast<int>(event.d), event.minute);
+    }
+
+    // Fixed-dose bolus events do not depend on the simulated state, so they go to the delivery
+    // manager as one batch up front. The queue is submitted at the start of the tick, after every
+    // event of that minute, so only minutes whose other events are fixed boluses too (or
+    // precomputed faults) are batched; the rest are submitted in file order by apply().
+    void queueFixedBoluses(const Scenario& scenario) {
+        const std::vector<ScenarioEvent>& events = scenario.events;
+        batched.assign(events.size(), 0);
+        std::vector<BolusRequest> requests;
+        for (std::size_t begin = 0; begin < events.size(); ) {
+            std::size_t end = begin;
+            bool onlyFixedBoluses = true;
+            while (end < events.size() && events[end].minute == events[begin].minute) {
+                if (actsInApply(events[end]) && !isFixedBolus(events[end]))
+                    onlyFixedBoluses = false;
+                ++end;
+            }
+            for (std::size_t i = begin; onlyFixedBoluses && i < end; ++i) {
+                if (!isFixedBolus(events[i]))
+                    continue;
+                BolusRequest request = fixedBolusRequest(events[i]);
+                request.tag = static_cast<int>(i);
+                requests.push_back(request);
+                batched[i] = 1;
+            }
+            begin = end;
+        }
+
+        std::vector<BolusStatus> statuses(requests.size());
+        deliveryManager.submitBolusBatch(requests.data(), requests.size(), statuses.data());
+        for (BolusStatus status : statuses) {
+            if (status != BolusStatus::Queued)
+                ++failedBoluses;
+        }
+    }
+
+    void submit(const BolusRequest& request) {
+        if (!bolusSucceeded(deliveryManager.submitBolus(request)))
+            ++failedBoluses;
+    }
+
+    // Batched boluses that were submitted but not delivered or scheduled
+    int failedBatchedBoluses() const {
+        return static_cast<int>(deliveryManager.getFailedBolusOutcomeCount());
+    }
+
+    void scheduleFault(const ScenarioEvent& event) {
+        FaultEvent fault;
+        switch (event.type) {
+            case ScenarioEvent::FaultOcclusion:   fault.kind = FaultEvent::Occlusion; break;
+            case ScenarioEvent::FaultCGMDropout:  fault.kind = FaultEvent::CGMDropout; break;
+            case ScenarioEvent::FaultCompression: fault.kind = FaultEvent::CompressionLow; break;
+            case ScenarioEvent::FaultBatterySag:  fault.kind = FaultEvent::BatterySag; break;
+            case ScenarioEvent::FaultLeak:        fault.kind = FaultEvent::CartridgeLeak; break;
+            default: return;
+        }
+        fault.startMinute = event.minute;
+        fault.durationMinutes = static_cast<int>(event.a);
+        fault.magnitude = event.b;
+        faultInjector.schedule(fault);
+    }
+
+    void apply(std::size_t index, const ScenarioEvent& event) {
+        switch (event.type) {
+            case ScenarioEvent::Meal:
+                cgm.addCarbs(static_cast<int>(event.a));
+                break;
+            case ScenarioEvent::MealBolus:
+            case ScenarioEvent::Correction: {
+                double carbs = event.type == ScenarioEvent::MealBolus ? event.a : 0.0;
+                std::shared_ptr<const ProfileSnapshot> profile = profileManager.getActiveSnapshot();
+                double dose = profile ? bolusCalculator.calculateBolus(cgm.getCurrentBG(), carbs,
+                                                                      deliveryManager.getInsulinOnBoard(), *profile)
+                                      : 0.0;
+                if (carbs > 0.0)
+                    cgm.addCarbs(static_cast<int>(carbs));
+                if (dose > 0.0)
+                    submit(BolusRequest::immediate(dose));
+                break;
+            }
+            case ScenarioEvent::BasalRate:
+                deliveryManager.startBasalDelivery(event.a);
+                break;
+            case ScenarioEvent::BasalStop:
+                deliveryManager.stopBasalDelivery();
+                break;
+            case ScenarioEvent::BasalResume:
+                deliveryManager.resumeBasalDelivery();
+                break;
+            case ScenarioEvent::FaultBattery:
+                battery.setLevel(static_cast<int>(event.a));
+                break;
+            case ScenarioEvent::FaultCartridge:
+                cartridge.setCurrentVolume(event.a);
+                break;
+            case ScenarioEvent::FaultBG:
+                cgm.setBG(event.a);
+                break;
+            case ScenarioEvent::Calibrate:
+                cgm.calibrate();
+                break;
+            case ScenarioEvent::FaultOcclusion:
+            case ScenarioEvent::FaultCGMDropout:
+            case ScenarioEvent::FaultCompression:
+            case ScenarioEvent::FaultBatterySag:
+            case ScenarioEvent::FaultLeak:
+                break;   // Precomputed into the FaultInjector schedule
+            case ScenarioEvent::Bolus:
+            case ScenarioEvent::ExtendedBolus:
+                if (!batched[index])
+                    submit(fixedBolusRequest(event));
+                break;   // Otherwise queued as one batch before the first tick
+        }
+    }
+};
+}
+
+ScenarioResult ScenarioRunner::run(const Scenario& scenario) {
+    auto started = std::chrono::steady_clock::now();
+    ScenarioResult result;
+    result.name = scenario.name;
+    result.minutes = scenario.durationMinutes;
+
+    ScenarioRig rig(scenario);
+    const Profile* profile = rig.profileManager.getActiveProfile();
+
+    rig.simulator.startSimulation();
+    double profileRate = profile->getBasalRateForTime(0.0);
+    if (profileRate > 0.0)
+        rig.deliveryManager.startBasalDelivery(profileRate);
+
+    std::size_t nextEvent = 0;
+    for (int minute = 0; minute < scenario.durationMinutes; ++minute) {
+        // Follow the profile's basal segments
+        double segmentRate = profile->getBasalRateForTime(std::fmod(minute / 60.0, 24.0));
+        if (segmentRate != profileRate) {
+            profileRate = segmentRate;
+            if (segmentRate > 0.0)
+                rig.deliveryManager.startBasalDelivery(segmentRate);
+            else
+                rig.deliveryManager.stopBasalDelivery();
+        }
+
+        rig.cgm.setSimulatedTime(minute);
+        rig.deliveryManager.setSimulatedTime(minute);
+        for (; nextEvent < scenario.events.size() && scenario.events[nextEvent].minute <= minute; ++nextEvent)
+            rig.apply(nextEvent, scenario.events[nextEvent]);
+
+        rig.simulator.updateSimulationState();
+    }
+    rig.simulator.stopSimulation();
+
+    const GlycemicMetrics& metrics = rig.simulator.getGlycemicMetrics();
+    result.finalBG = rig.cgm.getCurrentBG();
+    result.meanBG = metrics.getMean();
+    result.sdBG = metrics.getSD();
+    result.cvPct = metrics.getCV();
+    result.gmiPct = metrics.getGMI();
+    result.minBG = metrics.getMin();
+    result.maxBG = metrics.getMax();
+    result.timeInRangePct = metrics.getTimeInRangePct();
+    result.timeBelowPct = metrics.getTimeBelowPct();
+    result.timeVeryLowPct = metrics.getTimeVeryLowPct();
+    result.timeAbovePct = metrics.getTimeAbovePct();
+    result.lbgi = metrics.getLBGI();
+    result.hbgi = metrics.getHBGI();
+    result.insulinDelivered = metrics.getTotalInsulin();
+    result.totalDailyInsulin = metrics.getTotalDailyInsulin();
+    result.alarms = rig.alertManager.getRaisedCount();
+    result.faults = rig.faultInjector.getInjectedCount();
+    result.failedBoluses = rig.failedBoluses + rig.failedBatchedBoluses();
+    result.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    return result;
+}
+
+// Threads pull the next scenario index until none remain
+std::vector<ScenarioResult> ScenarioRunner::runAll(const std::vector<Scenario>& scenarios, int jobs) {
+    std::vector<ScenarioResult> results(scenarios.size());
+    std::atomic<std::size_t> next(0);
+    auto worker = [&]() {
+        for (std::size_t i = next++; i < scenarios.size(); i = next++)
+            results[i] = run(scenarios[i]);
+    };
+
+    int threadCount = std::max(1, std::min<int>(jobs, static_cast<int>(scenarios.size())));
+    std::vector<std::thread> threads;
+    for (int t = 1; t < threadCount; ++t)
+        threads.emplace_back(worker);
+    worker();
+    for (std::thread& thread : threads)
+        thread.join();
+    return results;
+}
+
+void ScenarioRunner::writeSummaryCsv(std::ostream& out, const std::vector<ScenarioResult>& results) {
+    out << "name,minutes,final_bg,mean_bg,sd_bg,cv_pct,gmi_pct,min_bg,max_bg,tir_pct,below_pct,very_low_pct,"
+           "above_pct,lbgi,hbgi,insulin_u,tdd_u,alarms,faults,failed_boluses,wall_ms\n";
+    for (const ScenarioResult& r : results) {
+        std::string name = r.name;
+        std::replace(name.begin(), name.end(), ',', ';');
+        out << name << ',' << r.minutes << ',' << r.finalBG << ',' << r.meanBG << ','
+            << r.sdBG << ',' << r.cvPct << ',' << r.gmiPct << ','
+            << r.minBG << ',' << r.maxBG << ',' << r.timeInRangePct << ',' << r.timeBelowPct << ','
+            << r.timeVeryLowPct << ',' << r.timeAbovePct << ',' << r.lbgi << ',' << r.hbgi << ','
+            << r.insulinDelivered << ',' << r.totalDailyInsulin << ',' << r.alarms << ',' << r.faults << ','
+            << r.failedBoluses << ',' << r.wallMs << '\n';
+    }
+}
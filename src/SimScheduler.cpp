@@ -0,0 +1,94 @@
+#include "SimScheduler.h"
+#include <iostream>
+#include <utility>
+
+SimScheduler::SimScheduler() : heap(), count(0), nextId(kNoTimer + 1), currentMinute(0) {}
+
+SimScheduler::TimerId SimScheduler::push(int dueMinute, void* owner, void (*call)(void*, int), int tag) {
+    if (count == kMaxTimers) {
+        std::cout << "[SimScheduler] Timer table full; timer at minute " << dueMinute << " dropped.\n";
+        return kNoTimer;
+    }
+    TimerId id = nextId++;
+    if (nextId == kNoTimer)
+        ++nextId;
+    heap[count] = { dueMinute, id, owner, call, tag };
+    siftUp(count++);
+    return id;
+}
+
+bool SimScheduler::cancel(TimerId id) {
+    if (id == kNoTimer)
+        return false;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (heap[i].id == id) {
+            removeAt(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Compacts the survivors and rebuilds the heap. Removing one at a time would not do: the entry
+// moved into a freed slot can sift up past the scan position and be missed.
+void SimScheduler::cancelAll(const void* owner) {
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (heap[i].owner != owner)
+            heap[kept++] = heap[i];
+    }
+    count = kept;
+    for (std::size_t i = count / 2; i-- > 0;)
+        siftDown(i);
+}
+
+// The timer is popped before its callback runs, so the callback sees a consistent heap
+void SimScheduler::runDue(int minute) {
+    currentMinute = minute;
+    while (count > 0 && heap[0].due <= minute) {
+        Timer timer = heap[0];
+        removeAt(0);
+        timer.call(timer.owner, timer.tag);
+    }
+}
+
+void SimScheduler::removeAt(std::size_t index) {
+    --count;
+    if (index == count)
+        return;
+    heap[index] = heap[count];
+    if (index > 0 && earlier(heap[index], heap[(index - 1) / 2]))
+        siftUp(index);
+    else
+        siftDown(index);
+}
+
+void SimScheduler::siftUp(std::size_t index) {
+    while (index > 0) {
+        std::size_t parent = (index - 1) / 2;
+        if (!earlier(heap[index], heap[parent]))
+            break;
+        std::swap(heap[index], heap[parent]);
+        index = parent;
+    }
+}
+
+void SimScheduler::siftDown(std::size_t index) {
+    for (;;) {
+        std::size_t smallest = index;
+        std::size_t left = 2 * index + 1;
+        std::size_t right = left + 1;
+        if (left < count && earlier(heap[left], heap[smallest]))
+            smallest = left;
+        if (right < count && earlier(heap[right], heap[smallest]))
+            smallest = right;
+        if (smallest == index)
+            return;
+        std::swap(heap[index], heap[smallest]);
+        index = smallest;
+    }
+}
+
+bool SimScheduler::earlier(const Timer& a, const Timer& b) {
+    return a.due != b.due ? a.due < b.due : a.id < b.id;
+}
@@ -0,0 +1,207 @@
+#include "SimulationWorker.h"
+#include "PumpSimulator.h"
+#include "TraceRecorder.h"
+#include <chrono>
+#include <future>
+#include <iostream>
+
+SimulationWorker::SimulationWorker(PumpSimulator* sim)
+    : simulator(sim),
+      droppedSamples(0),
+      running(false),
+      baseIntervalMs(2000),
+      speed(1),
+      paused(false),
+      rescheduled(false),
+      tickCount(0) {}
+
+SimulationWorker::~SimulationWorker() {
+    stop();
+}
+
+// Publishes the initial state, then starts ticking every intervalMs (at 1x) on the worker thread
+void SimulationWorker::start(int intervalMs) {
+    if (running || !simulator) return;
+
+    baseIntervalMs = intervalMs;
+    publishSnapshot();
+    running = true;
+    thread = std::thread(&SimulationWorker::run, this);
+    std::cout << "[SimulationWorker] Started (1 tick every " << baseIntervalMs << " ms at 1x).\n";
+}
+
+// Stops the loop and joins; pending commands are dropped
+void SimulationWorker::stop() {
+    if (!running) return;
+    {
+        std::lock_guard<std::mutex> lock(commandMutex);
+        running = false;
+    }
+    wake.notify_all();
+    if (thread.joinable())
+        thread.join();
+    std::cout << "[SimulationWorker] Stopped.\n";
+}
+
+bool SimulationWorker::isRunning() const { return running; }
+
+// Speed is a multiple of real time (1 = one tick per base interval); 0 runs flat out
+void SimulationWorker::setSpeed(int multiplier) {
+    {
+        std::lock_guard<std::mutex> lock(commandMutex);
+        speed = multiplier < 0 ? 1 : multiplier;
+        rescheduled = true;
+    }
+    wake.notify_one();
+    std::cout << "[SimulationWorker] Speed set to " << (multiplier ? std::to_string(multiplier) + "x" : "max") << ".\n";
+}
+
+int SimulationWorker::getSpeed() {
+    std::lock_guard<std::mutex> lock(commandMutex);
+    return speed;
+}
+
+void SimulationWorker::pause() {
+    {
+        std::lock_guard<std::mutex> lock(commandMutex);
+        paused = true;
+        rescheduled = true;
+    }
+    wake.notify_one();
+}
+
+void SimulationWorker::resume() {
+    {
+        std::lock_guard<std::mutex> lock(commandMutex);
+        paused = false;
+        rescheduled = true;
+    }
+    wake.notify_one();
+}
+
+bool SimulationWorker::isPaused() {
+    std::lock_guard<std::mutex> lock(commandMutex);
+    return paused;
+}
+
+void SimulationWorker::step() {
+    post([this]() { tick(); });
+}
+
+// Queues a command to run on the simulation thread between ticks
+void SimulationWorker::post(std::function<void()> command) {
+    if (!running) {
+        command();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(commandMutex);
+        commands.push_back(std::move(command));
+    }
+    wake.notify_one();
+}
+
+// Runs a command on the simulation thread and waits for it to finish
+void SimulationWorker::invoke(const std::function<void()>& command) {
+    if (!running || std::this_thread::get_id() == thread.get_id()) {
+        command();
+        return;
+    }
+    std::promise<void> done;
+    std::future<void> finished = done.get_future();
+    post([&]() {
+        command();
+        done.set_value();
+    });
+    finished.wait();
+}
+
+bool SimulationWorker::pollSnapshot() {
+    return snapshots.update();
+}
+
+const SimulationSnapshot& SimulationWorker::latestSnapshot() const {
+    return snapshots.readBuffer();
+}
+
+// Worker loop: sleep until the next tick is due (or a command arrives), then run every due tick as one batch
+void SimulationWorker::run() {
+    using Clock = std::chrono::steady_clock;
+    Clock::duration interval = std::chrono::milliseconds(baseIntervalMs);
+    Clock::time_point nextTick = Clock::now() + interval;
+    int currentSpeed = 1;
+
+    if (TraceRecorder* recorder = simulator->getTraceRecorder())
+        recorder->setThreadName("Simulation");
+    bool isPaused = false;
+
+    while (running) {
+        std::vector<std::function<void()>> pending;
+        {
+            std::unique_lock<std::mutex> lock(commandMutex);
+            auto woken = [this]() { return !running || !commands.empty() || rescheduled; };
+            if (paused)
+                wake.wait(lock, woken);
+            else if (speed != 0)
+                wake.wait_until(lock, nextTick, woken);
+            if (!running) break;
+
+            pending.swap(commands);
+            if (rescheduled) {
+                rescheduled = false;
+                currentSpeed = speed;
+                isPaused = paused;
+                interval = currentSpeed ? Clock::duration(std::chrono::milliseconds(baseIntervalMs)) / currentSpeed
+                                        : Clock::duration::zero();
+                nextTick = Clock::now() + interval;
+            }
+        }
+
+        if (!pending.empty()) {
+            for (auto& command : pending)
+                command();
+            publishSnapshot(); // Reflect GUI actions without waiting for the next tick
+        }
+
+        if (isPaused) continue;
+
+        int batch = 0;
+        if (currentSpeed == 0) {
+            while (batch < kMaxTicksPerBatch && running) {
+                tick();
+                ++batch;
+            }
+        } else {
+            Clock::time_point now = Clock::now();
+            while (now >= nextTick && batch < kMaxTicksPerBatch) {
+                tick();
+                nextTick += interval;
+                ++batch;
+            }
+            // Cannot keep up with the requested speed: drop the backlog rather than spiral
+            if (batch == kMaxTicksPerBatch && nextTick < now)
+                nextTick = now;
+        }
+
+        if (batch > 0)
+            publishSnapshot();
+    }
+}
+
+// Advances the simulation by one simulated minute
+void SimulationWorker::tick() {
+    ++tickCount;
+    simulator->setGUISimTime(tickCount);
+    simulator->updateSimulationState();
+
+    BGPoint sample = { static_cast<double>(simulator->getCurrentSimTime()), simulator->getCurrentBG() };
+    if (!bgSamples.push(sample))
+        ++droppedSamples;
+}
+
+void SimulationWorker::publishSnapshot() {
+    SimulationSnapshot& snapshot = snapshots.writeBuffer();
+    simulator->captureSnapshot(snapshot);
+    snapshot.tick = static_cast<std::uint64_t>(tickCount);
+    snapshots.publish();
+}
@@ -0,0 +1,136 @@
+#include "TickProfiler.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+const int kDefaultDumpInterval = 1440;  // One simulated day of 1-minute ticks
+
+int highestBit(std::uint64_t value) {
+    int bit = 0;
+    while (value >>= 1)
+        ++bit;
+    return bit;
+}
+}
+
+// --- LatencyHistogram ---
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+void LatencyHistogram::reset() {
+    std::fill(counts, counts + kBucketCount, 0);
+    count = 0;
+    sum = 0;
+    minValue = ~std::uint64_t(0);
+    maxValue = 0;
+}
+
+// Values below 2 * kSubBucketCount map 1:1; above that the top kSubBucketBits + 1 bits select the bucket
+int LatencyHistogram::bucketIndex(std::uint64_t value) {
+    const std::uint64_t limit = (std::uint64_t(1) << kMaxValueBits) - 1;   // Top bucket is kBucketCount - 1
+    if (value > limit)
+        value = limit;
+    if (value < 2u * kSubBucketCount)
+        return static_cast<int>(value);
+    int shift = highestBit(value) - kSubBucketBits;
+    return shift * kSubBucketCount + static_cast<int>(value >> shift);
+}
+
+std::uint64_t LatencyHistogram::bucketUpperBound(int index) {
+    if (index < 2 * kSubBucketCount)
+        return static_cast<std::uint64_t>(index);
+    int shift = index / kSubBucketCount - 1;
+    std::uint64_t mantissa = static_cast<std::uint64_t>(index % kSubBucketCount + kSubBucketCount);
+    return ((mantissa + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(std::uint64_t value) {
+    ++counts[bucketIndex(value)];
+    ++count;
+    sum += value;
+    minValue = std::min(minValue, value);
+    maxValue = std::max(maxValue, value);
+}
+
+// Smallest bucket bound such that at least p% of recorded values are at or below it
+std::uint64_t LatencyHistogram::percentile(double p) const {
+    if (count == 0)
+        return 0;
+    p = std::min(std::max(p, 0.0), 100.0);
+    std::uint64_t rank = static_cast<std::uint64_t>(std::ceil(p / 100.0 * count));
+    if (rank == 0)
+        rank = 1;
+
+    std::uint64_t seen = 0;
+    for (int i = 0; i < kBucketCount; ++i) {
+        seen += counts[i];
+        if (seen >= rank)
+            return std::min(bucketUpperBound(i), maxValue);
+    }
+    return maxValue;
+}
+
+// --- TickProfiler ---
+
+TickProfiler::TickProfiler() : ticks(0), dumpInterval(kDefaultDumpInterval) {}
+
+void TickProfiler::record(Stage stage, std::uint64_t nanoseconds) {
+    histograms[stage].record(nanoseconds);
+}
+
+void TickProfiler::endTick() {
+    ++ticks;
+    if (isCompiledIn() && dumpInterval > 0 && ticks % static_cast<std::uint64_t>(dumpInterval) == 0)
+        dump(std::cout);
+}
+
+void TickProfiler::reset() {
+    for (LatencyHistogram& histogram : histograms)
+        histogram.reset();
+    ticks = 0;
+}
+
+void TickProfiler::dump(std::ostream& out) const {
+    out << "[TickProfiler] " << ticks << " ticks (latency in microseconds)\n";
+    out << "  " << std::left << std::setw(14) << "Stage" << std::right
+        << std::setw(10) << "count" << std::setw(10) << "p50"
+        << std::setw(10) << "p99" << std::setw(10) << "max" << "\n";
+
+    std::ios::fmtflags flags = out.flags();
+    out << std::fixed << std::setprecision(2);
+    for (int i = 0; i < StageCount; ++i) {
+        const LatencyHistogram& h = histograms[i];
+        out << "  " << std::left << std::setw(14) << stageName(static_cast<Stage>(i)) << std::right
+            << std::setw(10) << h.getCount()
+            << std::setw(10) << h.percentile(50.0) / 1000.0
+            << std::setw(10) << h.percentile(99.0) / 1000.0
+            << std::setw(10) << h.getMax() / 1000.0 << "\n";
+    }
+    out.flags(flags);
+}
+
+const char* TickProfiler::stageName(Stage stage) {
+    switch (stage) {
+        case Timers:        return "Timers";
+        case Faults:        return "Faults";
+        case Battery:       return "Battery";
+        case DeliveryTick:  return "DeliveryTick";
+        case CGMReading:    return "CGMReading";
+        case ControlIQ:     return "ControlIQ";
+        case ExtendedDoses: return "ExtendedDoses";
+        case Total:         return "Total";
+        default:            return "?";
+    }
+}
+
+bool TickProfiler::isCompiledIn() {
+#ifdef PUMP_ENABLE_TICK_PROFILING
+    return true;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,176 @@
+#include "TraceRecorder.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+namespace {
+std::atomic<std::uint64_t> nextRecorderId(1);
+
+// Per-thread cache of the buffer last used, keyed by recorder id (addresses can be reused)
+thread_local std::uint64_t cachedRecorderId = 0;
+thread_local void* cachedBuffer = nullptr;
+
+void writeJsonString(std::ostream& out, const std::string& s) {
+    out << '"';
+    for (char c : s) {
+        switch (c) {
+            case '"':  out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out << buf;
+                } else {
+                    out << c;
+                }
+        }
+    }
+    out << '"';
+}
+}
+
+TraceRecorder::TraceRecorder(std::size_t eventsPerThread)
+    : id(nextRecorderId++),
+      eventsPerThread(eventsPerThread ? eventsPerThread : 1),
+      epoch(std::chrono::steady_clock::now()),
+      recording(false) {}
+
+TraceRecorder::~TraceRecorder() {
+    if (cachedRecorderId == id) {
+        cachedRecorderId = 0;
+        cachedBuffer = nullptr;
+    }
+}
+
+TraceRecorder::ThreadBuffer& TraceRecorder::localBuffer() {
+    if (cachedRecorderId == id)
+        return *static_cast<ThreadBuffer*>(cachedBuffer);
+
+    // Cache miss: reuse this thread's ring if it has one, otherwise register a new ring
+    std::thread::id self = std::this_thread::get_id();
+    ThreadBuffer* raw = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        for (auto& buffer : buffers) {
+            if (buffer->owner == self) {
+                raw = buffer.get();
+                break;
+            }
+        }
+        if (!raw) {
+            std::unique_ptr<ThreadBuffer> buffer(new ThreadBuffer());
+            buffer->ring.resize(eventsPerThread);
+            buffer->owner = self;
+            buffer->tid = static_cast<int>(buffers.size()) + 1;
+            raw = buffer.get();
+            buffers.push_back(std::move(buffer));
+        }
+    }
+    cachedRecorderId = id;
+    cachedBuffer = raw;
+    return *raw;
+}
+
+void TraceRecorder::setThreadName(const std::string& name) {
+    ThreadBuffer& buffer = localBuffer();
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    buffer.threadName = name;
+}
+
+std::uint64_t TraceRecorder::nowNs() const {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - epoch).count());
+}
+
+void TraceRecorder::push(const TraceEvent& event) {
+    ThreadBuffer& buffer = localBuffer();
+    buffer.ring[buffer.written % buffer.ring.size()] = event;
+    ++buffer.written;
+}
+
+void TraceRecorder::recordSpan(const char* name, std::uint64_t startNs, std::uint64_t durationNs) {
+    if (!isEnabled()) return;
+    push({ name, 'X', startNs, durationNs, 0.0, false });
+}
+
+void TraceRecorder::recordSpan(const char* name, std::uint64_t startNs, std::uint64_t durationNs, double arg) {
+    if (!isEnabled()) return;
+    push({ name, 'X', startNs, durationNs, arg, true });
+}
+
+void TraceRecorder::recordCounter(const char* name, double value) {
+    if (!isEnabled()) return;
+    push({ name, 'C', nowNs(), 0, value, true });
+}
+
+void TraceRecorder::clear() {
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    for (auto& buffer : buffers)
+        buffer->written = 0;
+}
+
+std::size_t TraceRecorder::getEventCount() const {
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    std::size_t total = 0;
+    for (const auto& buffer : buffers)
+        total += static_cast<std::size_t>(std::min<std::uint64_t>(buffer->written, buffer->ring.size()));
+    return total;
+}
+
+// Chrome trace-event format: timestamps in (fractional) microseconds, one track per thread
+bool TraceRecorder::writeChromeTrace(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) {
+        std::cout << "[TraceRecorder] Cannot write trace to " << path << "\n";
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    std::size_t eventCount = 0;
+    bool first = true;
+    auto separator = [&]() {
+        out << (first ? "\n" : ",\n");
+        first = false;
+    };
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (const auto& buffer : buffers) {
+        if (!buffer->threadName.empty()) {
+            separator();
+            out << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << buffer->tid
+                << ",\"args\":{\"name\":";
+            writeJsonString(out, buffer->threadName);
+            out << "}}";
+        }
+
+        std::uint64_t size = buffer->ring.size();
+        std::uint64_t begin = buffer->written > size ? buffer->written - size : 0;
+        for (std::uint64_t i = begin; i < buffer->written; ++i) {
+            const TraceEvent& e = buffer->ring[i % size];
+            char ts[64];
+            std::snprintf(ts, sizeof(ts), "%.3f", e.timestampNs / 1000.0);
+            separator();
+            out << "{\"ph\":\"" << e.phase << "\",\"name\":";
+            writeJsonString(out, e.name ? e.name : "");
+            out << ",\"pid\":1,\"tid\":" << buffer->tid << ",\"ts\":" << ts;
+            if (e.phase == 'X') {
+                char dur[64];
+                std::snprintf(dur, sizeof(dur), "%.3f", e.durationNs / 1000.0);
+                out << ",\"dur\":" << dur;
+                if (e.hasValue)
+                    out << ",\"args\":{\"value\":" << e.value << "}";
+            } else if (e.phase == 'C') {
+                out << ",\"args\":{\"value\":" << e.value << "}";
+            }
+            out << "}";
+            ++eventCount;
+        }
+    }
+    out << "\n]}\n";
+
+    std::cout << "[TraceRecorder] Wrote " << eventCount << " events to " << path << "\n";
+    return static_cast<bool>(out);
+}
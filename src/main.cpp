@@ -2,6 +2,8 @@
 #include "MergedMainWindow.h"
 #include "PumpSimulator.h"
 #include "ProfileManager.h"
+#include "ProfileStore.h"
+#include "Profile.h"
 #include "BolusCalculator.h"
 #include "InsulinDeliveryManager.h"
 #include "Battery.h"
@@ -9,6 +11,7 @@
 #include "CGMSensorInterface.h"
 #include "ControlIQController.h"
 #include "AlertManager.h"
+#include "TraceRecorder.h"
 
 int main(int argc, char *argv[]) {
     QApplication app(argc, argv);
@@ -23,6 +26,40 @@ int main(int argc, char *argv[]) {
     CGMSensorInterface* cgm = new CGMSensorInterface();
     ControlIQController* controlIQ = new ControlIQController();
     AlertManager* alerts = new AlertManager();
+    ProfileStore* profileStore = new ProfileStore();
+
+    // Restore saved profiles (decoded lazily on first use)
+    QStringList args = app.arguments();
+    int storeArg = args.indexOf("--profile-store");
+    std::string storePath = (storeArg >= 0 && storeArg + 1 < args.size())
+        ? args.at(storeArg + 1).toStdString() : "profiles.ipps";
+    if (profileStore->open(storePath))
+        profileManager->setProfileStore(profileStore);
+
+    // JSON exchange: --import-profiles <file> merges, --export-profiles <file> writes and exits
+    int importArg = args.indexOf("--import-profiles");
+    if (importArg >= 0 && importArg + 1 < args.size()) {
+        std::string importedActive;
+        for (Profile* p : ProfileStore::importJson(args.at(importArg + 1).toStdString(), &importedActive)) {
+            if (profileManager->getProfileByName(p->getName()))
+                profileManager->updateProfile(p);
+            else
+                profileManager->createProfile(p);
+        }
+        if (!profileManager->getActiveProfile() && !importedActive.empty())
+            profileManager->setActiveProfile(importedActive);
+    }
+
+    int exportArg = args.indexOf("--export-profiles");
+    if (exportArg >= 0 && exportArg + 1 < args.size()) {
+        Profile* active = profileManager->getActiveProfile();
+        bool ok = ProfileStore::exportJson(args.at(exportArg + 1).toStdString(),
+                                           profileManager->getAllProfiles(),
+                                           active ? active->getName() : std::string());
+        delete profileManager;
+        delete profileStore;
+        return ok ? 0 : 1;
+    }
 
     // Wire components
     deliveryMgr->setBattery(battery);
@@ -40,13 +77,33 @@ int main(int argc, char *argv[]) {
     pumpSimulator->setControlIQController(controlIQ);
     pumpSimulator->setAlertManager(alerts);
 
+    // --trace <file> records a Chrome trace-event timeline of the run, written on exit
+    TraceRecorder* traceRecorder = nullptr;
+    int traceArg = args.indexOf("--trace");
+    if (traceArg >= 0 && traceArg + 1 < args.size()) {
+        traceRecorder = new TraceRecorder();
+        traceRecorder->setEnabled(true);
+        pumpSimulator->setTraceRecorder(traceRecorder);
+    }
+
     // Start GUI
-    MergedMainWindow w(pumpSimulator, profileManager);
-    w.show();
+    int ret = 0;
+    {
+        MergedMainWindow w(pumpSimulator, profileManager);
+        w.show();
+        ret = app.exec();
+    }   // Window teardown stops the simulation thread
 
-    int ret = app.exec();
+    if (traceRecorder) {
+        traceRecorder->setEnabled(false);
+        traceRecorder->writeChromeTrace(args.at(traceArg + 1).toStdString());
+        pumpSimulator->setTraceRecorder(nullptr);
+        delete traceRecorder;
+    }
 
     delete profileManager;
+    delete profileStore;
+    pumpSimulator->setAlertManager(nullptr);   // Detach from the scheduler before it goes
     delete pumpSimulator;
 
     return ret;